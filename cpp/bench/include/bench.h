@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace bench {
+
+/**
+ * @brief Bytes requested to operator new since the program started.
+ */
+extern size_t allocated;
+
+/**
+ * @brief Reads a test document from the test directory.
+ *
+ * @param name File name inside test/dfml.
+ * @return std::string The file contents.
+ */
+inline std::string read_document(const std::string name) {
+	std::ifstream file("../test/dfml/" + name);
+	return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Repeats a document until it reaches the given size.
+ *
+ * @param document The document to repeat.
+ * @param size Minimum size of the result.
+ * @return std::string The scaled document.
+ */
+inline std::string scale_document(const std::string &document, size_t size) {
+	std::string result;
+	result.reserve(size + document.size());
+	while (result.size() < size) result += document;
+	return result;
+}
+
+/**
+ * @brief Runs a function several times and reports the best time.
+ *
+ * @param label Label of the measure.
+ * @param bytes Bytes processed by each run, 0 to skip the throughput.
+ * @param runs Count of runs.
+ * @param fn Function to measure.
+ * @return double Best time in seconds.
+ */
+template <typename Fn>
+double measure(const char *label, size_t bytes, int runs, Fn fn) {
+	double best = 0.0;
+	for (int r = 0; r < runs; r++) {
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (r == 0 || elapsed.count() < best) best = elapsed.count();
+	}
+
+	if (bytes) std::printf("%-40s %10.3f ms %10.1f MB/s\n", label, best * 1e3, bytes / best / 1e6);
+	else std::printf("%-40s %10.3f ms\n", label, best * 1e3);
+	return best;
+}
+
+} // namespace bench
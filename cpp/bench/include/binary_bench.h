@@ -0,0 +1,90 @@
+#pragma once
+
+#include <bench.h>
+
+#include <dfml/binary.h>
+#include <dfml/parser.h>
+#include <dfml/handler.h>
+#include <dfml/sink.h>
+#include <dfml/cache.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace bench {
+
+/**
+ * @brief Compares the binary decoder with the text parser on the scaled test documents.
+ */
+inline void binary_bench() {
+	std::printf("== Binary\n");
+
+	for (auto name : {"parsing.dfml", "parsed.dfml", "doubles.dfml"}) {
+		std::string text = scale_document(read_document(name), 16 << 20);
+
+		dfml::BufferSink sink;
+		dfml::BinaryEncoder encoder(sink);
+		dfml::Parser::create(std::string_view(text))->parse(encoder);
+		encoder.finish();
+		std::string data = sink.take();
+
+		std::string label = std::string(name) + ": binary size";
+		std::printf("%-40s %10.1f MB (text %.1f MB)\n", label.c_str(), data.size() / 1e6, text.size() / 1e6);
+
+		auto elements = dfml::Parser::create(std::string_view(text))->parse();
+		label = std::string(name) + ": encode tree";
+		measure(label.c_str(), data.size(), 3, [&]() {
+			dfml::BufferSink sink;
+			dfml::BinaryEncoder encoder(sink);
+			for (auto &element : elements) encoder.write(*element);
+			encoder.finish();
+		});
+
+		label = std::string(name) + ": parse(Handler)";
+		measure(label.c_str(), text.size(), 3, [&]() {
+			dfml::Handler handler;
+			dfml::Parser::create(std::string_view(text))->parse(handler);
+		});
+
+		label = std::string(name) + ": decode(Handler)";
+		measure(label.c_str(), text.size(), 3, [&]() {
+			dfml::Handler handler;
+			dfml::BinaryDecoder::create(std::string_view(data))->decode(handler);
+		});
+
+		label = std::string(name) + ": parse()";
+		measure(label.c_str(), text.size(), 3, [&]() {
+			dfml::Parser::create(std::string_view(text))->parse();
+		});
+
+		label = std::string(name) + ": decode()";
+		measure(label.c_str(), text.size(), 3, [&]() {
+			dfml::BinaryDecoder::create(std::string_view(data))->decode();
+		});
+
+		label = std::string(name) + ": parse_tape()";
+		measure(label.c_str(), text.size(), 3, [&]() {
+			dfml::Parser::create(std::string_view(text))->parse_tape();
+		});
+
+		label = std::string(name) + ": decode_tape()";
+		measure(label.c_str(), text.size(), 3, [&]() {
+			dfml::BinaryDecoder::create(std::string_view(data))->decode_tape();
+		});
+	}
+
+	std::ofstream("bench_source.dfml") << scale_document(read_document("parsing.dfml"), 16 << 20);
+	std::filesystem::remove_all("bench_cache");
+	auto cache = dfml::Cache::create("bench_cache");
+	measure("parsing.dfml: Parser::open()->parse()", 0, 3, [&]() { dfml::Parser::open("bench_source.dfml")->parse(); });
+	cache->load("bench_source.dfml");
+	measure("parsing.dfml: Cache::load() hit", 0, 3, [&]() { cache->load("bench_source.dfml"); });
+	measure("parsing.dfml: Parser::open()->parse_tape()", 0, 3, [&]() { dfml::Parser::open("bench_source.dfml")->parse_tape(); });
+	measure("parsing.dfml: Cache::load_tape() hit", 0, 3, [&]() { cache->load_tape("bench_source.dfml"); });
+	auto stats = cache->get_stats();
+	std::printf("%-40s %10.3f ms\n", "parsing.dfml: Cache::load() miss", stats.miss_time * 1e3);
+	std::filesystem::remove_all("bench_cache");
+	std::filesystem::remove("bench_source.dfml");
+}
+
+} // namespace bench
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <bench.h>
+
+#include <dfml/builder.h>
+#include <dfml/dfml.h>
+#include <dfml/parser.h>
+#include <dfml/value.h>
+#include <dfml/sink.h>
+#include <dfml/writer.h>
+
+namespace bench {
+
+/**
+ * @brief Measures the builder throughput on the scaled test documents.
+ */
+inline void build_bench() {
+	std::printf("== Builder\n");
+
+	for (auto name : {"parsing.dfml", "doubles.dfml"}) {
+		auto elements = dfml::Parser::create(scale_document(read_document(name), 16 << 20))->parse();
+		auto builder = dfml::Builder::create();
+		size_t size = 0;
+		for (auto &element : elements) size += builder->build_element(element).size();
+
+		std::string label = std::string(name) + ": build_element()";
+		measure(label.c_str(), size, 3, [&]() {
+			for (auto &element : elements) builder->build_element(element);
+		});
+
+		label = std::string(name) + ": write(BufferSink)";
+		measure(label.c_str(), size, 3, [&]() {
+			dfml::BufferSink sink;
+			for (auto &element : elements) builder->write(*element, sink);
+		});
+	}
+
+	// A 64 levels deep chain of nodes, each with 100 data children
+	auto root = dfml::Node::create("root");
+	auto node = root;
+	for (int n = 0; n < 64; n++) {
+		for (int c = 0; c < 100; c++) node->add_child(dfml::Data::create_integer(c));
+		auto child = dfml::Node::create("level");
+		node->add_child(child);
+		node = child;
+	}
+	auto builder = dfml::Builder::create();
+	size_t size = builder->build_node(root).size();
+	measure("deep: build_node()", size, 3, [&]() { builder->build_node(root); });
+	measure("deep: write(BufferSink)", size, 3, [&]() {
+		dfml::BufferSink sink;
+		builder->write(*root, sink);
+	});
+	measure("deep: Writer", size, 3, [&]() {
+		dfml::BufferSink sink;
+		dfml::Writer writer(sink);
+		dfml::Value data;
+		writer.begin_node("root");
+		for (int n = 0; n < 64; n++) {
+			for (long c = 0; c < 100; c++) {
+				data.set_integer(c);
+				writer.data(data);
+			}
+			writer.begin_node("level");
+		}
+		for (int n = 0; n <= 64; n++) writer.end_node();
+		writer.finish();
+	});
+
+	measure("Node 2000 attributes x10", 0, 3, [&]() {
+		for (int r = 0; r < 10; r++) {
+			auto node = dfml::Node::create("node");
+			for (int n = 0; n < 2000; n++) node->set_attr_integer("attribute" + std::to_string(n), n);
+			for (int n = 0; n < 2000; n++) node->get_attr("attribute" + std::to_string(n));
+		}
+	});
+	measure("Node 8 attributes x100k", 0, 3, [&]() {
+		for (int r = 0; r < 100000; r++) {
+			auto node = dfml::Node::create("node");
+			for (auto key : {"id", "name", "type", "size", "x", "y", "width", "height"}) {
+				node->set_attr_integer(key, r);
+			}
+		}
+	});
+
+	dfml::Value value;
+	size_t total = 0;
+	measure("Value double get_value() x1M", 0, 3, [&]() {
+		for (int n = 0; n < 1000000; n++) {
+			value.set_double(n * 1.37);
+			total += value.get_value().size();
+		}
+	});
+	measure("Value integer get_value() x1M", 0, 3, [&]() {
+		for (int n = 0; n < 1000000; n++) {
+			value.set_integer(n * 1337L);
+			total += value.get_value().size();
+		}
+	});
+	if (!total) std::printf("\n");
+}
+
+} // namespace bench
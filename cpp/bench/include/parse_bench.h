@@ -0,0 +1,202 @@
+#pragma once
+
+#include <bench.h>
+
+#include <dfml/parser.h>
+#include <dfml/handler.h>
+#include <dfml/document.h>
+#include <dfml/tape.h>
+#include <dfml/thread_pool.h>
+#include <dfml/loader.h>
+#include <dfml/sink.h>
+#include <dfml/node.h>
+#include <dfml/name_index.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief Generates a document dominated by indentation, strings and comments.
+ *
+ * @return std::string The generated document.
+ */
+inline std::string text_document() {
+	std::string line(100, 'x');
+	std::string document = "texts {\n";
+	for (int n = 0; n < 50; n++) {
+		document += "\t\t\t\t/* " + line + " */\n";
+		document += "\t\t\t\tentry {\n\t\t\t\t\t\"" + line + "\"\n\t\t\t\t\t'" + line + "'\n\t\t\t\t}\n";
+	}
+	return document + "}\n";
+}
+
+/**
+ * @brief Measures the text parser throughput on the scaled test documents.
+ */
+inline void parse_bench() {
+	std::printf("== Parser\n");
+
+	for (auto name : {"parsing.dfml", "parsed.dfml", "doubles.dfml", "(text)"}) {
+		std::string document = name[0] == '(' ? text_document() : read_document(name);
+		std::string data = scale_document(document, 16 << 20);
+		std::string label;
+
+		label = std::string(name) + ": parse()";
+		measure(label.c_str(), data.size(), 3, [&]() {
+			dfml::Parser::create(std::string_view(data))->parse();
+		});
+
+		label = std::string(name) + ": parse_document()";
+		measure(label.c_str(), data.size(), 3, [&]() {
+			dfml::Parser::create(std::string_view(data))->parse_document();
+		});
+
+		label = std::string(name) + ": parse_tape()";
+		measure(label.c_str(), data.size(), 3, [&]() {
+			dfml::Parser::create(std::string_view(data))->parse_tape();
+		});
+
+		label = std::string(name) + ": parse(Handler)";
+		measure(label.c_str(), data.size(), 3, [&]() {
+			dfml::Handler handler;
+			dfml::Parser::create(std::string_view(data))->parse(handler);
+		});
+	}
+
+	std::string data = scale_document(read_document("parsing.dfml"), 16 << 20);
+
+	for (unsigned threads : {2u, 4u, 8u, 16u}) {
+		if (threads > std::thread::hardware_concurrency()) break;
+		dfml::ThreadPool pool(threads);
+		std::string label = "parsing.dfml: parse_parallel(" + std::to_string(threads) + ")";
+		measure(label.c_str(), data.size(), 3, [&]() {
+			dfml::Parser::create(std::string_view(data))->parse_parallel(pool);
+		});
+	}
+
+	size_t start = allocated;
+	auto elements = dfml::Parser::create(std::string_view(data))->parse();
+	std::printf("%-40s %10.1f MB\n", "parsing.dfml: parse() allocated", (allocated - start) / 1e6);
+	measure("parsing.dfml: tree walk", 0, 3, [&]() {
+		size_t count = 0;
+		std::vector<std::shared_ptr<dfml::Node>> pending;
+		for (auto &element : elements) {
+			if (element->get_element_type() == dfml::Element::NODE)
+				pending.push_back(std::static_pointer_cast<dfml::Node>(element));
+		}
+		while (!pending.empty()) {
+			auto node = pending.back();
+			pending.pop_back();
+			for (auto &child : node->get_children()) {
+				count++;
+				if (child->get_element_type() == dfml::Element::NODE)
+					pending.push_back(std::static_pointer_cast<dfml::Node>(child));
+			}
+		}
+		if (!count) std::printf("\n");
+	});
+	measure("parsing.dfml: list teardown", 0, 1, [&]() { elements.clear(); });
+
+	start = allocated;
+	auto tape = dfml::Parser::create(std::string_view(data))->parse_tape();
+	std::printf("%-40s %10.1f MB\n", "parsing.dfml: parse_tape() allocated", (allocated - start) / 1e6);
+	std::printf("%-40s %10.1f MB\n", "parsing.dfml: tape size", tape->memory_size() / 1e6);
+	{
+		std::FILE *out = std::fopen("bench.dfmt", "wb");
+		dfml::FdSink sink(fileno(out));
+		tape->save(sink);
+		std::fclose(out);
+	}
+	measure("parsing.dfml: Tape::open() + lookup", 0, 3, [&]() {
+		auto opened = dfml::Tape::open("bench.dfmt");
+		auto first = *opened->get_elements().begin();
+		if (first.get_attr("missing")) std::printf("\n");
+	});
+	measure("parsing.dfml: Tape::open(verify) + lookup", 0, 3, [&]() {
+		auto opened = dfml::Tape::open("bench.dfmt", true);
+		auto first = *opened->get_elements().begin();
+		if (first.get_attr("missing")) std::printf("\n");
+	});
+	std::remove("bench.dfmt");
+
+	auto document = dfml::Parser::create(std::string_view(data))->parse_document();
+	measure("parsing.dfml: document teardown", 0, 1, [&]() { document.reset(); });
+
+	// Name index built while parsing, and a lookup against a walk
+	dfml::ParseOptions indexed;
+	indexed.name_index = true;
+	measure("parsing.dfml: parse_document() + index", data.size(), 3, [&]() {
+		auto parser = dfml::Parser::create(std::string_view(data));
+		parser->set_options(indexed);
+		parser->parse_document();
+	});
+	{
+		auto parser = dfml::Parser::create(std::string_view(data));
+		parser->set_options(indexed);
+		auto indexed_document = parser->parse_document();
+		auto name = std::static_pointer_cast<dfml::Node>(indexed_document->get_elements().front())->get_name();
+		size_t found = 0;
+		measure("parsing.dfml: NameIndex::find_nodes()", 0, 3, [&]() {
+			found = indexed_document->get_index()->find_nodes(name).size();
+		});
+		measure("parsing.dfml: find by walk", 0, 3, [&]() {
+			std::vector<dfml::Node *> stack;
+			found = 0;
+			for (auto &element : indexed_document->get_elements()) {
+				if (element->get_element_type() == dfml::Element::NODE) stack.push_back(static_cast<dfml::Node *>(element.get()));
+			}
+			while (!stack.empty()) {
+				dfml::Node *node = stack.back();
+				stack.pop_back();
+				if (node->get_name() == name) found++;
+				for (auto &child : node->get_children()) {
+					if (child->get_element_type() == dfml::Element::NODE) stack.push_back(static_cast<dfml::Node *>(child.get()));
+				}
+			}
+		});
+	}
+
+	// Records with 5% invalid, throwing and not throwing on errors
+	std::vector<std::string> records;
+	for (int n = 0; n < 100000; n++) {
+		records.push_back("record(id: " + std::to_string(n) + ", name: 'entry') { " +
+				(n % 20 ? "12 0.5 'text'" : "12 0.5.1 'text'") + " }");
+	}
+	size_t records_size = 0, failures = 0; // Counted so the parses are not optimized out
+	for (auto &record : records) records_size += record.size();
+	measure("100k records: parse(Handler), throwing", records_size, 3, [&]() {
+		dfml::Handler handler;
+		for (auto &record : records) {
+			try { dfml::Parser(std::string_view(record)).parse(handler); } catch (dfml::ParserException &) { failures++; }
+		}
+	});
+	measure("100k records: parse(Handler, nothrow)", records_size, 3, [&]() {
+		dfml::Handler handler;
+		for (auto &record : records) {
+			if (!dfml::Parser(std::string_view(record)).parse(handler, std::nothrow)) failures++;
+		}
+	});
+
+	// A batch of 2000 small files
+	std::filesystem::create_directories("bench_files");
+	std::vector<std::string> paths;
+	std::string small = scale_document(read_document("parsing.dfml"), 8 << 10);
+	for (int n = 0; n < 2000; n++) {
+		paths.push_back("bench_files/" + std::to_string(n) + ".dfml");
+		std::ofstream(paths.back()) << small;
+	}
+	for (unsigned threads : {1u, 0u}) {
+		dfml::LoadOptions options;
+		options.threads = threads;
+		std::string label = std::string("2000 files: load_files(") + (threads ? "1 thread)" : "pool)");
+		measure(label.c_str(), small.size() * paths.size(), 3, [&]() { dfml::load_files(paths, options); });
+	}
+	std::filesystem::remove_all("bench_files");
+}
+
+} // namespace bench
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <bench.h>
+
+#include <dfml/parser.h>
+#include <dfml/query.h>
+#include <dfml/document.h>
+#include <dfml/node.h>
+
+#include <functional>
+#include <string>
+
+namespace bench {
+
+/**
+ * @brief Generates a configuration with many servers, listeners and nested routes.
+ *
+ * @return std::string The generated document.
+ */
+inline std::string config_document() {
+	std::string document;
+	for (int s = 0; s < 2000; s++) {
+		document += "server(name: 's" + std::to_string(s) + "') {\n";
+		for (int l = 0; l < 8; l++) {
+			document += "\tlistener(port: " + std::to_string(8080 + l) + ") { tls(cert: 'c.pem') }\n";
+		}
+		document += "\troutes {\n";
+		for (int r = 0; r < 10; r++) {
+			document += "\t\tgroup { route(method: '" + std::string(r % 2 ? "GET" : "POST") + "') }\n";
+		}
+		document += "\t}\n}\n";
+	}
+	return document;
+}
+
+/**
+ * @brief Compares DFPath queries with the same traversals written by hand.
+ */
+inline void query_bench() {
+	std::printf("== Query\n");
+
+	auto document = dfml::Parser::create(config_document())->parse_document();
+	size_t found = 0;
+
+	dfml::Query tls("server/listener[port=8080]/tls");
+	measure("server/listener[port=8080]/tls: Query", 0, 5, [&]() {
+		found = tls.count(*document);
+	});
+	size_t expected = found;
+	measure("server/listener[port=8080]/tls: by hand", 0, 5, [&]() {
+		found = 0;
+		for (auto &element : document->get_elements()) {
+			if (element->get_element_type() != dfml::Element::NODE) continue;
+			auto &server = static_cast<dfml::Node &>(*element);
+			if (server.get_name() != "server") continue;
+			for (auto &child : server.get_children()) {
+				if (child->get_element_type() != dfml::Element::NODE) continue;
+				auto &listener = static_cast<dfml::Node &>(*child);
+				auto port = listener.attr<long>("port");
+				if (listener.get_name() != "listener" || !port || *port != 8080) continue;
+				for (auto &grandchild : listener.get_children()) {
+					if (grandchild->get_element_type() == dfml::Element::NODE &&
+							static_cast<dfml::Node &>(*grandchild).get_name() == "tls") found++;
+				}
+			}
+		}
+	});
+	if (found != expected) std::printf("different tls count\n");
+
+	dfml::Query routes("//route[method='GET']");
+	measure("//route[method='GET']: Query", 0, 5, [&]() {
+		found = routes.count(*document);
+	});
+	expected = found;
+	measure("//route[method='GET']: by hand", 0, 5, [&]() {
+		found = 0;
+		std::function<void(dfml::ChildRange)> walk = [&](dfml::ChildRange elements) {
+			for (auto &element : elements) {
+				if (element->get_element_type() != dfml::Element::NODE) continue;
+				auto &node = static_cast<dfml::Node &>(*element);
+				auto method = node.attr<std::string_view>("method");
+				if (node.get_name() == "route" && method && *method == "GET") found++;
+				walk(node.get_children());
+			}
+		};
+		auto &elements = document->get_elements();
+		walk(dfml::ChildRange(elements.data(), elements.data() + elements.size()));
+	});
+	if (found != expected) std::printf("different route count\n");
+
+	measure("Query compile x10k", 0, 3, [&]() {
+		for (int n = 0; n < 10000; n++) dfml::Query("server/listener[port=8080][2]/tls");
+	});
+
+	// Lookup by name among the children of a wide node, and around the threshold
+	for (size_t width : {8, 16, 32, 64, 20000}) {
+		auto users = dfml::Node::create("users");
+		std::vector<std::string> names;
+		for (size_t n = 0; n < width; n++) {
+			names.push_back("user" + std::to_string(n));
+			users->add_child(dfml::Node::create(names.back()));
+		}
+		size_t lookups = width < 1000 ? 100000 : 2000;
+		for (size_t threshold : {width + 1, width}) {
+			dfml::Node::set_child_index_threshold(threshold);
+			std::string label = "find_child x" + std::to_string(lookups) + " of " + std::to_string(width) +
+					(threshold > width ? ": scan" : ": index");
+			measure(label.c_str(), 0, 5, [&]() {
+				found = 0;
+				for (size_t n = 0; n < lookups; n++) {
+					if (users->find_child(names[n * 7 % width])) found++;
+				}
+			});
+			if (found != lookups) std::printf("missing children\n");
+		}
+	}
+	dfml::Node::set_child_index_threshold(dfml::Node::CHILD_INDEX_THRESHOLD);
+}
+
+} // namespace bench
@@ -0,0 +1,35 @@
+#include <parse_bench.h>
+#include <build_bench.h>
+#include <binary_bench.h>
+#include <query_bench.h>
+
+#include <cstdlib>
+#include <new>
+
+size_t bench::allocated = 0;
+
+void *operator new(size_t size) {
+	bench::allocated += size;
+	if (void *p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+	bench::allocated += size;
+	size_t align = static_cast<size_t>(alignment);
+	if (void *p = std::aligned_alloc(align, (size + align - 1) / align * align)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+int main() {
+	bench::parse_bench();
+	bench::build_bench();
+	bench::binary_bench();
+	bench::query_bench();
+	return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file attribute_map.h
+ * @brief Declaration of the AttributeMap class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <dfml/value.h>
+
+namespace dfml {
+
+/**
+ * @brief Insertion ordered map of the attributes of a Node.
+ *
+ * The attributes are kept once, in insertion order, in a single vector.
+ * Small maps are searched linearly; above INDEX_THRESHOLD attributes an open
+ * addressing hash index of positions is kept up to date, so lookups stay
+ * O(1). Lookups take a std::string_view and never modify the map, so
+ * concurrent readers are safe.
+ */
+class AttributeMap {
+public:
+	/**
+	 * @brief An attribute: key and value.
+	 */
+	using Entry = std::pair<std::pmr::string, Value>;
+
+	/**
+	 * @brief Count of attributes searched linearly, without a hash index.
+	 */
+	static constexpr size_t INDEX_THRESHOLD = 8;
+
+	/**
+	 * @brief View of the keys of the map, in insertion order.
+	 */
+	class Keys {
+	public:
+		/**
+		 * @brief Iterator over the keys.
+		 */
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::string_view;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const std::string_view *;
+			using reference = std::string_view;
+
+			Iterator(const Entry *entry) : entry(entry) {}
+
+			std::string_view operator*() const { return entry->first; }
+			Iterator &operator++() { entry++; return *this; }
+			Iterator operator++(int) { Iterator it = *this; entry++; return it; }
+			bool operator==(const Iterator &other) const { return entry == other.entry; }
+			bool operator!=(const Iterator &other) const { return entry != other.entry; }
+
+		private:
+			const Entry *entry; /**< Current attribute. */
+		};
+
+		Keys(const Entry *first, const Entry *last) : first(first), last(last) {}
+
+		Iterator begin() const { return Iterator(first); }
+		Iterator end() const { return Iterator(last); }
+		size_t size() const { return last - first; }
+		bool empty() const { return first == last; }
+
+	private:
+		const Entry *first; /**< First attribute. */
+		const Entry *last;  /**< Attribute after the last one. */
+	};
+
+	/**
+	 * @brief Constructor for the AttributeMap class.
+	 *
+	 * @param resource Memory resource of the attributes.
+	 */
+	AttributeMap(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+			: entries(resource), index(resource) {}
+
+	/**
+	 * @brief Finds an attribute.
+	 *
+	 * @param key The key of the attribute.
+	 * @return Value* The value, or nullptr if there is no such attribute.
+	 */
+	Value *find(std::string_view key) {
+		size_t position = locate(key);
+		return position < entries.size() ? &entries[position].second : nullptr;
+	}
+
+	/**
+	 * @brief Finds an attribute.
+	 *
+	 * @param key The key of the attribute.
+	 * @return const Value* The value, or nullptr if there is no such attribute.
+	 */
+	const Value *find(std::string_view key) const {
+		size_t position = locate(key);
+		return position < entries.size() ? &entries[position].second : nullptr;
+	}
+
+	/**
+	 * @brief Checks if the map has an attribute.
+	 *
+	 * @param key The key of the attribute.
+	 * @return true If the attribute exists.
+	 */
+	bool contains(std::string_view key) const { return locate(key) < entries.size(); }
+
+	/**
+	 * @brief Sets an attribute, adding it at the end if it does not exist.
+	 * The value is copied to the memory resource of the map.
+	 *
+	 * @param key The key of the attribute.
+	 * @param value The value of the attribute.
+	 * @return Value& The stored value.
+	 */
+	Value &set(std::string_view key, const Value &value);
+
+	/**
+	 * @brief Gets an attribute, adding it as an empty string if it does not exist.
+	 *
+	 * @param key The key of the attribute.
+	 * @return Value& The stored value.
+	 */
+	Value &get(std::string_view key);
+
+	/**
+	 * @brief Reserves room for a count of attributes.
+	 *
+	 * @param count The count of attributes.
+	 */
+	void reserve(size_t count) { entries.reserve(count); }
+
+	/**
+	 * @brief Gets the keys in insertion order.
+	 *
+	 * @return Keys The keys view.
+	 */
+	Keys keys() const { return Keys(entries.data(), entries.data() + entries.size()); }
+
+	size_t size() const { return entries.size(); }
+	bool empty() const { return entries.empty(); }
+	std::pmr::vector<Entry>::const_iterator begin() const { return entries.begin(); }
+	std::pmr::vector<Entry>::const_iterator end() const { return entries.end(); }
+
+private:
+	/**
+	 * @brief Gets the position of an attribute.
+	 *
+	 * @param key The key of the attribute.
+	 * @return size_t The position, or size() if there is no such attribute.
+	 */
+	size_t locate(std::string_view key) const;
+
+	/**
+	 * @brief Adds the position of an attribute to the hash index.
+	 *
+	 * @param position The position of the attribute.
+	 */
+	void index_position(size_t position);
+
+	/**
+	 * @brief Rebuilds the hash index for the current attributes.
+	 */
+	void rebuild_index();
+
+	std::pmr::vector<Entry> entries; /**< Attributes in insertion order. */
+	std::pmr::vector<uint32_t> index; /**< Hash slots: position + 1, 0 if empty. */
+};
+
+} // namespace dfml
@@ -0,0 +1,293 @@
+/**
+ * @file binary.h
+ * @brief Declaration of the BinaryEncoder and BinaryDecoder classes in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-06
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <dfml/handler.h>
+#include <dfml/value.h>
+
+namespace dfml {
+
+class Element;
+class Document;
+class Tape;
+class Sink;
+
+/**
+ * @brief Constants of the binary DFML encoding.
+ *
+ * A binary document is the MAGIC bytes followed by records in document order,
+ * each one starting with a tag byte:
+ * - NODE: name reference; its attributes, children and END follow.
+ * - ATTRIBUTE: key reference and value.
+ * - END: ends the current node.
+ * - COMMENT: varint length and text.
+ * - STRING: varint length and text; INTEGER and DOUBLE: 8 bytes little endian;
+ *   BOOLEAN_FALSE and BOOLEAN_TRUE: nothing. A value record alone is a data element.
+ *
+ * Names and keys are references to a string table built while encoding: a
+ * varint n > 0 refers to the entry n - 1, and 0 is followed by a new string
+ * (varint length and text), which is added to the table while it has less
+ * than TABLE_SIZE entries.
+ */
+namespace binary {
+	constexpr std::string_view MAGIC("DFMB\x01", 5); /**< Signature and version. */
+
+	constexpr uint8_t NODE = 0x01;      /**< Node record tag. */
+	constexpr uint8_t ATTRIBUTE = 0x02; /**< Attribute record tag. */
+	constexpr uint8_t END = 0x03;       /**< Node end record tag. */
+	constexpr uint8_t COMMENT = 0x04;   /**< Comment record tag. */
+	constexpr uint8_t STRING = 0x10;    /**< String value tag. */
+	constexpr uint8_t INTEGER = 0x11;   /**< Integer value tag. */
+	constexpr uint8_t DOUBLE = 0x12;    /**< Double value tag. */
+	constexpr uint8_t BOOLEAN_FALSE = 0x13; /**< False value tag. */
+	constexpr uint8_t BOOLEAN_TRUE = 0x14; /**< True value tag. */
+
+	constexpr size_t TABLE_SIZE = 1 << 16; /**< Maximum entries of the string table. */
+}
+
+/**
+ * @brief Encoder of DFML elements to the binary encoding.
+ *
+ * The encoder is a Handler, so a text document can be encoded while it is
+ * parsed, without building the elements:
+ * @code
+ * dfml::BufferSink sink;
+ * dfml::BinaryEncoder encoder(sink);
+ * dfml::Parser::create(text)->parse(encoder);
+ * encoder.finish();
+ * @endcode
+ */
+class BinaryEncoder : public Handler {
+public:
+	/**
+	 * @brief Constructor for the BinaryEncoder class. Writes the signature.
+	 *
+	 * @param sink The output, which must outlive the encoder.
+	 */
+	BinaryEncoder(Sink &sink);
+
+	/**
+	 * @brief Creates and returns a shared pointer to a BinaryEncoder instance.
+	 *
+	 * @param sink The output, which must outlive the encoder.
+	 * @return std::shared_ptr<BinaryEncoder> Shared pointer to the new BinaryEncoder instance.
+	 */
+	static std::shared_ptr<BinaryEncoder> create(Sink &sink);
+
+	/**
+	 * @brief Encodes an Element and its children.
+	 *
+	 * @param element The Element to encode.
+	 */
+	void write(const Element &element);
+
+	/**
+	 * @brief Writes the pending output to the sink and flushes it.
+	 */
+	void finish();
+
+	void on_node_begin(std::string_view name) override;
+	void on_attribute(std::string_view key, const Value &value) override;
+	void on_data(const Value &value) override;
+	void on_comment(std::string_view text) override;
+	void on_node_end() override;
+
+private:
+	/**
+	 * @brief Writes an unsigned varint.
+	 *
+	 * @param number The number.
+	 */
+	void put_varint(uint64_t number);
+
+	/**
+	 * @brief Writes a length prefixed string.
+	 *
+	 * @param string The string.
+	 */
+	void put_string(std::string_view string);
+
+	/**
+	 * @brief Writes a name or key reference, adding new ones to the string table.
+	 *
+	 * @param name The name or key.
+	 */
+	void put_name(std::string_view name);
+
+	/**
+	 * @brief Writes a value record.
+	 *
+	 * @param value The value.
+	 */
+	void put_value(const Value &value);
+
+	/**
+	 * @brief Writes the buffer to the sink when it is full.
+	 */
+	void check_buffer();
+
+	Sink &sink;                    /**< Output. */
+	std::string buffer;            /**< Pending output. */
+	std::deque<std::string> names; /**< Strings of the table. */
+	std::unordered_map<std::string_view, uint32_t> table; /**< String table: name to reference. */
+};
+
+/**
+ * @brief Decoder of the binary DFML encoding.
+ *
+ * The decoder reports the same events as the Parser for the equivalent text,
+ * so it builds the same lists, Documents and Tapes.
+ *
+ * Example:
+ * @code
+ * auto elements = dfml::BinaryDecoder::create(data)->decode();
+ * @endcode
+ */
+class BinaryDecoder {
+public:
+	/**
+	 * @brief Constructor for the BinaryDecoder class.
+	 * The data is decoded in place: it must outlive the decoder.
+	 *
+	 * @param data The binary data to decode.
+	 */
+	BinaryDecoder(std::string_view data) : data(data) {}
+
+	/**
+	 * @brief Constructor for the BinaryDecoder class.
+	 * The decoder takes ownership of the data.
+	 *
+	 * @param data The binary data to decode.
+	 */
+	BinaryDecoder(std::string data) : owned(std::move(data)), data(owned) {}
+
+	BinaryDecoder(const BinaryDecoder &) = delete;
+	BinaryDecoder &operator=(const BinaryDecoder &) = delete;
+
+	/**
+	 * @brief Creates and returns a shared pointer to a BinaryDecoder instance.
+	 * The data is decoded in place: it must outlive the decoder.
+	 *
+	 * @param data The binary data to decode.
+	 * @return std::shared_ptr<BinaryDecoder> Shared pointer to the new BinaryDecoder instance.
+	 */
+	static std::shared_ptr<BinaryDecoder> create(std::string_view data);
+
+	/**
+	 * @brief Creates and returns a shared pointer to a BinaryDecoder instance.
+	 * The decoder takes ownership of the data.
+	 *
+	 * @param data The binary data to decode.
+	 * @return std::shared_ptr<BinaryDecoder> Shared pointer to the new BinaryDecoder instance.
+	 */
+	static std::shared_ptr<BinaryDecoder> create(std::string data);
+
+	/**
+	 * @brief Decodes the data and returns the top level elements.
+	 *
+	 * @return std::list<std::shared_ptr<Element>> The decoded elements.
+	 * @throws ParserException If the data is not valid.
+	 */
+	std::list<std::shared_ptr<Element>> decode();
+
+	/**
+	 * @brief Decodes the data into a Document.
+	 *
+	 * @return std::shared_ptr<Document> The decoded document.
+	 * @throws ParserException If the data is not valid.
+	 */
+	std::shared_ptr<Document> decode_document();
+
+	/**
+	 * @brief Decodes the data into an immutable Tape.
+	 *
+	 * @return std::shared_ptr<Tape> The decoded tape.
+	 * @throws ParserException If the data is not valid.
+	 */
+	std::shared_ptr<Tape> decode_tape();
+
+	/**
+	 * @brief Decodes the data reporting each element to the handler.
+	 *
+	 * @param handler The handler that receives the decoding events.
+	 * @throws ParserException If the data is not valid.
+	 */
+	void decode(Handler &handler);
+
+private:
+	/**
+	 * @brief Reads a byte.
+	 *
+	 * @return uint8_t The byte.
+	 */
+	uint8_t get_byte();
+
+	/**
+	 * @brief Reads an unsigned varint.
+	 *
+	 * @return uint64_t The number.
+	 */
+	uint64_t get_varint();
+
+	/**
+	 * @brief Reads 8 bytes little endian.
+	 *
+	 * @return uint64_t The number.
+	 */
+	uint64_t get_fixed();
+
+	/**
+	 * @brief Reads a length prefixed string.
+	 *
+	 * @return std::string_view The string, in the data.
+	 */
+	std::string_view get_string();
+
+	/**
+	 * @brief Reads a name or key reference.
+	 *
+	 * @return std::string_view The name or key, in the data.
+	 */
+	std::string_view get_name();
+
+	/**
+	 * @brief Reads a value given its tag.
+	 *
+	 * @param tag The value tag.
+	 * @return const Value& The value, valid until the next value is read.
+	 */
+	const Value &get_value(uint8_t tag);
+
+	/**
+	 * @brief Throws a ParserException for invalid data.
+	 *
+	 * @param message Description of the error.
+	 */
+	[[noreturn]] void error(const std::string &message) const;
+
+	std::string owned;     /**< Owned data, if any. */
+	std::string_view data; /**< Data being decoded. */
+	size_t position{};     /**< Position of the next byte. */
+	std::vector<std::string_view> table; /**< String table. */
+	Value value;           /**< Last decoded value. */
+};
+
+} // namespace dfml
@@ -20,9 +20,14 @@ class Element;
 class Data;
 class Comment;
 class Value;
+class Sink;
 
 /**
  * @brief Class responsible for building DFML representations as strings.
+ *
+ * The text is written once to a Sink by write(); the build_* methods are
+ * wrappers writing to a memory buffer. Threads may write with the same
+ * Builder at once, as long as its options are not changed meanwhile.
  */
 class Builder {
 public:
@@ -63,6 +68,14 @@ public:
 	 */
 	static std::shared_ptr<Builder> create();
 
+	/**
+	 * @brief Writes the DFML representation of an Element to a sink.
+	 * 
+	 * @param element The Element to write.
+	 * @param sink The output.
+	 */
+	void write(const Element &element, Sink &sink) const;
+
 	/**
 	 * @brief Builds and returns the DFML representation of a Node.
 	 * 
@@ -93,7 +106,7 @@ public:
 	 * @param value The Value to build.
 	 * @return const std::string The DFML representation of the Value.
 	 */
-	const std::string build_value(Value value) const;
+	const std::string build_value(const Value &value) const;
 
 	/**
 	 * @brief Builds and returns the DFML representation of a Comment.
@@ -112,14 +125,50 @@ public:
 	const std::string build_attributes(const std::shared_ptr<Node> node);
 
 private:
+	friend class Writer;
+
+	/**
+	 * @brief Writes an Element at the given level of indentation.
+	 * 
+	 * @param element The Element to write.
+	 * @param sink The output.
+	 * @param level The level of indentation.
+	 */
+	void write_element(const Element &element, Sink &sink, unsigned level) const;
+
+	/**
+	 * @brief Writes a Node and its children.
+	 * 
+	 * @param root The Node to write.
+	 * @param sink The output.
+	 * @param level The level of indentation.
+	 */
+	void write_node(const Node &root, Sink &sink, unsigned level) const;
+
+	/**
+	 * @brief Writes the attribute list of a Node.
+	 * 
+	 * @param node The Node to write.
+	 * @param sink The output.
+	 */
+	void write_attributes(const Node &node, Sink &sink) const;
+
+	/**
+	 * @brief Writes a Value.
+	 * 
+	 * @param value The Value to write.
+	 * @param sink The output.
+	 */
+	void write_value(const Value &value, Sink &sink) const;
+
 	/**
-	 * @brief Gets the current indentation based on the builder's level.
+	 * @brief Writes the indentation of a level.
 	 * 
-	 * @return const std::string The current indentation.
+	 * @param sink The output.
+	 * @param level The level of indentation.
 	 */
-	const std::string indent() const;
+	void write_indent(Sink &sink, unsigned level) const;
 
-	unsigned level{}; /**< Current level of indentation. */
 	bool format; /**< Format the code. */
 	bool use_spaces; /** Use spaces for indent. */
 	unsigned space_count; /** Space count for indent. */
@@ -0,0 +1,164 @@
+/**
+ * @file cache.h
+ * @brief Declaration of the Cache class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-13
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace dfml {
+
+class Element;
+class Document;
+class Tape;
+class Handler;
+class MappedFile;
+
+/**
+ * @brief Cache of parsed DFML files, stored in the binary encoding.
+ *
+ * Each source file is hashed (64 bit FNV-1a of its bytes) and looked up in
+ * the cache directory by its hash and size. On a hit the elements are
+ * decoded from the cached binary form, without running the text Parser; on
+ * a miss the file is parsed, and the binary form is written for the next
+ * time. A changed file gets another hash, so stale entries are never used.
+ *
+ * Entries are written to a temporary file and renamed, so processes sharing
+ * the directory never read partial entries. An entry that cannot be decoded
+ * anyway is removed, and the load is a miss. The loads and statistics are
+ * safe to use from several threads.
+ *
+ * Example:
+ * @code
+ * auto cache = dfml::Cache::create("/var/cache/dfml");
+ * auto elements = cache->load("catalog.dfml");
+ * @endcode
+ */
+class Cache {
+public:
+	/**
+	 * @brief Statistics of the loads of a cache.
+	 */
+	struct Stats {
+		size_t hits;        /**< Loads decoded from the cache. */
+		size_t misses;      /**< Loads parsed from the source. */
+		double hit_time;    /**< Total time of the hits, in seconds. */
+		double miss_time;   /**< Total time of the misses, in seconds. */
+	};
+
+	/**
+	 * @brief Constructor for the Cache class. Creates the directory if needed.
+	 *
+	 * @param directory The cache directory.
+	 * @throws std::runtime_error If the directory cannot be created.
+	 */
+	Cache(const std::string directory);
+
+	/**
+	 * @brief Creates and returns a shared pointer to a Cache instance.
+	 *
+	 * @param directory The cache directory.
+	 * @return std::shared_ptr<Cache> Shared pointer to the new Cache instance.
+	 * @throws std::runtime_error If the directory cannot be created.
+	 */
+	static std::shared_ptr<Cache> create(const std::string directory);
+
+	/**
+	 * @brief Loads a DFML file and returns its top level elements.
+	 *
+	 * @param path Path of the DFML file.
+	 * @return std::list<std::shared_ptr<Element>> The elements.
+	 * @throws std::runtime_error If the file cannot be read.
+	 * @throws ParserException If the file is not valid DFML.
+	 */
+	std::list<std::shared_ptr<Element>> load(const std::string path);
+
+	/**
+	 * @brief Loads a DFML file into a Document.
+	 *
+	 * @param path Path of the DFML file.
+	 * @return std::shared_ptr<Document> The document.
+	 * @throws std::runtime_error If the file cannot be read.
+	 * @throws ParserException If the file is not valid DFML.
+	 */
+	std::shared_ptr<Document> load_document(const std::string path);
+
+	/**
+	 * @brief Loads a DFML file into a Tape.
+	 *
+	 * @param path Path of the DFML file.
+	 * @return std::shared_ptr<Tape> The tape.
+	 * @throws std::runtime_error If the file cannot be read.
+	 * @throws ParserException If the file is not valid DFML.
+	 */
+	std::shared_ptr<Tape> load_tape(const std::string path);
+
+	/**
+	 * @brief Loads a DFML file reporting each element to the handler.
+	 * On a hit the entry is decoded into elements first, so a corrupt entry
+	 * reports nothing before the file is parsed.
+	 *
+	 * @param path Path of the DFML file.
+	 * @param handler The handler that receives the events.
+	 * @throws std::runtime_error If the file cannot be read.
+	 * @throws ParserException If the file is not valid DFML.
+	 */
+	void load(const std::string path, Handler &handler);
+
+	/**
+	 * @brief Gets the statistics of the loads so far.
+	 *
+	 * @return Stats The statistics.
+	 */
+	Stats get_stats() const;
+
+	/**
+	 * @brief Gets the 64 bit FNV-1a hash of some data.
+	 *
+	 * @param data The data.
+	 * @return uint64_t The hash.
+	 */
+	static uint64_t hash(std::string_view data);
+
+private:
+	/**
+	 * @brief Loads a DFML file into a handler made for the load.
+	 *
+	 * @param path Path of the DFML file.
+	 * @param make Makes the handler, given true to decode an entry, false to
+	 * parse the file; the partial result of a failed decode is dropped by
+	 * making the handler again.
+	 * @throws std::runtime_error If the file cannot be read.
+	 * @throws ParserException If the file is not valid DFML.
+	 */
+	void load(const std::string path, const std::function<Handler &(bool)> &make);
+
+	/**
+	 * @brief Gets the path of the cache entry of some source data.
+	 *
+	 * @param data The source data.
+	 * @return std::string Path of the entry.
+	 */
+	std::string entry_path(std::string_view data) const;
+
+	std::string directory;             /**< Cache directory. */
+	std::atomic<size_t> hits{};        /**< Count of hits. */
+	std::atomic<size_t> misses{};      /**< Count of misses. */
+	std::atomic<uint64_t> hit_nanoseconds{};  /**< Total time of the hits. */
+	std::atomic<uint64_t> miss_nanoseconds{}; /**< Total time of the misses. */
+};
+
+} // namespace dfml
@@ -13,6 +13,9 @@
 #include <dfml/element.h>
 
 #include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
 
 namespace dfml {
 
@@ -21,6 +24,20 @@ namespace dfml {
  */
 class Comment : public Element {
 public:
+	/**
+	 * @brief Default constructor for the Comment class.
+	 */
+	Comment() = default;
+
+	/**
+	 * @brief Constructor for a Comment allocating its content from a memory resource.
+	 * The resource must outlive the comment.
+	 * 
+	 * @param string The content of the comment.
+	 * @param resource The memory resource.
+	 */
+	Comment(std::string_view string, std::pmr::memory_resource *resource) : string(string, resource) {}
+
 	/**
 	 * @brief Creates and returns a shared pointer to an empty Comment instance.
 	 * 
@@ -41,24 +58,27 @@ public:
 	 * 
 	 * @param string The content to set for the comment.
 	 */
-	void set_string(const std::string string) { this->string = string; }
+	void set_string(const std::string string) { this->string.assign(string); }
 
 	/**
 	 * @brief Gets the string content of the comment.
 	 * 
 	 * @return const std::string The content of the comment.
 	 */
-	const std::string get_string() const { return string; }
+	const std::string get_string() const { return std::string(string); }
 
 	/**
 	 * @brief Gets the element type as an integer, identifying it as a comment.
 	 * 
 	 * @return int The element type (COMMENT).
 	 */
-	int get_element_type() override { return Element::COMMENT; }
+	int get_element_type() const override { return Element::COMMENT; }
 
 private:
-	std::string string{}; /**< Content of the comment. */
+	friend class Builder;
+	friend class BinaryEncoder;
+
+	std::pmr::string string{}; /**< Content of the comment. */
 };
 
 } // namespace dfml
@@ -13,6 +13,7 @@
 #include <dfml/element.h>
 #include <dfml/value.h>
 
+#include <memory_resource>
 #include <string>
 
 namespace dfml {
@@ -34,6 +35,15 @@ public:
 	 */
 	Data(Value value) : value(value) {}
 
+	/**
+	 * @brief Construct a new Data object allocating its value from a memory resource.
+	 * The resource must outlive the data.
+	 * 
+	 * @param value value object
+	 * @param resource The memory resource.
+	 */
+	Data(const Value &value, std::pmr::memory_resource *resource) : value(value, resource) {}
+
 	/**
 	 * @brief Creates and returns a shared pointer to an empty Data instance.
 	 * 
@@ -86,7 +96,7 @@ public:
 	 * 
 	 * @return int The element type (DATA).
 	 */
-	int get_element_type() override { return Element::DATA; }
+	int get_element_type() const override { return Element::DATA; }
 
 	/**
 	 * @brief Gets the value object associated with the data.
@@ -95,6 +105,13 @@ public:
 	 */
 	Value &get_value() { return value; }
 
+	/**
+	 * @brief Gets the value object associated with the data.
+	 * 
+	 * @return const Value& Reference to the Value object.
+	 */
+	const Value &get_value() const { return value; }
+
 private:
 	Value value{}; /**< Value object associated with the data. */
 };
@@ -15,3 +15,5 @@
 #include <dfml/data.h>
 #include <dfml/value.h>
 #include <dfml/comment.h>
+#include <dfml/document.h>
+#include <dfml/tape.h>
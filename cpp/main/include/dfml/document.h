@@ -0,0 +1,139 @@
+/**
+ * @file document.h
+ * @brief Declaration of the Document class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-02
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace dfml {
+
+class Element;
+class Node;
+class Data;
+class Comment;
+class Value;
+class NameIndex;
+
+/**
+ * @brief DFML document owning a memory arena for its elements.
+ *
+ * The elements created by a Document, with their names, attributes, strings
+ * and children lists, are allocated from a monotonic arena. Nothing is
+ * released until the document is destroyed, and then the arena is freed a
+ * block at a time instead of an allocation at a time.
+ *
+ * The arena is shared by the elements: an element kept after its document
+ * is destroyed, with its descendants, stays valid, and keeps the arena
+ * alive until it is released.
+ *
+ * Example:
+ * @code
+ * auto document = dfml::Parser::create(data)->parse_document();
+ * for (auto &element : document->get_elements()) { ... }
+ * @endcode
+ */
+class Document {
+public:
+	/**
+	 * @brief Constructor for the Document class.
+	 *
+	 * @param block_size Size of the first arena block, 0 for the default.
+	 */
+	Document(size_t block_size = 0);
+
+	/**
+	 * @brief Destructor for the Document class.
+	 * Destroys the elements before releasing the arena.
+	 */
+	~Document();
+
+	Document(const Document &) = delete;
+	Document &operator=(const Document &) = delete;
+
+	/**
+	 * @brief Creates and returns a shared pointer to a Document instance.
+	 *
+	 * @param block_size Size of the first arena block, 0 for the default.
+	 * @return std::shared_ptr<Document> Shared pointer to the new Document instance.
+	 */
+	static std::shared_ptr<Document> create(size_t block_size = 0);
+
+	/**
+	 * @brief Creates a Node in the arena of the document.
+	 *
+	 * @param name The name of the node.
+	 * @return std::shared_ptr<Node> Shared pointer to the new Node.
+	 */
+	std::shared_ptr<Node> create_node(std::string_view name);
+
+	/**
+	 * @brief Creates a Data in the arena of the document.
+	 *
+	 * @param value The value of the data, copied to the arena.
+	 * @return std::shared_ptr<Data> Shared pointer to the new Data.
+	 */
+	std::shared_ptr<Data> create_data(const Value &value);
+
+	/**
+	 * @brief Creates a Comment in the arena of the document.
+	 *
+	 * @param string The content of the comment.
+	 * @return std::shared_ptr<Comment> Shared pointer to the new Comment.
+	 */
+	std::shared_ptr<Comment> create_comment(std::string_view string);
+
+	/**
+	 * @brief Adds a top level element, to the index too if there is one.
+	 *
+	 * @param element The element to add.
+	 */
+	void add_element(std::shared_ptr<Element> element);
+
+	/**
+	 * @brief Creates the name index of the document, with the current elements.
+	 * The index is then updated when elements are added. Returns the existing
+	 * index if there is one.
+	 *
+	 * @return NameIndex& The index.
+	 */
+	NameIndex &create_index();
+
+	/**
+	 * @brief Gets the name index of the document.
+	 *
+	 * @return NameIndex* The index, or nullptr if it was not created.
+	 */
+	NameIndex *get_index() const { return index.get(); }
+
+	/**
+	 * @brief Gets the top level elements.
+	 *
+	 * @return const std::pmr::vector<std::shared_ptr<Element>>& The top level elements.
+	 */
+	const std::pmr::vector<std::shared_ptr<Element>> &get_elements() const { return elements; }
+
+	/**
+	 * @brief Gets the memory resource of the arena.
+	 *
+	 * @return std::pmr::memory_resource* The arena.
+	 */
+	std::pmr::memory_resource *get_resource() { return arena.get(); }
+
+private:
+	std::shared_ptr<std::pmr::monotonic_buffer_resource> arena; /**< Memory of the elements, shared with them. */
+	std::pmr::vector<std::shared_ptr<Element>> elements; /**< Top level elements. */
+	std::unique_ptr<NameIndex> index; /**< Index of the node names, if created. */
+};
+
+} // namespace dfml
@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <string>
 
@@ -17,6 +19,45 @@ namespace dfml {
 
 class Node;
 
+/**
+ * @brief Non owning view of the ancestors of an Element, from its parent up
+ * to the root. Nothing is allocated: it follows the parent links.
+ */
+class AncestorRange {
+public:
+	/**
+	 * @brief Iterator over the ancestors.
+	 */
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Node *;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Node *const *;
+		using reference = Node *;
+
+		Iterator(Node *node) : node(node) {}
+
+		Node *operator*() const { return node; }
+		Iterator &operator++();
+		Iterator operator++(int) { Iterator it = *this; ++*this; return it; }
+		bool operator==(const Iterator &other) const { return node == other.node; }
+		bool operator!=(const Iterator &other) const { return node != other.node; }
+
+	private:
+		Node *node; /**< Current ancestor. */
+	};
+
+	AncestorRange(Node *parent) : parent(parent) {}
+
+	Iterator begin() const { return Iterator(parent); }
+	Iterator end() const { return Iterator(nullptr); }
+	bool empty() const { return parent == nullptr; }
+
+private:
+	Node *parent; /**< First ancestor. */
+};
+
 /**
  * @brief Base class representing an element in the Dragonfly Markup Language (DFML) structure.
  */
@@ -24,10 +65,34 @@ class Element {
 public:
 	/**
 	 * @brief Gets the parent node of the element.
+	 * The link is not owning: it is kept up to date by Node::add_child() and
+	 * Node::remove_child(), and cleared when the parent is destroyed.
 	 * 
-	 * @return std::shared_ptr<Node> Shared pointer to the parent node.
+	 * @return Node* The parent node, or nullptr at the top level.
 	 */
-	std::shared_ptr<Node> get_parent() { return parent; }
+	Node *get_parent() const { return parent; }
+
+	/**
+	 * @brief Gets the ancestors of the element, from its parent up to the root.
+	 * 
+	 * @return AncestorRange View of the ancestors.
+	 */
+	AncestorRange ancestors() const { return AncestorRange(parent); }
+
+	/**
+	 * @brief Gets the count of ancestors of the element.
+	 * 
+	 * @return size_t The depth, 0 at the top level.
+	 */
+	size_t depth() const;
+
+	/**
+	 * @brief Gets the names of the nodes from the root down to the element,
+	 * as "/root/child/node". Data and comments have the path of their parent.
+	 * 
+	 * @return std::string The path.
+	 */
+	std::string path() const;
 
 	/**
 	 * @brief Gets the type of the element.
@@ -37,7 +102,7 @@ public:
 	 * - DATA: 1 - Represents a data (value only).
 	 * - COMMENT: 2 - Represents a comment.
 	 */
-	virtual int get_element_type() = 0;
+	virtual int get_element_type() const = 0;
 
 	/**
 	 * @brief Constant representing a Node element type.
@@ -55,7 +120,9 @@ public:
 	static constexpr int COMMENT = 2;
 
 private:
-	std::shared_ptr<Node> parent; /**< Shared pointer to the parent node. */
+	friend class Node;
+
+	Node *parent{}; /**< Parent node, not owned. */
 };
 
 } // namespace dfml
@@ -0,0 +1,114 @@
+/**
+ * @file handler.h
+ * @brief Declaration of the Handler and TreeHandler classes in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-03
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace dfml {
+
+class Element;
+class Node;
+class Value;
+class Document;
+
+/**
+ * @brief Receives the parsing events of a DFML document.
+ *
+ * The Parser calls these methods in document order while it scans the data,
+ * without building any Element. The names, keys and texts are only valid
+ * during the call: copy them if they must be kept.
+ * Every method does nothing by default.
+ */
+class Handler {
+public:
+	virtual ~Handler() = default;
+
+	/**
+	 * @brief Called when a node starts, before its attributes and children.
+	 *
+	 * @param name The name of the node.
+	 */
+	virtual void on_node_begin(std::string_view /*name*/) {}
+
+	/**
+	 * @brief Called for each attribute of the current node.
+	 *
+	 * @param key The key of the attribute.
+	 * @param value The value of the attribute.
+	 */
+	virtual void on_attribute(std::string_view /*key*/, const Value &/*value*/) {}
+
+	/**
+	 * @brief Called for each data element.
+	 *
+	 * @param value The value of the data.
+	 */
+	virtual void on_data(const Value &/*value*/) {}
+
+	/**
+	 * @brief Called for each comment.
+	 *
+	 * @param text The content of the comment.
+	 */
+	virtual void on_comment(std::string_view /*text*/) {}
+
+	/**
+	 * @brief Called when the current node ends, after its children.
+	 */
+	virtual void on_node_end() {}
+};
+
+/**
+ * @brief Handler that assembles the parsing events into an Element tree.
+ *
+ * This is the handler used by Parser::parse() to return the parsed elements.
+ */
+class TreeHandler : public Handler {
+public:
+	/**
+	 * @brief Constructor for the TreeHandler class.
+	 *
+	 * @param document Document creating the elements and receiving the top level
+	 * ones, or nullptr to create them with the shared_ptr factories.
+	 */
+	TreeHandler(Document *document = nullptr) : document(document) {}
+
+	void on_node_begin(std::string_view name) override;
+	void on_attribute(std::string_view key, const Value &value) override;
+	void on_data(const Value &value) override;
+	void on_comment(std::string_view text) override;
+	void on_node_end() override;
+
+	/**
+	 * @brief Gets the top level elements assembled so far.
+	 * Empty when the elements are added to a Document.
+	 *
+	 * @return std::list<std::shared_ptr<Element>>& The list of top level elements.
+	 */
+	std::list<std::shared_ptr<Element>> &get_elements() { return elements; }
+
+private:
+	/**
+	 * @brief Adds an element to the current node, or to the top level.
+	 *
+	 * @param element The element to add.
+	 */
+	void add(std::shared_ptr<Element> element);
+
+	Document *document; /**< Document of the elements, if any. */
+	std::list<std::shared_ptr<Element>> elements; /**< Top level elements. */
+	std::vector<std::shared_ptr<Node>> nodes; /**< Stack of open nodes. */
+};
+
+} // namespace dfml
@@ -0,0 +1,91 @@
+/**
+ * @file loader.h
+ * @brief Declaration of the load_files() function in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dfml {
+
+class Element;
+class ThreadPool;
+class Cache;
+
+/**
+ * @brief Options of load_files().
+ */
+struct LoadOptions {
+	unsigned threads = 0;       /**< Threads of the temporary pool, 0 for one per hardware thread. */
+	ThreadPool *pool = nullptr; /**< Pool to use instead of a temporary one. */
+	Cache *cache = nullptr;     /**< Cache to load the files through, if any. */
+};
+
+/**
+ * @brief Result of loading one file.
+ */
+struct FileResult {
+	std::string path;                              /**< Path of the file. */
+	std::list<std::shared_ptr<Element>> elements;  /**< Top level elements, empty on error. */
+	size_t size{};                                 /**< Size of the file in bytes. */
+	std::exception_ptr error;                      /**< Exception thrown loading the file, if any. */
+	std::string message;                           /**< Message of the exception, if any. */
+
+	/**
+	 * @brief Checks if the file was loaded.
+	 *
+	 * @return true If there was no error.
+	 */
+	bool ok() const { return !error; }
+};
+
+/**
+ * @brief Results of load_files().
+ */
+struct LoadResults {
+	std::vector<FileResult> files; /**< Results in the order of the paths. */
+	size_t failures{};             /**< Count of files that failed. */
+	size_t bytes{};                /**< Total size of the loaded files. */
+	double seconds{};              /**< Time of the whole batch. */
+
+	/**
+	 * @brief Gets the throughput of the batch.
+	 *
+	 * @return double Bytes loaded per second.
+	 */
+	double bytes_per_second() const { return seconds > 0 ? bytes / seconds : 0; }
+};
+
+/**
+ * @brief Loads a batch of DFML files concurrently.
+ *
+ * Each file is mapped and parsed by a worker of the pool, which asks the
+ * kernel to read the next file ahead first. An error, of any type, is kept
+ * in the result of its file and does not stop the others.
+ *
+ * Example:
+ * @code
+ * auto results = dfml::load_files(paths);
+ * for (auto &file : results.files) {
+ *     if (!file.ok()) std::cerr << file.path << ": " << file.message << "\n";
+ * }
+ * @endcode
+ *
+ * @param paths Paths of the files.
+ * @param options Pool and cache to use.
+ * @return LoadResults The result of each file and the totals.
+ */
+LoadResults load_files(const std::vector<std::string> &paths, const LoadOptions &options = LoadOptions());
+
+} // namespace dfml
@@ -0,0 +1,80 @@
+/**
+ * @file mapped_file.h
+ * @brief Declaration of the MappedFile class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-03
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace dfml {
+
+/**
+ * @brief Read-only view of a whole file mapped into memory.
+ *
+ * The contents are mapped with mmap() where available, so the file is never
+ * copied into the process: pages are loaded by the kernel as they are read.
+ * On platforms without mmap() the file is read into an internal buffer.
+ */
+class MappedFile {
+public:
+	/**
+	 * @brief Maps the given file in read-only mode.
+	 *
+	 * @param path Path of the file to map.
+	 * @return std::shared_ptr<MappedFile> Shared pointer to the new MappedFile instance.
+	 * @throws std::runtime_error If the file cannot be opened or mapped.
+	 */
+	static std::shared_ptr<MappedFile> open(const std::string path);
+
+	/**
+	 * @brief Unmaps the file.
+	 */
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/**
+	 * @brief Gets the first byte of the mapped contents.
+	 *
+	 * @return const char* Pointer to the contents (nullptr for empty files).
+	 */
+	const char *data() const { return bytes; }
+
+	/**
+	 * @brief Gets the size of the mapped contents.
+	 *
+	 * @return size_t Size in bytes.
+	 */
+	size_t size() const { return length; }
+
+	/**
+	 * @brief Gets the mapped contents as a string view.
+	 *
+	 * @return std::string_view View valid while this MappedFile is alive.
+	 */
+	std::string_view view() const { return std::string_view(bytes, length); }
+
+	/**
+	 * @brief Asks the kernel to read the whole file ahead, without waiting.
+	 * Does nothing where mmap() is unavailable, as the file is already read.
+	 */
+	void will_need() const;
+
+private:
+	MappedFile() = default;
+
+	const char *bytes{};     /**< Mapped contents. */
+	size_t length{};         /**< Size of the mapped contents. */
+	std::string buffer{};    /**< Fallback storage when mmap() is unavailable. */
+};
+
+} // namespace dfml
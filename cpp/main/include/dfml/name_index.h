@@ -0,0 +1,206 @@
+/**
+ * @file name_index.h
+ * @brief Declaration of the NameIndex class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-13
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dfml {
+
+class Element;
+class Node;
+
+/**
+ * @brief Index of the nodes of a tree by name and by attribute key.
+ *
+ * The nodes with a name, or with an attribute, are kept in document order,
+ * so asking for every "route" node is a lookup instead of a walk of the
+ * tree. The indexed nodes keep a link to the index, through which
+ * Node::add_child(), Node::remove_child(), Node::set_name() and the
+ * attribute setters keep it up to date. Lookups don't modify the index, so
+ * concurrent readers are safe while the tree is not modified.
+ *
+ * Indexed nodes leave the index when they are destroyed, and the index
+ * clears the link of the nodes left when it is destroyed, so either may go
+ * first.
+ */
+class NameIndex {
+public:
+	/**
+	 * @brief List of nodes in document order.
+	 */
+	using Nodes = std::vector<Node *>;
+
+	NameIndex() = default;
+
+	/**
+	 * @brief Destructor for the NameIndex class.
+	 * Clears the link to the index of the indexed nodes.
+	 */
+	~NameIndex();
+
+	NameIndex(const NameIndex &) = delete;
+	NameIndex &operator=(const NameIndex &) = delete;
+
+	/**
+	 * @brief Creates and returns a shared pointer to a NameIndex instance.
+	 *
+	 * @return std::shared_ptr<NameIndex> Shared pointer to the new instance.
+	 */
+	static std::shared_ptr<NameIndex> create();
+
+	/**
+	 * @brief Adds an element and its descendants to the index.
+	 * An element without parent is a root: roots are in the order they are added.
+	 *
+	 * @param element The element to add.
+	 */
+	void add(Element &element);
+
+	/**
+	 * @brief Adds top level elements and their descendants to the index.
+	 *
+	 * @param elements The elements to add, as returned by Parser::parse().
+	 */
+	void add(const std::list<std::shared_ptr<Element>> &elements);
+
+	/**
+	 * @brief Removes an element and its descendants from the index.
+	 *
+	 * @param element The element to remove.
+	 */
+	void remove(Element &element);
+
+	/**
+	 * @brief Removes every node from the index.
+	 */
+	void clear();
+
+	/**
+	 * @brief Gets the nodes with a name.
+	 *
+	 * @param name The name of the nodes.
+	 * @return const Nodes& The nodes in document order, empty if there is none.
+	 */
+	const Nodes &find_nodes(std::string_view name) const;
+
+	/**
+	 * @brief Gets the nodes with an attribute.
+	 *
+	 * @param key The key of the attribute.
+	 * @return const Nodes& The nodes in document order, empty if there is none.
+	 */
+	const Nodes &find_keys(std::string_view key) const;
+
+	/**
+	 * @brief Gets the count of indexed nodes.
+	 *
+	 * @return size_t The count of nodes.
+	 */
+	size_t size() const { return count; }
+
+	/**
+	 * @brief Checks if a node comes before another one in document order.
+	 * The nodes are compared through their parent links, walking up to the
+	 * closest common ancestor.
+	 *
+	 * @param a The first node.
+	 * @param b The second node.
+	 * @return true If a comes before b.
+	 */
+	bool precedes(const Node *a, const Node *b) const;
+
+private:
+	friend class Node;
+
+	using Map = std::unordered_map<std::string_view, Nodes>;
+
+	/**
+	 * @brief Entry of the cache of recent names and keys.
+	 */
+	struct Cached {
+		const Map *map{};       /**< Map of the entry. */
+		std::string_view name;  /**< Name or key, stored in the map. */
+		Nodes *nodes{};         /**< Nodes of the name or key. */
+	};
+
+	/**
+	 * @brief Count of entries of the cache.
+	 */
+	static constexpr size_t CACHE_SIZE = 64;
+
+	/**
+	 * @brief Checks if a node comes before one of its siblings.
+	 *
+	 * @param x The first node.
+	 * @param y The second node, with the same parent.
+	 * @return true If x comes before y.
+	 */
+	bool sibling_precedes(const Node *x, const Node *y) const;
+
+	/**
+	 * @brief Adds a node to the list of a name or key, in document order.
+	 *
+	 * @param map The map of names or keys.
+	 * @param name The name or key.
+	 * @param node The node.
+	 */
+	void insert(Map &map, std::string_view name, Node *node);
+
+	/**
+	 * @brief Removes a node from the list of a name or key.
+	 * The list is searched from both ends at once.
+	 *
+	 * @param map The map of names or keys.
+	 * @param name The name or key.
+	 * @param node The node.
+	 */
+	static void erase(Map &map, std::string_view name, Node *node);
+
+	/**
+	 * @brief Removes a node being destroyed, with the descendants destroyed
+	 * with it.
+	 *
+	 * @param root The node.
+	 */
+	void forget(Node &root);
+
+	/**
+	 * @brief Updates the index after a node is renamed.
+	 *
+	 * @param node The node, with the new name.
+	 * @param old_name The previous name.
+	 */
+	void rename(Node &node, std::string_view old_name);
+
+	/**
+	 * @brief Updates the index after an attribute is added to a node.
+	 *
+	 * @param node The node.
+	 * @param key The key of the new attribute.
+	 */
+	void add_key(Node &node, std::string_view key) { insert(keys, key, &node); }
+
+	Map names; /**< Nodes by name. */
+	Map keys; /**< Nodes by attribute key. */
+	std::deque<std::string> strings; /**< Storage of the names and keys of the maps. */
+	std::vector<Node *> roots; /**< Indexed nodes without parent, in added order. */
+	const Node *tail{}; /**< Last indexed node in document order, nullptr if unknown. */
+	Cached cache[CACHE_SIZE]; /**< Recent names and keys, saving hash lookups. */
+	size_t count{}; /**< Count of indexed nodes. */
+};
+
+} // namespace dfml
@@ -10,14 +10,43 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
-#include <list>
-#include <map>
+#include <string_view>
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
 #include <dfml/element.h>
+#include <dfml/value.h>
+#include <dfml/attribute_map.h>
 
 namespace dfml {
 
-class Value;
+class NameIndex;
+
+/**
+ * @brief Non owning view of the children of a Node.
+ * It is invalidated when children are added to or removed from the node.
+ */
+class ChildRange {
+public:
+	using iterator = const std::shared_ptr<Element> *;
+
+	ChildRange(iterator first, iterator last) : first(first), last(last) {}
+
+	iterator begin() const { return first; }
+	iterator end() const { return last; }
+	size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+	const std::shared_ptr<Element> &front() const { return *first; }
+	const std::shared_ptr<Element> &back() const { return *(last - 1); }
+	const std::shared_ptr<Element> &operator[](size_t index) const { return first[index]; }
+
+private:
+	iterator first; /**< First child. */
+	iterator last;  /**< Child after the last one. */
+};
 
 /**
  * @brief Class representing a node in the Dragonfly Markup Language (DFML).
@@ -27,11 +56,37 @@ class Value;
  */
 class Node : public Element {
 public:
+	/**
+	 * @brief Default child count from which find_child() and find_children()
+	 * use an index of the children by name.
+	 */
+	static constexpr size_t CHILD_INDEX_THRESHOLD = 32;
+
 	/**
 	 * @brief Default constructor for the Node class.
 	 */
 	Node() = default;
 
+	/**
+	 * @brief Constructor for a Node allocating its name, attributes and children list
+	 * from a memory resource. The resource must outlive the node.
+	 * 
+	 * @param name The name of the node.
+	 * @param resource The memory resource.
+	 */
+	Node(std::string_view name, std::pmr::memory_resource *resource)
+			: name(name, resource), attrs(resource), children(resource) {}
+
+	/**
+	 * @brief Destructor for the Node class.
+	 * Leaves the name index, and clears the parent link of the children that
+	 * outlive the node.
+	 */
+	~Node();
+
+	Node(const Node &) = delete;
+	Node &operator=(const Node &) = delete;
+
 	/**
 	 * @brief Creates and returns a shared pointer to an instance of Node with the specified name.
 	 * 
@@ -45,35 +100,104 @@ public:
 	 * 
 	 * @param name The name to set for the node.
 	 */
-	void set_name(const std::string name) { this->name = name; }
+	void set_name(const std::string name);
 
 	/**
 	 * @brief Gets the name of the node.
 	 * 
 	 * @return std::string The name of the node.
 	 */
-	std::string get_name() { return name; }
+	std::string get_name() const { return std::string(name); }
 
 	/**
 	 * @brief Returns the element type as an integer, identifying it as a node.
 	 * 
 	 * @return int The element type (NODE).
 	 */
-	int get_element_type() override { return Element::NODE; }
+	int get_element_type() const override { return Element::NODE; }
 
 	/**
-	 * @brief Adds a child element to the node.
+	 * @brief Adds a child element to the node, which becomes its parent.
+	 * An element has a single parent: it is removed from the previous one
+	 * first, and a top level node from its index. The child is added to the
+	 * index of the node.
 	 * 
 	 * @param element The child element to add.
 	 */
 	void add_child(std::shared_ptr<Element> element);
 
 	/**
-	 * @brief Gets the list of child elements of the node.
+	 * @brief Removes a child element given its position, clearing its parent.
+	 * The child is removed from the index of the node.
 	 * 
-	 * @return const std::list<std::shared_ptr<Element>> List of child elements.
+	 * @param index Position of the child, less than child_count().
+	 * @return std::shared_ptr<Element> The removed child.
 	 */
-	const std::list<std::shared_ptr<Element>> get_children() const { return children; }
+	std::shared_ptr<Element> remove_child(size_t index);
+
+	/**
+	 * @brief Gets the child elements of the node, without copying them.
+	 * 
+	 * @return ChildRange View of the child elements.
+	 */
+	ChildRange get_children() const { return ChildRange(children.data(), children.data() + children.size()); }
+
+	/**
+	 * @brief Gets the count of child elements.
+	 * 
+	 * @return size_t The count of children.
+	 */
+	size_t child_count() const { return children.size(); }
+
+	/**
+	 * @brief Gets a child element given its position.
+	 * 
+	 * @param index Position of the child, less than child_count().
+	 * @return const std::shared_ptr<Element>& The child element.
+	 */
+	const std::shared_ptr<Element> &child(size_t index) const { return children[index]; }
+
+	/**
+	 * @brief Finds the first child node with a name.
+	 * Small nodes are scanned; nodes with at least get_child_index_threshold()
+	 * children build an index of their children by name on the first lookup,
+	 * kept until a child is removed or renamed. Safe to call on a shared node
+	 * from many threads, while it is not modified.
+	 * 
+	 * @param name The name of the child.
+	 * @return Node* The child, or nullptr if there is none.
+	 */
+	Node *find_child(std::string_view name) const;
+
+	/**
+	 * @brief Finds the child nodes with a name, as find_child().
+	 * 
+	 * @param name The name of the children.
+	 * @return std::vector<Node *> The children in order, empty if there is none.
+	 */
+	std::vector<Node *> find_children(std::string_view name) const;
+
+	/**
+	 * @brief Sets the child count from which nodes index their children by name.
+	 * Nodes already indexed keep their index.
+	 * 
+	 * @param count The child count, CHILD_INDEX_THRESHOLD by default.
+	 */
+	static void set_child_index_threshold(size_t count);
+
+	/**
+	 * @brief Gets the child count from which nodes index their children by name.
+	 * 
+	 * @return size_t The child count.
+	 */
+	static size_t get_child_index_threshold();
+
+	/**
+	 * @brief Reserves room for a count of children.
+	 * 
+	 * @param count The count of children.
+	 */
+	void reserve(size_t count) { children.reserve(count); }
 
 	/**
 	 * @brief Sets an attribute for the node with the given value.
@@ -81,7 +205,7 @@ public:
 	 * @param name The name of the attribute.
 	 * @param value The value of the attribute.
 	 */
-	void set_attribute(const std::string name, const Value value);
+	void set_attribute(std::string_view name, const Value &value);
 
 	/**
 	 * @brief Sets a string attribute for the node.
@@ -89,7 +213,7 @@ public:
 	 * @param name The name of the attribute.
 	 * @param value The value of the attribute as a string.
 	 */
-	void set_attr_string(const std::string name, const std::string value);
+	void set_attr_string(std::string_view name, const std::string value);
 
 	/**
 	 * @brief Sets an integer attribute for the node.
@@ -97,7 +221,7 @@ public:
 	 * @param name The name of the attribute.
 	 * @param value The value of the attribute as an integer.
 	 */
-	void set_attr_integer(const std::string name, long value);
+	void set_attr_integer(std::string_view name, long value);
 
 	/**
 	 * @brief Sets a double attribute for the node.
@@ -105,7 +229,7 @@ public:
 	 * @param name The name of the attribute.
 	 * @param value The value of the attribute as a double.
 	 */
-	void set_attr_double(const std::string name, double value);
+	void set_attr_double(std::string_view name, double value);
 
 	/**
 	 * @brief Sets a boolean attribute for the node.
@@ -113,15 +237,50 @@ public:
 	 * @param name The name of the attribute.
 	 * @param value The value of the attribute as a boolean.
 	 */
-	void set_attr_boolean(const std::string name, bool value);
+	void set_attr_boolean(std::string_view name, bool value);
 
 	/**
 	 * @brief Gets the value of an attribute given its name.
+	 * A missing attribute is added as an empty string: use find_attr() or
+	 * attr() to read without modifying the node.
 	 * 
 	 * @param name The name of the attribute.
 	 * @return const Value & Attribute's value reference.
 	 */
-	Value &get_attr(const std::string name);
+	Value &get_attr(std::string_view name);
+
+	/**
+	 * @brief Finds an attribute given its name, without adding it.
+	 * Safe to call on a shared node from many threads.
+	 * 
+	 * @param name The name of the attribute.
+	 * @return const Value* The value, or nullptr if there is no such attribute.
+	 */
+	const Value *find_attr(std::string_view name) const { return attrs.find(name); }
+
+	/**
+	 * @brief Gets the value of an attribute, or a fallback if it is missing.
+	 * The fallback is returned by reference: it must outlive the result.
+	 * 
+	 * @param name The name of the attribute.
+	 * @param fallback The value returned for a missing attribute.
+	 * @return const Value& The attribute's value, or the fallback.
+	 */
+	const Value &get_attr_or(std::string_view name, const Value &fallback) const;
+
+	/**
+	 * @brief Gets the data of an attribute of the given type.
+	 * 
+	 * @tparam T std::string, std::string_view, long, double or bool.
+	 * @param name The name of the attribute.
+	 * @return std::optional<T> The data, or empty if the attribute is missing or of other type.
+	 */
+	template <typename T>
+	std::optional<T> attr(std::string_view name) const {
+		const Value *value = attrs.find(name);
+		if (!value || !value->is<T>()) return std::nullopt;
+		return value->get<T>();
+	}
 
 	/**
 	 * @brief Checks if the node has an attribute given its name.
@@ -130,21 +289,54 @@ public:
 	 * @return true If the node has the attribute.
 	 * @return false If the node does not have the attribute.
 	 */
-	bool has_attr(const std::string name);
+	bool has_attr(std::string_view name) const;
 
 	/**
 	 * @brief Gets the attribute keys in added order.
 	 * 
-	 * @return const std::list<std::string>& attribute key list.
+	 * @return AttributeMap::Keys attribute key list.
 	 */
-	const std::list<std::string> &get_attr_keys() { return keys; }
+	AttributeMap::Keys get_attr_keys() const { return attrs.keys(); }
+
+	/**
+	 * @brief Gets the attributes in added order.
+	 * 
+	 * @return const AttributeMap& attribute map.
+	 */
+	const AttributeMap &get_attributes() const { return attrs; }
+
+	/**
+	 * @brief Gets the name index updated by the node, if any.
+	 * 
+	 * @return NameIndex* The index, or nullptr.
+	 */
+	NameIndex *get_index() const { return index; }
 
 private:
-	std::string name{}; /**< Name of the node. */
-	//std::vector<std::pair<std::string, Value>> attrs; /**< List of attributes of the node. */
-	std::map<std::string, Value> attrs; /**< Attribute map. */
-	std::list<std::string> keys; /** Ordered attribute key list. */
-	std::list<std::shared_ptr<Element>> children; /**< List of child elements of the node. */
+	friend class Builder;
+	friend class BinaryEncoder;
+	friend class Query;
+	friend class NameIndex;
+
+	struct ChildIndex;
+
+	/**
+	 * @brief Gets the index of the children by name, building it for wide nodes.
+	 * 
+	 * @return const ChildIndex* The index, or nullptr if the node is scanned.
+	 */
+	const ChildIndex *get_child_index() const;
+
+	/**
+	 * @brief Discards the index of the children by name, once they change.
+	 */
+	void drop_child_index();
+
+	std::pmr::string name{}; /**< Name of the node. */
+	AttributeMap attrs; /**< Attributes in added order. */
+	std::pmr::vector<std::shared_ptr<Element>> children; /**< Child elements of the node. */
+	NameIndex *index{}; /**< Index of the node, not owned. */
+	mutable std::atomic<ChildIndex *> child_index{}; /**< Children by name, built on lookup. */
 };
 
 } // namespace dfml
@@ -11,18 +11,73 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <list>
 #include <cctype>
 #include <stdexcept>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include <dfml/structural_index.h>
 
 namespace dfml {
 
 class Element;
-class Data;
-class Node;
+class Document;
+class Tape;
+class MappedFile;
+class Handler;
+class ThreadPool;
 class Value;
 
+/**
+ * @brief Error found while parsing DFML data.
+ * Plain data, so reporting it allocates nothing; the message is built on
+ * demand by get_message().
+ */
+struct ParseError {
+	/**
+	 * @brief Kind of the error.
+	 */
+	enum Code {
+		NONE,                  /**< No error. */
+		INVALID_CHILD,         /**< Invalid character for a node child. */
+		EMPTY_NODE_NAME,       /**< Node without name. */
+		DOUBLE_ATTRIBUTE_LIST, /**< Second attribute list in a node. */
+		UNEXPECTED_SEPARATOR,  /**< ',' without an attribute before it. */
+		INVALID_DOUBLE,        /**< Malformed double. */
+		INVALID_INTEGER,       /**< Malformed or out of range integer. */
+		INVALID_BOOLEAN,       /**< Attribute value other than true or false. */
+		INVALID_COMMENT,       /**< '/' not starting a comment. */
+		MAX_DEPTH,             /**< ParseOptions::max_depth exceeded. */
+		MAX_ELEMENTS,          /**< ParseOptions::max_elements exceeded. */
+		MAX_STRING_LENGTH,     /**< ParseOptions::max_string_length exceeded. */
+		MAX_BYTES              /**< ParseOptions::max_bytes exceeded. */
+	};
+
+	Code code = NONE;      /**< Kind of the error. */
+	size_t offset = 0;     /**< Byte offset in the data where it was found. */
+	unsigned line = 0;     /**< Line of the offset, from 1. */
+	unsigned column = 0;   /**< Column of the offset in bytes, from 1. */
+	size_t limit = 0;      /**< The exceeded limit, for the MAX_ codes. */
+
+	/**
+	 * @brief Checks if there is an error.
+	 * 
+	 * @return true If code is not NONE.
+	 */
+	explicit operator bool() const { return code != NONE; }
+
+	/**
+	 * @brief Builds the message of the error, as thrown by ParserException.
+	 * 
+	 * @return std::string The message.
+	 */
+	std::string get_message() const;
+};
+
 /**
  * @class ParserException
  * @brief Exception class for parser-related errors.
@@ -37,6 +92,12 @@ public:
      */
     explicit ParserException(const std::string& message) : message(message) {}
 
+    /**
+     * @brief Constructor for the ParserException class.
+     * @param error The parse error, which gives the message.
+     */
+    explicit ParserException(const ParseError& error) : message(error.get_message()), error(error) {}
+
     /**
      * @brief Returns the error message associated with the exception.
      * @return A pointer to the C-style string representing the error message.
@@ -45,13 +106,99 @@ public:
         return message.c_str();
     }
 
+    /**
+     * @brief Returns the parse error, with a NONE code for the other errors.
+     * @return The parse error.
+     */
+    const ParseError& get_error() const noexcept {
+        return error;
+    }
+
 private:
     /// The custom error message associated with the exception.
     std::string message;
+
+    /// The parse error, if the exception reports one.
+    ParseError error;
+};
+
+/**
+ * @brief Result of a non-throwing parse: a value or a ParseError.
+ * Similar to std::expected, which is not available in C++17.
+ * 
+ * @tparam T Type of the value.
+ */
+template <typename T>
+class ParseResult {
+public:
+	ParseResult(T value) : value(std::move(value)) {}
+	ParseResult(const ParseError &error) : error(error) {}
+
+	/**
+	 * @brief Checks if the parse succeeded.
+	 * 
+	 * @return true If there is a value.
+	 */
+	bool has_value() const { return !error; }
+	explicit operator bool() const { return has_value(); }
+
+	/**
+	 * @brief Gets the value.
+	 * 
+	 * @return T& The value.
+	 * @throws ParserException If the parse failed.
+	 */
+	T &get_value() {
+		if (error) throw ParserException(error);
+		return value;
+	}
+
+	/**
+	 * @brief Gets the error.
+	 * 
+	 * @return const ParseError& The error, with a NONE code on success.
+	 */
+	const ParseError &get_error() const { return error; }
+
+	T &operator*() { return value; }
+	T *operator->() { return &value; }
+
+private:
+	T value{};         /**< The value, on success. */
+	ParseError error{}; /**< The error, on failure. */
+};
+
+/**
+ * @brief Result of a non-throwing parse without value: only a ParseError.
+ */
+template <>
+class ParseResult<void> {
+public:
+	ParseResult(const ParseError &error) : error(error) {}
+
+	bool has_value() const { return !error; }
+	explicit operator bool() const { return has_value(); }
+
+	/**
+	 * @brief Checks the parse succeeded.
+	 * 
+	 * @throws ParserException If the parse failed.
+	 */
+	void get_value() const {
+		if (error) throw ParserException(error);
+	}
+
+	const ParseError &get_error() const { return error; }
+
+private:
+	ParseError error{}; /**< The error, on failure. */
 };
 
 /**
  * @brief Iterator for characters used by the Parser to iterate over a string.
+ * 
+ * Besides the character by character iteration, it can jump over runs of
+ * spaces and string contents using a StructuralIndex of the data.
  */
 class CharIterator {
 public:
@@ -59,20 +206,49 @@ public:
 
 	/**
 	 * @brief Sets the data for iteration.
+	 * The data is not copied: it must outlive the iteration.
 	 * 
 	 * @param data The string data to iterate over.
 	 */
-	void set_data(const std::string data) {
+	void set_data(std::string_view data) {
+		i = 0;
 		line = 1;
+		line_pos = 0;
 		this->data = data;
+		index.set_data(data);
+	}
+
+	/**
+	 * @brief Marks the data as the beginning of a longer input.
+	 * Reaching the end of partial data flags the iterator as starved
+	 * instead of meaning the end of the input.
+	 * 
+	 * @param partial true if more data may follow.
+	 */
+	void set_partial(const bool partial) {
+		this->partial = partial;
+		starved = false;
 	}
 
+	/**
+	 * @brief Checks if the end of partial data was reached.
+	 * 
+	 * @return bool True if more data is needed to continue.
+	 */
+	bool is_starved() const { return starved; }
+
 	/**
 	 * @brief Retrieves the next character in the iteration.
 	 * 
-	 * @return int The ASCII value of the next character.
+	 * @return int The ASCII value of the next character, or -1 at the end.
 	 */
-	int next();
+	int next() {
+		if (i >= data.size()) {
+			if (partial) starved = true;
+			return -1;
+		}
+		return data[i++];
+	}
 
 	/**
 	 * @brief Retrieves the current character in the iteration.
@@ -81,49 +257,215 @@ public:
 	 */
 	int current() { return data[i - 1]; }
 
+	/**
+	 * @brief Retrieves the next character without moving the iterator.
+	 * 
+	 * @return int The ASCII value of the next character, or -1 at the end.
+	 */
+	int peek() const { return i < data.size() ? data[i] : -1; }
+
 	/**
 	 * @brief Moves the iterator back to the previous character.
 	 */
-	void back();
+	void back() { i--; }
 
 	/**
 	 * @brief Checks if the end of the iteration is reached.
 	 * 
 	 * @return bool True if the end is reached, false otherwise.
 	 */
-	bool end() { return i >= data.size(); }
+	bool end() {
+		if (i < data.size()) return false;
+		if (partial) starved = true;
+		return true;
+	}
+
+	/**
+	 * @brief Moves the iterator over the following spaces.
+	 */
+	void skip_space() { i = index.next_non_space(i); }
+
+	/**
+	 * @brief Moves the iterator after the next occurrence of a quote.
+	 * 
+	 * @param quote The quote character to look for.
+	 * @return std::string_view The data skipped, without the quote.
+	 */
+	std::string_view skip_to(int quote);
+
+	/**
+	 * @brief Moves the iterator over the following characters matching a predicate.
+	 * 
+	 * @param match Predicate called with each character.
+	 * @return std::string_view The data skipped.
+	 */
+	template <typename Predicate>
+	std::string_view skip_while(Predicate match) {
+		unsigned long start = i;
+		while (i < data.size() && match(data[i])) i++;
+		return data.substr(start, i - start);
+	}
 
 	/**
 	 * @brief Returns current data line.
 	 * 
 	 */
-	const std::string get_line() { return std::to_string(line); };
+	const std::string get_line() const { return std::to_string(get_line_number()); };
+
+	/**
+	 * @brief Returns current data line as a number.
+	 * Lines are counted on demand, from the last position asked.
+	 * 
+	 * @return unsigned The current line.
+	 */
+	unsigned get_line_number() const;
+
+	/**
+	 * @brief Sets the line number of the current position.
+	 * 
+	 * @param line The line number.
+	 */
+	void set_line_number(const unsigned line) {
+		this->line = line;
+		line_pos = i;
+	}
+
+	/**
+	 * @brief Returns the index of the next character.
+	 * 
+	 * @return unsigned long The current index in the data.
+	 */
+	unsigned long position() const { return i; }
+
+	/**
+	 * @brief Returns the size of the data.
+	 * 
+	 * @return unsigned long The data size.
+	 */
+	unsigned long size() const { return data.size(); }
+
+	/**
+	 * @brief Gets the whole data.
+	 *
+	 * @return std::string_view The data.
+	 */
+	std::string_view get_data() const { return data; }
 
 private:
-	std::string data;         /**< The string data to iterate over. */
+	std::string_view data;    /**< The string data to iterate over. */
 	unsigned long i{};        /**< Current index in the iteration. */
-	unsigned line{};		  /**< Current data line. */
+	mutable unsigned line{};  /**< Data line at line_pos. */
+	mutable unsigned long line_pos{}; /**< Position where line was counted. */
+	bool partial{};           /**< More data may follow the current one. */
+	bool starved{};           /**< The end of partial data was reached. */
+	StructuralIndex index;    /**< Index of spaces and structural characters. */
+};
+
+/**
+ * @brief Options of the parser, mostly limits of the parsed data.
+ * Data exceeding a limit is rejected with a ParserException. The defaults
+ * set no limit.
+ */
+struct ParseOptions {
+	size_t max_depth = SIZE_MAX;         /**< Maximum nesting of nodes. */
+	size_t max_elements = SIZE_MAX;      /**< Maximum count of nodes, data and comments. */
+	size_t max_string_length = SIZE_MAX; /**< Maximum length of strings, names, keys and comments. */
+	size_t max_bytes = SIZE_MAX;         /**< Maximum size of the data. */
+	bool name_index = false;             /**< parse_document() builds the NameIndex of the document. */
 };
 
 /**
  * @brief Class responsible for parsing DFML data and creating Element objects.
+ * Nested nodes are parsed without recursion, so any depth is accepted
+ * unless limited with set_options().
  */
 class Parser {
 public:
 	/**
 	 * @brief Constructor for the Parser class.
+	 * The data is scanned in place: it must outlive the parser.
 	 * 
 	 * @param data The DFML data to parse.
 	 */
-	Parser(const std::string data);
+	Parser(std::string_view data);
+
+	/**
+	 * @brief Constructor for the Parser class.
+	 * The data is scanned in place: it must outlive the parser.
+	 * 
+	 * @param data The DFML data to parse (null terminated).
+	 */
+	Parser(const char *data) : Parser(std::string_view(data)) {}
+
+	/**
+	 * @brief Constructor for the Parser class.
+	 * The parser takes ownership of the data.
+	 * 
+	 * @param data The DFML data to parse.
+	 */
+	Parser(std::string data);
+
+	/**
+	 * @brief Constructor for the Parser class.
+	 * The parser scans the mapped file and keeps it mapped while alive.
+	 * 
+	 * @param file The mapped DFML file to parse.
+	 */
+	Parser(std::shared_ptr<MappedFile> file);
+
+	Parser(const Parser &) = delete;
+	Parser &operator=(const Parser &) = delete;
+
+	/**
+	 * @brief Creates and returns a shared pointer to a Parser instance.
+	 * The data is scanned in place: it must outlive the parser.
+	 * 
+	 * @param data The DFML data to parse.
+	 * @return std::shared_ptr<Parser> Shared pointer to the new Parser instance.
+	 */
+	static std::shared_ptr<Parser> create(std::string_view data);
+
+	/**
+	 * @brief Creates and returns a shared pointer to a Parser instance.
+	 * The data is scanned in place: it must outlive the parser.
+	 * 
+	 * @param data The DFML data to parse (null terminated).
+	 * @return std::shared_ptr<Parser> Shared pointer to the new Parser instance.
+	 */
+	static std::shared_ptr<Parser> create(const char *data);
 
 	/**
 	 * @brief Creates and returns a shared pointer to a Parser instance.
+	 * The parser takes ownership of the data.
 	 * 
 	 * @param data The DFML data to parse.
 	 * @return std::shared_ptr<Parser> Shared pointer to the new Parser instance.
 	 */
-	static std::shared_ptr<Parser> create(const std::string data);
+	static std::shared_ptr<Parser> create(std::string data);
+
+	/**
+	 * @brief Creates a Parser over a read-only memory mapping of a file.
+	 * Nothing is read up front: the parser scans the mapped pages in place.
+	 * 
+	 * @param path Path of the DFML file.
+	 * @return std::shared_ptr<Parser> Shared pointer to the new Parser instance.
+	 * @throws std::runtime_error If the file cannot be mapped.
+	 */
+	static std::shared_ptr<Parser> open(const std::string path);
+
+	/**
+	 * @brief Sets the limits of the parser, for untrusted data.
+	 * 
+	 * @param options The limits.
+	 */
+	void set_options(const ParseOptions &options);
+
+	/**
+	 * @brief Gets the limits of the parser.
+	 * 
+	 * @return const ParseOptions& The limits.
+	 */
+	const ParseOptions &get_options() const { return options; }
 
 	/**
 	 * @brief Parses the DFML data and returns a list of parsed Element objects.
@@ -132,59 +474,204 @@ public:
 	 */
 	std::list<std::shared_ptr<Element>> parse();
 
+	/**
+	 * @brief Parses the DFML data without throwing on invalid data.
+	 * 
+	 * @return ParseResult<std::list<std::shared_ptr<Element>>> The parsed elements, or the error.
+	 */
+	ParseResult<std::list<std::shared_ptr<Element>>> parse(std::nothrow_t);
+
+	/**
+	 * @brief Parses the DFML data into a Document.
+	 * The elements are allocated from the arena of the document.
+	 * 
+	 * @return std::shared_ptr<Document> The parsed document.
+	 */
+	std::shared_ptr<Document> parse_document();
+
+	/**
+	 * @brief Parses the DFML data into a Document without throwing on invalid data.
+	 * 
+	 * @return ParseResult<std::shared_ptr<Document>> The parsed document, or the error.
+	 */
+	ParseResult<std::shared_ptr<Document>> parse_document(std::nothrow_t);
+
+	/**
+	 * @brief Parses the DFML data into an immutable Tape.
+	 * 
+	 * @return std::shared_ptr<Tape> The parsed tape.
+	 */
+	std::shared_ptr<Tape> parse_tape();
+
+	/**
+	 * @brief Parses the DFML data into a Tape without throwing on invalid data.
+	 * Strings longer than Tape::MAX_STRING_LENGTH fail with
+	 * ParseError::MAX_STRING_LENGTH, whatever the options allow.
+	 * 
+	 * @return ParseResult<std::shared_ptr<Tape>> The parsed tape, or the error.
+	 */
+	ParseResult<std::shared_ptr<Tape>> parse_tape(std::nothrow_t);
+
+	/**
+	 * @brief Parses the DFML data reporting each element to the handler.
+	 * No Element object is created.
+	 * 
+	 * @param handler The handler that receives the parsing events.
+	 * @throws ParserException If the data is not valid or exceeds a limit.
+	 */
+	void parse(Handler &handler);
+
+	/**
+	 * @brief Parses the DFML data reporting each element to the handler,
+	 * without throwing on invalid data.
+	 * The events reported before an error are not undone. Exceptions thrown
+	 * by the handler are not caught.
+	 * 
+	 * @param handler The handler that receives the parsing events.
+	 * @return ParseResult<void> The error, if any.
+	 */
+	ParseResult<void> parse(Handler &handler, std::nothrow_t);
+
+	/**
+	 * @brief Parses the DFML data on a pool of threads.
+	 * The data is split in chunks of top level elements, which are parsed in
+	 * parallel and spliced in document order. Small documents are parsed in
+	 * the calling thread. The result, and the error thrown for invalid data,
+	 * are the same as those of parse().
+	 *
+	 * @param pool The pool of the workers. Must not be called from one of them.
+	 * @return std::list<std::shared_ptr<Element>> The parsed elements.
+	 */
+	std::list<std::shared_ptr<Element>> parse_parallel(ThreadPool &pool);
+
+	/**
+	 * @brief Parses the DFML data on a temporary pool of threads.
+	 *
+	 * @param threads Count of threads, 0 for one per hardware thread.
+	 * @return std::list<std::shared_ptr<Element>> The parsed elements.
+	 */
+	std::list<std::shared_ptr<Element>> parse_parallel(unsigned threads = 0);
+
+	/**
+	 * @brief Minimum size of the chunks parsed by parse_parallel().
+	 */
+	static constexpr size_t PARALLEL_CHUNK_SIZE = 256 << 10;
+
 private:
+	friend class PushParser;
+	friend class Reader;
+
+	/**
+	 * @brief Parses the top level elements of the data.
+	 *
+	 * @param handler The handler that receives the parsing events.
+	 * @return false If the elements end with a '}', which ends the document, or on error.
+	 */
+	bool parse_elements(Handler &handler);
+
+	/**
+	 * @brief Parses a single child element.
+	 * 
+	 * @param ch The first character of the child.
+	 * @return false If ch closes the children list, or on error.
+	 */
+	bool parse_child(int ch);
+
+	/**
+	 * @brief Parses a Node element and all its descendants.
+	 * @return false On error.
+	 */
+	bool parse_node();
+
+	/**
+	 * @brief Parses a Node element up to its children.
+	 * A node with children is left open and counted in the depth.
+	 * @return false On error.
+	 */
+	bool parse_node_head();
+
+	/**
+	 * @brief Checks the limits and reports the beginning of a Node.
+	 * 
+	 * @param name The name of the node.
+	 * @return false If a limit is exceeded.
+	 */
+	bool open_node(std::string_view name);
+
+	/**
+	 * @brief Ends the innermost open Node.
+	 */
+	void close_node();
+
 	/**
-	 * @brief Parses the children of a Node.
+	 * @brief Counts an element, checking the element limit.
+	 * @return false If the limit is exceeded.
+	 */
+	bool count_element();
+
+	/**
+	 * @brief Checks the length of a name, key, string or comment.
 	 * 
-	 * @param childs The list to store the parsed child elements.
+	 * @param length The length.
+	 * @return false If the limit is exceeded.
+	 */
+	bool check_length(size_t length);
+
+	/**
+	 * @brief Checks the size of the data.
+	 * @return false If the limit is exceeded.
 	 */
-	void parse_children(std::list<std::shared_ptr<Element>> &childs);
+	bool check_size();
 
 	/**
-	 * @brief Parses a Node element.
+	 * @brief Records an error at the current position.
 	 * 
-	 * @return std::shared_ptr<Element> The parsed Node element.
+	 * @param code The error code.
+	 * @param limit The exceeded limit, for the limit errors.
+	 * @return false Always.
 	 */
-	std::shared_ptr<Element> parse_node();
+	bool fail(ParseError::Code code, size_t limit = 0);
 
 	/**
 	 * @brief Parses the name of a Node element.
 	 * 
-	 * @return const std::string The parsed name of the Node element.
+	 * @return std::string_view The parsed name, a view of the data.
 	 */
-	const std::string parse_node_name();
+	std::string_view parse_node_name();
 
 	/**
-	 * @brief Parse attibutes for the given node.
-	 * @param node The node reference.
-	 * 
+	 * @brief Parse attibutes for the current node.
+	 * @return false On error.
 	 */
-	void parse_node_attributes(std::shared_ptr<Node> node);
+	bool parse_node_attributes();
 
 	/**
-	 * @brief Parse a attribute pair (Key/Value) for the given node.
-	 * @param node The node reference
+	 * @brief Parse a attribute pair (Key/Value) for the current node.
+	 * @return false On error.
 	 */
-	void parse_node_attribute(std::shared_ptr<Node> node);
+	bool parse_node_attribute();
 
 	/**
 	 * @brief Parses a string Data element.
 	 * @param value Value reference to set string data.
+	 * @return false On error.
 	 */
-	void parse_string(dfml::Value &value);
+	bool parse_string(dfml::Value &value);
 
 	/**
 	 * @brief Parses a number Data element.
 	 * Autodetect float point to se double data or se fixed to integer.
 	 * @param value Value reference to set number data.
+	 * @return false On error.
 	 */
-	void parse_number(dfml::Value &value);
+	bool parse_number(dfml::Value &value);
 
 	/**
 	 * @brief Parses a boolean Data element.
 	 * @param value Value reference to set boolean data.
+	 * @return false On error.
 	 */
-	void parse_boolean(Value &value);
+	bool parse_boolean(Value &value);
 
 	/**
 	 * @brief Checks if the provided character represents a number.
@@ -194,13 +681,20 @@ private:
 	 */
 	const bool is_number(int ch) const;
 
+	/**
+	 * @brief Checks if the character starts a number in a children list.
+	 * 
+	 * @param ch The ASCII value of the character already read.
+	 * @return const bool True if ch is a digit, or a '-' followed by a digit.
+	 */
+	const bool is_number_start(int ch);
+
 	/**
 	 * @brief Parses a Comment element.
 	 * Parses //, /* and # comment type.
-	 * 
-	 * @return std::shared_ptr<Element> The parsed Comment element.
+	 * @return false On error.
 	 */
-	std::shared_ptr<Element> parse_comment();
+	bool parse_comment();
 
 	/**
 	 * @brief Checks the character ch if alphabetic, '-', or '_'.
@@ -219,6 +713,15 @@ private:
 	const bool is_alphanumeric(const char ch);
 
 	CharIterator i; /**< Iterator for characters used during parsing. */
+	Handler *handler{}; /**< Receiver of the parsing events. */
+	ParseOptions options{}; /**< Limits of the parsed data. */
+	size_t depth{}; /**< Count of open nodes. */
+	size_t elements{}; /**< Count of parsed elements. */
+	ParseError error{}; /**< Error of the last parse. */
+	std::string name{}; /**< Scratch buffer for attribute keys. */
+	std::string text{}; /**< Scratch buffer for comments. */
+	std::string source{}; /**< Owned data, when constructed from a string. */
+	std::shared_ptr<MappedFile> file{}; /**< Mapped file, when opened from a path. */
 };
 
 } // namespace dfml
@@ -0,0 +1,90 @@
+/**
+ * @file push_parser.h
+ * @brief Declaration of the PushParser class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace dfml {
+
+class Element;
+class Scanner;
+
+/**
+ * @brief Incremental parser fed with chunks of a DFML document.
+ *
+ * The data can be split anywhere: inside a string, a number, a comment or an
+ * attribute list. Each top level element is passed to the callback as soon as
+ * it is complete, and its data is released.
+ * Syntax errors are thrown as ParserException by feed() or finish().
+ */
+class PushParser {
+public:
+	/**
+	 * @brief Callback receiving each complete top level element.
+	 */
+	using Callback = std::function<void(std::shared_ptr<Element>)>;
+
+	/**
+	 * @brief Constructor for the PushParser class.
+	 *
+	 * @param callback Receiver of the top level elements.
+	 */
+	PushParser(Callback callback);
+
+	/**
+	 * @brief Destructor for the PushParser class.
+	 */
+	~PushParser();
+
+	PushParser(const PushParser &) = delete;
+	PushParser &operator=(const PushParser &) = delete;
+
+	/**
+	 * @brief Creates and returns a shared pointer to a PushParser instance.
+	 *
+	 * @param callback Receiver of the top level elements.
+	 * @return std::shared_ptr<PushParser> Shared pointer to the new PushParser instance.
+	 */
+	static std::shared_ptr<PushParser> create(Callback callback);
+
+	/**
+	 * @brief Feeds the next chunk of the document.
+	 *
+	 * @param data The chunk data.
+	 * @param size The chunk size.
+	 */
+	void feed(const char *data, size_t size);
+
+	/**
+	 * @brief Signals the end of the document, parsing the remaining data.
+	 */
+	void finish();
+
+private:
+	/**
+	 * @brief Parses the buffered top level elements.
+	 *
+	 * @param final true if no more data will follow.
+	 */
+	void flush(const bool final);
+
+	Callback callback;                /**< Receiver of the top level elements. */
+	std::unique_ptr<Scanner> scanner; /**< Structural scanner of the fed data. */
+	std::string buffer{};             /**< Data of the pending elements. */
+	size_t attempted{};               /**< Top level mark of the last parse attempt. */
+	unsigned line{1};                 /**< Line at the buffer start. */
+	bool closed{};                    /**< Top level '}' or finish() reached. */
+};
+
+} // namespace dfml
@@ -0,0 +1,289 @@
+/**
+ * @file query.h
+ * @brief Declaration of the Query class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-06
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <dfml/node.h>
+#include <dfml/value.h>
+
+namespace dfml {
+
+class Document;
+
+/**
+ * @class QueryException
+ * @brief Exception class for invalid DFPath expressions.
+ */
+class QueryException : public std::exception {
+public:
+	/**
+	 * @brief Constructor for the QueryException class.
+	 * @param message The custom error message associated with the exception.
+	 */
+	explicit QueryException(const std::string &message) : message(message) {}
+
+	/**
+	 * @brief Returns the error message associated with the exception.
+	 * @return A pointer to the C-style string representing the error message.
+	 */
+	const char *what() const noexcept override {
+		return message.c_str();
+	}
+
+private:
+	/// The custom error message associated with the exception.
+	std::string message;
+};
+
+/**
+ * @brief Compiled DFPath expression selecting nodes of an element tree.
+ *
+ * A DFPath is a list of steps separated by '/', each one matching nodes by
+ * name among the children of the nodes matched by the previous step. The
+ * first step matches the given elements:
+ *
+ * @code
+ * server/listener[port=8080]/tls     tls of the listeners on port 8080
+ * //route[method='GET']              routes at any depth
+ * *[enabled=true]                    any node with enabled: true
+ * servers/server[2]                  second server
+ * @endcode
+ *
+ * - '*' matches any name.
+ * - '//' matches the nodes at any depth below the previous step.
+ * - [key] keeps the nodes with the attribute, [key=value] and [key!=value]
+ *   compare it with an integer, double, boolean or quoted string. Numbers
+ *   compare by value, whatever their type.
+ * - [n] keeps the n-th node, from 1, among the siblings that passed the
+ *   previous parts of the step.
+ * - A leading '/' is allowed and ignored.
+ *
+ * The expression is parsed once; running the query walks the tree and
+ * reports each match to a visitor, without intermediate lists. Matches are
+ * in document order, except that below a '//' step the matches under a
+ * node come before those under its descendants matching the same step.
+ * A node reached through several paths is reported once: a '//' step after
+ * another one doesn't search again below a node it already searched.
+ * A query can be shared by many threads.
+ */
+class Query {
+public:
+	/**
+	 * @brief Receiver of the matched nodes. Returns false to stop the query.
+	 */
+	using Visitor = std::function<bool(Node &)>;
+
+	/**
+	 * @brief Maximum count of predicates in a step.
+	 */
+	static constexpr size_t MAX_PREDICATES = 8;
+
+	/**
+	 * @brief Constructor for the Query class.
+	 *
+	 * @param expression The DFPath expression.
+	 * @throws QueryException If the expression is not valid.
+	 */
+	Query(std::string_view expression);
+
+	/**
+	 * @brief Creates a compiled query.
+	 *
+	 * @param expression The DFPath expression.
+	 * @return std::shared_ptr<Query> Shared pointer to the new Query instance.
+	 * @throws QueryException If the expression is not valid.
+	 */
+	static std::shared_ptr<Query> create(std::string_view expression);
+
+	/**
+	 * @brief Reports the matches among some elements and their descendants.
+	 *
+	 * @param elements The elements matched by the first step.
+	 * @param visitor The receiver of the matches.
+	 * @return false If the visitor stopped the query.
+	 */
+	bool each(ChildRange elements, const Visitor &visitor) const;
+
+	/**
+	 * @brief Reports the matches among top level elements.
+	 *
+	 * @param elements The elements matched by the first step, as returned by Parser::parse().
+	 * @param visitor The receiver of the matches.
+	 * @return false If the visitor stopped the query.
+	 */
+	bool each(const std::list<std::shared_ptr<Element>> &elements, const Visitor &visitor) const;
+
+	/**
+	 * @brief Reports the matches among the children of a node.
+	 *
+	 * @param node The node whose children are matched by the first step.
+	 * @param visitor The receiver of the matches.
+	 * @return false If the visitor stopped the query.
+	 */
+	bool each(const Node &node, const Visitor &visitor) const { return each(node.get_children(), visitor); }
+
+	/**
+	 * @brief Reports the matches among the elements of a document.
+	 *
+	 * @param document The document whose elements are matched by the first step.
+	 * @param visitor The receiver of the matches.
+	 * @return false If the visitor stopped the query.
+	 */
+	bool each(const Document &document, const Visitor &visitor) const;
+
+	/**
+	 * @brief Gets the first match.
+	 *
+	 * @param scope A node, a document, or a list or range of elements, as in each().
+	 * @return Node* The first match, or nullptr.
+	 */
+	template <typename Scope>
+	Node *first(const Scope &scope) const {
+		Node *found = nullptr;
+		each(scope, [&found](Node &node) { found = &node; return false; });
+		return found;
+	}
+
+	/**
+	 * @brief Gets all the matches, in the order of each().
+	 *
+	 * @param scope A node, a document, or a list or range of elements, as in each().
+	 * @return std::vector<Node *> The matches.
+	 */
+	template <typename Scope>
+	std::vector<Node *> select(const Scope &scope) const {
+		std::vector<Node *> found;
+		each(scope, [&found](Node &node) { found.push_back(&node); return true; });
+		return found;
+	}
+
+	/**
+	 * @brief Counts the matches.
+	 *
+	 * @param scope A node, a document, or a list or range of elements, as in each().
+	 * @return size_t The count of matches.
+	 */
+	template <typename Scope>
+	size_t count(const Scope &scope) const {
+		size_t found = 0;
+		each(scope, [&found](Node &) { found++; return true; });
+		return found;
+	}
+
+	/**
+	 * @brief Gets the expression of the query.
+	 *
+	 * @return const std::string& The expression.
+	 */
+	const std::string &get_expression() const { return expression; }
+
+private:
+	/**
+	 * @brief Condition on the nodes of a step.
+	 */
+	struct Predicate {
+		enum Type { EXISTS, EQUAL, NOT_EQUAL, POSITION } type; /**< Kind of condition. */
+		std::string key;  /**< Attribute key. */
+		Value value;      /**< Compared value. */
+		size_t position;  /**< Position, from 1. */
+	};
+
+	/**
+	 * @brief Step of the path.
+	 */
+	struct Step {
+		std::string name;                  /**< Node name, empty for any. */
+		bool descendant;                   /**< Matches at any depth. */
+		std::vector<Predicate> predicates; /**< Conditions, in order. */
+		bool nested{};                     /**< Matches at any depth after another such step. */
+	};
+
+	struct Run;
+
+	/**
+	 * @brief Parses a step of the expression.
+	 *
+	 * @param text The expression from the step on; consumed up to the step end.
+	 * @param descendant The step follows a '//'.
+	 */
+	void parse_step(std::string_view &text, bool descendant);
+
+	/**
+	 * @brief Parses a predicate of a step.
+	 *
+	 * @param text The predicate, without brackets.
+	 * @return Predicate The parsed predicate.
+	 */
+	Predicate parse_predicate(std::string_view text);
+
+	/**
+	 * @brief Matches a step against a list of siblings and their descendants.
+	 *
+	 * @tparam Range Range of shared pointers to elements.
+	 * @param siblings The siblings.
+	 * @param step Index of the step.
+	 * @param run State of the running query.
+	 * @return false If the visitor stopped the query.
+	 */
+	template <typename Range>
+	bool match(const Range &siblings, size_t step, Run &run) const;
+
+	/**
+	 * @brief Matches a node against a step, queueing the matches it leads to.
+	 *
+	 * @param element The element, skipped if it is not a node.
+	 * @param step Index of the step.
+	 * @param positions Position counters of the step among the siblings.
+	 * @param run State of the running query.
+	 * @return false If the visitor stopped the query.
+	 */
+	bool visit(Element &element, size_t step, size_t *positions, Run &run) const;
+
+	/**
+	 * @brief Runs the queued matches, from the last one.
+	 *
+	 * @param run State of the running query.
+	 * @return false If the visitor stopped the query.
+	 */
+	bool resume(Run &run) const;
+
+	/**
+	 * @brief Runs the query from the first step.
+	 *
+	 * @tparam Range Range of shared pointers to elements.
+	 * @param elements The elements matched by the first step.
+	 * @param visitor The receiver of the matches.
+	 * @return false If the visitor stopped the query.
+	 */
+	template <typename Range>
+	bool start(const Range &elements, const Visitor &visitor) const;
+
+	/**
+	 * @brief Checks the attribute predicates of a step on a node.
+	 *
+	 * @param node The node.
+	 * @param predicate The predicate.
+	 * @return true If the node passes it.
+	 */
+	static bool check(const Node &node, const Predicate &predicate);
+
+	std::string expression; /**< Source of the query. */
+	std::vector<Step> steps; /**< Compiled steps. */
+};
+
+} // namespace dfml
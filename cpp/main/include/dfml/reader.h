@@ -0,0 +1,249 @@
+/**
+ * @file reader.h
+ * @brief Declaration of the Reader class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <dfml/handler.h>
+#include <dfml/parser.h>
+#include <dfml/value.h>
+
+namespace dfml {
+
+/**
+ * @brief Forward only reader of DFML data.
+ *
+ * Each call to read() moves to the next token of the document. The names and
+ * values are only valid until the next call to read(). No Element is created.
+ *
+ * Example:
+ * @code
+ * auto reader = dfml::Reader::create(data);
+ * while (reader->read()) {
+ *     if (reader->token_type() == dfml::Reader::NODE_BEGIN && reader->name() == "ignored")
+ *         reader->skip_subtree();
+ * }
+ * @endcode
+ */
+class Reader : private Handler {
+public:
+	/**
+	 * @brief Constant representing no token: read() was not called yet.
+	 */
+	static constexpr int NONE = 0;
+
+	/**
+	 * @brief Constant representing the start of a node. name() is the node name.
+	 */
+	static constexpr int NODE_BEGIN = 1;
+
+	/**
+	 * @brief Constant representing an attribute of the current node.
+	 * name() is the key and value() the value.
+	 */
+	static constexpr int ATTRIBUTE = 2;
+
+	/**
+	 * @brief Constant representing a data element. value() is the value.
+	 */
+	static constexpr int DATA = 3;
+
+	/**
+	 * @brief Constant representing a comment. value() is the text as a string.
+	 */
+	static constexpr int COMMENT = 4;
+
+	/**
+	 * @brief Constant representing the end of a node.
+	 */
+	static constexpr int NODE_END = 5;
+
+	/**
+	 * @brief Constant representing the end of the document.
+	 */
+	static constexpr int END = 6;
+
+	/**
+	 * @brief Constructor for the Reader class.
+	 * The data is scanned in place: it must outlive the reader.
+	 *
+	 * @param data The DFML data to read.
+	 */
+	Reader(std::string_view data) : parser(data) { parser.handler = this; }
+
+	/**
+	 * @brief Constructor for the Reader class.
+	 * The data is scanned in place: it must outlive the reader.
+	 *
+	 * @param data The DFML data to read (null terminated).
+	 */
+	Reader(const char *data) : parser(data) { parser.handler = this; }
+
+	/**
+	 * @brief Constructor for the Reader class.
+	 * The reader takes ownership of the data.
+	 *
+	 * @param data The DFML data to read.
+	 */
+	Reader(std::string data) : parser(std::move(data)) { parser.handler = this; }
+
+	/**
+	 * @brief Constructor for the Reader class.
+	 * The reader scans the mapped file and keeps it mapped while alive.
+	 *
+	 * @param file The mapped DFML file to read.
+	 */
+	Reader(std::shared_ptr<MappedFile> file) : parser(std::move(file)) { parser.handler = this; }
+
+	/**
+	 * @brief Creates and returns a shared pointer to a Reader instance.
+	 * The data is scanned in place: it must outlive the reader.
+	 *
+	 * @param data The DFML data to read.
+	 * @return std::shared_ptr<Reader> Shared pointer to the new Reader instance.
+	 */
+	static std::shared_ptr<Reader> create(std::string_view data);
+
+	/**
+	 * @brief Creates and returns a shared pointer to a Reader instance.
+	 * The data is scanned in place: it must outlive the reader.
+	 *
+	 * @param data The DFML data to read (null terminated).
+	 * @return std::shared_ptr<Reader> Shared pointer to the new Reader instance.
+	 */
+	static std::shared_ptr<Reader> create(const char *data);
+
+	/**
+	 * @brief Creates and returns a shared pointer to a Reader instance.
+	 * The reader takes ownership of the data.
+	 *
+	 * @param data The DFML data to read.
+	 * @return std::shared_ptr<Reader> Shared pointer to the new Reader instance.
+	 */
+	static std::shared_ptr<Reader> create(std::string data);
+
+	/**
+	 * @brief Creates a Reader over a read-only memory mapping of a file.
+	 *
+	 * @param path Path of the DFML file.
+	 * @return std::shared_ptr<Reader> Shared pointer to the new Reader instance.
+	 * @throws std::runtime_error If the file cannot be mapped.
+	 */
+	static std::shared_ptr<Reader> open(const std::string path);
+
+	/**
+	 * @brief Moves to the next token.
+	 *
+	 * @return true If a token was read, false at the end of the document.
+	 * @throws ParserException On syntax errors.
+	 */
+	bool read();
+
+	/**
+	 * @brief Gets the type of the current token.
+	 *
+	 * @return int The token type (NONE, NODE_BEGIN, ATTRIBUTE, DATA, COMMENT, NODE_END or END).
+	 */
+	int token_type() const { return token; }
+
+	/**
+	 * @brief Gets the name of the current node or attribute key.
+	 *
+	 * @return std::string_view The name, valid until the next read().
+	 */
+	std::string_view name() const;
+
+	/**
+	 * @brief Gets the value of the current attribute, data or comment.
+	 *
+	 * @return const Value& The value, valid until the next read().
+	 */
+	const Value &value() const;
+
+	/**
+	 * @brief Gets the nesting level of the current token.
+	 * Top level tokens have depth 0, including the begin and end of top level nodes.
+	 *
+	 * @return unsigned The depth of the current token.
+	 */
+	unsigned depth() const;
+
+	/**
+	 * @brief Skips the rest of the current node.
+	 * Valid on NODE_BEGIN and ATTRIBUTE tokens, it does nothing otherwise.
+	 * Only braces, parentheses, quotes and comments are matched: the skipped
+	 * content is not validated and nothing is allocated for it.
+	 * The current token becomes the NODE_END of the skipped node.
+	 */
+	void skip_subtree();
+
+private:
+	void on_attribute(std::string_view key, const Value &value) override;
+	void on_comment(std::string_view text) override;
+
+	/**
+	 * @brief Reads the next token after a node name.
+	 *
+	 * @return true If a token was read.
+	 */
+	bool read_tail();
+
+	/**
+	 * @brief Reads the next token in a children list.
+	 *
+	 * @return true If a token was read.
+	 */
+	bool read_child();
+
+	/**
+	 * @brief Ends the current node.
+	 *
+	 * @return true Always, the token is NODE_END.
+	 */
+	bool end_node();
+
+	/**
+	 * @brief Skips characters until the end of a string.
+	 *
+	 * @param quote The quote that closes the string.
+	 */
+	void skip_string(int quote);
+
+	/**
+	 * @brief Skips a comment once its first character was read.
+	 *
+	 * @param ch The first character of the comment.
+	 */
+	void skip_comment(int ch);
+
+	Parser parser; /**< Parser providing the scanning functions. */
+
+	enum mode_t {
+		CHILDREN, /**< Reading a children list (or the top level). */
+		TAIL,     /**< Reading the attributes or children of a new node. */
+		DONE      /**< End of the document reached. */
+	} mode = CHILDREN;
+
+	int token = NONE;      /**< Current token type. */
+	unsigned open_nodes{}; /**< Count of open nodes. */
+	bool attr_parsed{};    /**< The attribute list of the TAIL node was parsed. */
+	std::string_view current_name{}; /**< Name of the current node. */
+	Value current{};       /**< Value of the current data or comment. */
+	std::vector<std::pair<std::string, Value>> attrs; /**< Attributes of the TAIL node. */
+	size_t attr_count{};   /**< Count of valid entries in attrs. */
+	size_t attr_index{};   /**< Index of the current attribute. */
+};
+
+} // namespace dfml
@@ -0,0 +1,162 @@
+/**
+ * @file sink.h
+ * @brief Declaration of the Sink classes in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace dfml {
+
+/**
+ * @brief Output of the DFML text written by a Builder.
+ */
+class Sink {
+public:
+	virtual ~Sink() = default;
+
+	/**
+	 * @brief Writes bytes to the output.
+	 *
+	 * @param data The bytes to write.
+	 * @param size The count of bytes.
+	 */
+	virtual void write(const char *data, size_t size) = 0;
+
+	/**
+	 * @brief Writes a string to the output.
+	 *
+	 * @param string The string to write.
+	 */
+	void write(std::string_view string) { write(string.data(), string.size()); }
+
+	/**
+	 * @brief Writes the pending bytes, if the sink keeps any.
+	 */
+	virtual void flush() {}
+};
+
+/**
+ * @brief Sink writing to a growable memory buffer.
+ */
+class BufferSink : public Sink {
+public:
+	using Sink::write;
+
+	void write(const char *data, size_t size) override { buffer.append(data, size); }
+
+	/**
+	 * @brief Gets the written text.
+	 *
+	 * @return const std::string& The written text.
+	 */
+	const std::string &get_buffer() const { return buffer; }
+
+	/**
+	 * @brief Moves the written text out of the sink, leaving it empty.
+	 *
+	 * @return std::string The written text.
+	 */
+	std::string take() { return std::move(buffer); }
+
+	/**
+	 * @brief Reserves room in the buffer.
+	 *
+	 * @param size The expected size of the text.
+	 */
+	void reserve(size_t size) { buffer.reserve(size); }
+
+private:
+	std::string buffer; /**< Written text. */
+};
+
+/**
+ * @brief Sink writing to a std::ostream.
+ */
+class StreamSink : public Sink {
+public:
+	/**
+	 * @brief Constructor for the StreamSink class.
+	 *
+	 * @param stream The output stream, which must outlive the sink.
+	 */
+	StreamSink(std::ostream &stream) : stream(stream) {}
+
+	using Sink::write;
+
+	void write(const char *data, size_t size) override { stream.write(data, size); }
+	void flush() override { stream.flush(); }
+
+private:
+	std::ostream &stream; /**< Output stream. */
+};
+
+/**
+ * @brief Sink writing to a file descriptor, through a buffer.
+ * The descriptor is not closed by the sink.
+ */
+class FdSink : public Sink {
+public:
+	/**
+	 * @brief Size of the buffer.
+	 */
+	static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+	/**
+	 * @brief Constructor for the FdSink class.
+	 *
+	 * @param fd The file descriptor.
+	 */
+	FdSink(int fd) : fd(fd) {}
+
+	/**
+	 * @brief Destructor for the FdSink class. Writes the pending bytes, ignoring errors.
+	 */
+	~FdSink();
+
+	FdSink(const FdSink &) = delete;
+	FdSink &operator=(const FdSink &) = delete;
+
+	using Sink::write;
+
+	/**
+	 * @brief Writes bytes to the buffer, or directly when they don't fit.
+	 *
+	 * @param data The bytes to write.
+	 * @param size The count of bytes.
+	 * @throws std::runtime_error If the descriptor cannot be written.
+	 */
+	void write(const char *data, size_t size) override;
+
+	/**
+	 * @brief Writes the pending bytes.
+	 *
+	 * @throws std::runtime_error If the descriptor cannot be written.
+	 */
+	void flush() override;
+
+private:
+	/**
+	 * @brief Writes bytes to the descriptor, retrying partial writes.
+	 *
+	 * @param data The bytes to write.
+	 * @param size The count of bytes.
+	 */
+	void write_fd(const char *data, size_t size);
+
+	int fd;                    /**< File descriptor. */
+	size_t used{};             /**< Bytes pending in the buffer. */
+	char buffer[BUFFER_SIZE];  /**< Pending bytes. */
+};
+
+} // namespace dfml
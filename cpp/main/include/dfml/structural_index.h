@@ -0,0 +1,137 @@
+/**
+ * @file structural_index.h
+ * @brief Declaration of the StructuralIndex class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-24
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace dfml {
+
+/**
+ * @brief Bitmap index of the structural characters and spaces of DFML data.
+ *
+ * The data is classified in blocks of 64 bytes, one bit per byte, with
+ * SSE2 or AVX2 instructions when the processor supports them (chosen at
+ * runtime) and a portable fallback otherwise. Structural characters are
+ * { } ( ) , : " ' / and #, spaces are ' ', '\\t', '\\n' and '\\r'.
+ *
+ * Only a window of blocks is kept, so the memory used does not depend on the
+ * size of the data. The window moves forward as the positions are queried.
+ */
+class StructuralIndex {
+public:
+	/**
+	 * @brief Count of bytes classified by each bitmap word.
+	 */
+	static constexpr size_t BLOCK_SIZE = 64;
+
+	/**
+	 * @brief Count of blocks of the window.
+	 */
+	static constexpr size_t WINDOW_BLOCKS = 64;
+
+	/**
+	 * @brief Sets the data to index.
+	 * The data is not copied: it must outlive the index.
+	 *
+	 * @param data The data to index.
+	 */
+	void set_data(std::string_view data) {
+		this->data = data;
+		first_block = 0;
+		block_count = 0;
+	}
+
+	/**
+	 * @brief Finds the next structural character.
+	 *
+	 * @param pos Position to start from.
+	 * @return size_t Position of the first structural character at or after pos,
+	 * or the data size if there is none.
+	 */
+	size_t next_structural(size_t pos);
+
+	/**
+	 * @brief Finds the next character that isn't a space.
+	 *
+	 * @param pos Position to start from.
+	 * @return size_t Position of the first non space character at or after pos,
+	 * or the data size if there is none.
+	 */
+	size_t next_non_space(size_t pos);
+
+	/**
+	 * @brief Gets the name of the classification code used on this processor.
+	 *
+	 * @return const char* "avx2", "sse2" or "scalar".
+	 */
+	static const char *implementation();
+
+	/**
+	 * @brief Classifies blocks of data.
+	 * Bit n of each word is set when byte n of the block is in the class.
+	 *
+	 * @param data Data to classify, a multiple of BLOCK_SIZE bytes.
+	 * @param blocks Count of blocks.
+	 * @param structural Output bitmap of structural characters, a word per block.
+	 * @param space Output bitmap of spaces, a word per block.
+	 */
+	static void classify(const char *data, size_t blocks, uint64_t *structural, uint64_t *space);
+
+	/**
+	 * @brief Gets the index of the lowest set bit.
+	 *
+	 * @param word A non zero word.
+	 * @return unsigned The index of the lowest set bit.
+	 */
+	static unsigned lowest_bit(uint64_t word) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return index;
+#else
+		return __builtin_ctzll(word);
+#endif
+	}
+
+private:
+	/**
+	 * @brief Loads the window starting at the given block.
+	 *
+	 * @param block First block of the window.
+	 */
+	void load(size_t block);
+
+	/**
+	 * @brief Gets the bitmap word of a block, moving the window if needed.
+	 *
+	 * @param block The block.
+	 * @param space true for the spaces bitmap, false for the structural one.
+	 * @return uint64_t The bitmap word.
+	 */
+	uint64_t word(size_t block, bool space) {
+		if (block < first_block || block >= first_block + block_count) load(block);
+		return space ? spaces[block - first_block] : structurals[block - first_block];
+	}
+
+	std::string_view data{};   /**< Indexed data. */
+	size_t first_block{};      /**< First block of the window. */
+	size_t block_count{};      /**< Count of loaded blocks. */
+	uint64_t structurals[WINDOW_BLOCKS]; /**< Structural bitmap of the window. */
+	uint64_t spaces[WINDOW_BLOCKS];      /**< Spaces bitmap of the window. */
+};
+
+} // namespace dfml
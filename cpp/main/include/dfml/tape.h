@@ -0,0 +1,501 @@
+/**
+ * @file tape.h
+ * @brief Declaration of the Tape, NodeRef and ValueRef classes in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-09
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <dfml/handler.h>
+
+namespace dfml {
+
+class Tape;
+class Value;
+class Sink;
+class MappedFile;
+
+/**
+ * @brief Read-only view of a value stored in a Tape.
+ *
+ * A default constructed ValueRef (a missing attribute) reads as an empty string.
+ */
+class ValueRef {
+public:
+	ValueRef() = default;
+
+	/**
+	 * @brief Constructor for the ValueRef class.
+	 *
+	 * @param tape The tape of the value.
+	 * @param index Index of the value entry.
+	 */
+	ValueRef(const Tape *tape, size_t index) : tape(tape), index(index) {}
+
+	/**
+	 * @brief Checks if the view refers to a value.
+	 *
+	 * @return true If the value exists.
+	 */
+	explicit operator bool() const { return tape != nullptr; }
+
+	/**
+	 * @brief Gets the type of the value.
+	 *
+	 * @return int The type of the value (Value::STRING, INTEGER, DOUBLE or BOOLEAN).
+	 */
+	int get_type() const;
+
+	/**
+	 * @brief Gets the data of a string value.
+	 *
+	 * @return std::string_view The string data, valid while the tape lives.
+	 * @throws std::bad_variant_access If the value is not a string.
+	 */
+	std::string_view get_string() const;
+
+	/**
+	 * @brief Gets the data of an integer value.
+	 *
+	 * @return long The integer data.
+	 * @throws std::bad_variant_access If the value is not an integer.
+	 */
+	long get_integer() const;
+
+	/**
+	 * @brief Gets the data of a double value.
+	 *
+	 * @return double The double data.
+	 * @throws std::bad_variant_access If the value is not a double.
+	 */
+	double get_double() const;
+
+	/**
+	 * @brief Gets the data of a boolean value.
+	 *
+	 * @return bool The boolean data.
+	 * @throws std::bad_variant_access If the value is not a boolean.
+	 */
+	bool get_boolean() const;
+
+	/**
+	 * @brief Copies the value to a Value object.
+	 *
+	 * @return Value The copied value.
+	 */
+	Value to_value() const;
+
+private:
+	friend class NodeRef;
+
+	/**
+	 * @brief Gets the count of tape entries used by the value.
+	 *
+	 * @return size_t 1 or 2 entries.
+	 */
+	size_t entry_count() const;
+
+	const Tape *tape{}; /**< Tape of the value. */
+	size_t index{};     /**< Index of the value entry. */
+};
+
+/**
+ * @brief Read-only view of an element (node, data or comment) stored in a Tape.
+ */
+class NodeRef {
+public:
+	/**
+	 * @brief Forward iterator over sibling elements.
+	 */
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = NodeRef;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const NodeRef *;
+		using reference = NodeRef;
+
+		Iterator(const Tape *tape, size_t index) : tape(tape), index(index) {}
+
+		NodeRef operator*() const { return NodeRef(tape, index); }
+		Iterator &operator++() { index = NodeRef(tape, index).next_index(); return *this; }
+		Iterator operator++(int) { Iterator it = *this; ++*this; return it; }
+		bool operator==(const Iterator &other) const { return index == other.index; }
+		bool operator!=(const Iterator &other) const { return index != other.index; }
+
+	private:
+		const Tape *tape; /**< Tape of the elements. */
+		size_t index;     /**< Index of the current element. */
+	};
+
+	/**
+	 * @brief Range of sibling elements.
+	 */
+	class Range {
+	public:
+		Range(const Tape *tape, size_t first, size_t last) : tape(tape), first(first), last(last) {}
+
+		Iterator begin() const { return Iterator(tape, first); }
+		Iterator end() const { return Iterator(tape, last); }
+		bool empty() const { return first == last; }
+
+		/**
+		 * @brief Counts the elements of the range, walking the siblings.
+		 *
+		 * @return size_t The count of elements.
+		 */
+		size_t size() const { return std::distance(begin(), end()); }
+
+	private:
+		const Tape *tape; /**< Tape of the elements. */
+		size_t first;     /**< Index of the first element. */
+		size_t last;      /**< Index after the last element. */
+	};
+
+	/**
+	 * @brief Forward iterator over the attributes of a node, as key/value pairs.
+	 */
+	class AttributeIterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::pair<std::string_view, ValueRef>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const value_type *;
+		using reference = value_type;
+
+		AttributeIterator(const Tape *tape, size_t index) : tape(tape), index(index) {}
+
+		value_type operator*() const;
+		AttributeIterator &operator++();
+		bool operator==(const AttributeIterator &other) const { return index == other.index; }
+		bool operator!=(const AttributeIterator &other) const { return index != other.index; }
+
+	private:
+		const Tape *tape; /**< Tape of the attributes. */
+		size_t index;     /**< Index of the current attribute entry. */
+	};
+
+	/**
+	 * @brief Range of the attributes of a node.
+	 */
+	class AttributeRange {
+	public:
+		AttributeRange(const Tape *tape, size_t first, size_t last) : tape(tape), first(first), last(last) {}
+
+		AttributeIterator begin() const { return AttributeIterator(tape, first); }
+		AttributeIterator end() const { return AttributeIterator(tape, last); }
+		bool empty() const { return first == last; }
+
+	private:
+		const Tape *tape; /**< Tape of the attributes. */
+		size_t first;     /**< Index of the first attribute entry. */
+		size_t last;      /**< Index after the last attribute. */
+	};
+
+	/**
+	 * @brief Constructor for the NodeRef class.
+	 *
+	 * @param tape The tape of the element.
+	 * @param index Index of the element entry.
+	 */
+	NodeRef(const Tape *tape, size_t index) : tape(tape), index(index) {}
+
+	/**
+	 * @brief Gets the type of the element.
+	 *
+	 * @return int The element type (Element::NODE, DATA or COMMENT).
+	 */
+	int get_element_type() const;
+
+	/**
+	 * @brief Gets the name of a node.
+	 *
+	 * @return std::string_view The name, valid while the tape lives.
+	 */
+	std::string_view get_name() const;
+
+	/**
+	 * @brief Gets the attributes of a node in document order.
+	 *
+	 * @return AttributeRange The attributes.
+	 */
+	AttributeRange get_attributes() const;
+
+	/**
+	 * @brief Checks if a node has an attribute given its name.
+	 *
+	 * @param name The name of the attribute.
+	 * @return true If the node has the attribute.
+	 */
+	bool has_attr(std::string_view name) const { return static_cast<bool>(get_attr(name)); }
+
+	/**
+	 * @brief Gets the value of an attribute given its name.
+	 * If the key is repeated the last value is used, as in Node.
+	 *
+	 * @param name The name of the attribute.
+	 * @return ValueRef The value, or an empty ValueRef if there is no such attribute.
+	 */
+	ValueRef get_attr(std::string_view name) const;
+
+	/**
+	 * @brief Gets the children of a node.
+	 *
+	 * @return Range The children, empty for data and comments.
+	 */
+	Range get_children() const;
+
+	/**
+	 * @brief Gets the value of a data element.
+	 *
+	 * @return ValueRef The value.
+	 */
+	ValueRef get_value() const { return ValueRef(tape, index); }
+
+	/**
+	 * @brief Gets the content of a comment.
+	 *
+	 * @return std::string_view The content, valid while the tape lives.
+	 */
+	std::string_view get_string() const;
+
+private:
+	/**
+	 * @brief Gets the index of the next sibling.
+	 *
+	 * @return size_t The index of the entry following the element.
+	 */
+	size_t next_index() const;
+
+	/**
+	 * @brief Gets the index of the first child, after the attributes.
+	 *
+	 * @return size_t The index of the first child entry.
+	 */
+	size_t children_index() const;
+
+	const Tape *tape; /**< Tape of the element. */
+	size_t index;     /**< Index of the element entry. */
+};
+
+/**
+ * @brief Immutable DFML document stored as a flat array of 64 bit entries.
+ *
+ * The entries are laid out in document order. The top byte of each entry is
+ * a tag and the rest its payload:
+ * - node: name offset, followed by the index after its last child;
+ * - attribute: key offset, followed by the value entries;
+ * - comment and string: text offset;
+ * - integer and double: followed by the raw 64 bit data;
+ * - boolean: 0 or 1.
+ * Names and texts are copied to a separate string buffer, each one prefixed
+ * by its 32 bit length.
+ *
+ * A tape can be saved to a file and opened again with open(): the file is
+ * mapped and read in place. By default open() only checks the header and
+ * the size, so opening is immediate and only the pages of the visited
+ * elements are loaded; the file must then be one saved by save(). Files
+ * from untrusted sources should be opened with verify: every entry and
+ * string is checked once, loading every page, so a corrupt file is an error
+ * instead of reads out of the mapping.
+ *
+ * Example:
+ * @code
+ * auto tape = dfml::Parser::create(data)->parse_tape();
+ * for (auto element : tape->get_elements()) {
+ *     if (element.get_element_type() == dfml::Element::NODE)
+ *         std::cout << element.get_name() << " " << element.get_attr("id").get_integer();
+ * }
+ * @endcode
+ */
+class Tape {
+public:
+	Tape() = default;
+	Tape(const Tape &) = delete;
+	Tape &operator=(const Tape &) = delete;
+
+	/**
+	 * @brief Maximum length of the strings, names, keys and comments of a tape,
+	 * stored with a 32 bit length.
+	 */
+	static constexpr size_t MAX_STRING_LENGTH = UINT32_MAX;
+
+	/**
+	 * @brief Opens a tape saved by save(), mapping the file.
+	 *
+	 * @param path Path of the file.
+	 * @param verify Check every entry and string too, not only the header and size.
+	 * @return std::shared_ptr<Tape> The tape, reading the mapped file.
+	 * @throws std::runtime_error If the file cannot be mapped or is not a valid saved tape.
+	 */
+	static std::shared_ptr<Tape> open(const std::string path, bool verify = false);
+
+	/**
+	 * @brief Opens a tape saved by save() in a mapped file.
+	 *
+	 * @param file The mapped file, kept alive by the tape.
+	 * @param verify Check every entry and string too, not only the header and size.
+	 * @return std::shared_ptr<Tape> The tape, reading the mapped file.
+	 * @throws std::runtime_error If the file is not a valid saved tape.
+	 */
+	static std::shared_ptr<Tape> open(std::shared_ptr<MappedFile> file, bool verify = false);
+
+	/**
+	 * @brief Writes the tape in the format read by open().
+	 * The entries are written in the native byte order.
+	 *
+	 * @param sink The output.
+	 */
+	void save(Sink &sink) const;
+
+	/**
+	 * @brief Gets the top level elements.
+	 *
+	 * @return NodeRef::Range The top level elements.
+	 */
+	NodeRef::Range get_elements() const { return NodeRef::Range(this, 0, entry_count); }
+
+	/**
+	 * @brief Gets the memory used by the entries and the strings.
+	 * For opened tapes this is the size of the mapped file.
+	 *
+	 * @return size_t Size in bytes.
+	 */
+	size_t memory_size() const;
+
+private:
+	friend class TapeHandler;
+	friend class NodeRef;
+	friend class ValueRef;
+
+	static constexpr uint64_t NODE = 'n';      /**< Node entry tag. */
+	static constexpr uint64_t ATTRIBUTE = 'a'; /**< Attribute entry tag. */
+	static constexpr uint64_t COMMENT = 'c';   /**< Comment entry tag. */
+	static constexpr uint64_t STRING = 's';    /**< String value entry tag. */
+	static constexpr uint64_t INTEGER = 'i';   /**< Integer value entry tag. */
+	static constexpr uint64_t DOUBLE = 'd';    /**< Double value entry tag. */
+	static constexpr uint64_t BOOLEAN = 'b';   /**< Boolean value entry tag. */
+
+	static constexpr uint64_t PAYLOAD = (uint64_t(1) << 56) - 1; /**< Payload mask. */
+
+	static constexpr char MAGIC[4] = {'D', 'F', 'M', 'T'}; /**< Signature of saved tapes. */
+	static constexpr uint32_t ORDER = 1; /**< Byte order and version mark of saved tapes. */
+
+	/**
+	 * @brief Header of a saved tape, followed by the entries and the strings.
+	 */
+	struct Header {
+		char magic[4];       /**< MAGIC. */
+		uint32_t order;      /**< ORDER, in the byte order of the entries. */
+		uint64_t entries;    /**< Count of entries. */
+		uint64_t strings;    /**< Size of the strings. */
+	};
+
+	uint64_t entry(size_t index) const { return entry_data[index]; }
+	uint64_t tag(size_t index) const { return entry_data[index] >> 56; }
+	uint64_t payload(size_t index) const { return entry_data[index] & PAYLOAD; }
+
+	/**
+	 * @brief Points the entry and string views to the built vectors.
+	 */
+	void attach() {
+		entry_data = entries.data();
+		entry_count = entries.size();
+		string_data = strings.data();
+		string_size = strings.size();
+	}
+
+	/**
+	 * @brief Checks that the entries form a valid tree and that the strings
+	 * are inside the string buffer, so the views read inside the tape.
+	 *
+	 * @throws std::runtime_error If the tape is not valid.
+	 */
+	void check() const;
+
+	/**
+	 * @brief Gets a string of the string buffer.
+	 *
+	 * @param offset Offset of the length prefix of the string.
+	 * @return std::string_view The string.
+	 */
+	std::string_view string_at(uint64_t offset) const;
+
+	std::vector<uint64_t> entries; /**< Tagged entries in document order, while built. */
+	std::string strings;           /**< Length prefixed names and texts, while built. */
+	std::shared_ptr<MappedFile> file; /**< Mapped file of an opened tape. */
+
+	const uint64_t *entry_data{}; /**< Entries read by the views. */
+	size_t entry_count{};         /**< Count of entries. */
+	const char *string_data{};    /**< Strings read by the views. */
+	size_t string_size{};         /**< Size of the strings. */
+};
+
+/**
+ * @brief Handler that stores the parsing events in a Tape.
+ *
+ * This is the handler used by Parser::parse_tape().
+ */
+class TapeHandler : public Handler {
+public:
+	TapeHandler() : tape(std::make_shared<Tape>()) {}
+
+	void on_node_begin(std::string_view name) override;
+	void on_attribute(std::string_view key, const Value &value) override;
+	void on_data(const Value &value) override;
+	void on_comment(std::string_view text) override;
+	void on_node_end() override;
+
+	/**
+	 * @brief Gets the tape built so far.
+	 *
+	 * @return std::shared_ptr<Tape> The tape.
+	 */
+	std::shared_ptr<Tape> get_tape() {
+		tape->attach();
+		return tape;
+	}
+
+private:
+	/**
+	 * @brief Adds an entry.
+	 *
+	 * @param tag The entry tag.
+	 * @param payload The entry payload.
+	 */
+	void add(uint64_t tag, uint64_t payload) { tape->entries.push_back(tag << 56 | payload); }
+
+	/**
+	 * @brief Adds the entries of a value.
+	 *
+	 * @param value The value.
+	 */
+	void add_value(const Value &value);
+
+	/**
+	 * @brief Adds a string to the string buffer.
+	 *
+	 * @param string The string.
+	 * @return uint64_t The offset of the string.
+	 * @throws std::length_error If the string is longer than Tape::MAX_STRING_LENGTH.
+	 */
+	uint64_t add_string(std::string_view string);
+
+	std::shared_ptr<Tape> tape; /**< Tape being built. */
+	std::vector<size_t> nodes;  /**< Entry indexes of the open nodes. */
+};
+
+} // namespace dfml
@@ -0,0 +1,104 @@
+/**
+ * @file thread_pool.h
+ * @brief Declaration of the ThreadPool class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dfml {
+
+/**
+ * @brief Fixed set of worker threads running submitted tasks in order.
+ *
+ * Tasks must not wait for other tasks of the same pool: with every worker
+ * waiting, the awaited tasks would never run.
+ *
+ * Example:
+ * @code
+ * auto pool = dfml::ThreadPool::create();
+ * auto result = pool->submit([]() { return 42; });
+ * int value = result.get();
+ * @endcode
+ */
+class ThreadPool {
+public:
+	/**
+	 * @brief Constructor for the ThreadPool class. Starts the workers.
+	 *
+	 * @param threads Count of workers, 0 for one per hardware thread.
+	 */
+	ThreadPool(unsigned threads = 0);
+
+	/**
+	 * @brief Destructor for the ThreadPool class.
+	 * Runs the pending tasks and joins the workers.
+	 */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/**
+	 * @brief Creates and returns a shared pointer to a ThreadPool instance.
+	 *
+	 * @param threads Count of workers, 0 for one per hardware thread.
+	 * @return std::shared_ptr<ThreadPool> Shared pointer to the new ThreadPool instance.
+	 */
+	static std::shared_ptr<ThreadPool> create(unsigned threads = 0);
+
+	/**
+	 * @brief Submits a task to run on a worker.
+	 *
+	 * @param function The task, a callable without arguments.
+	 * @return std::future The result of the task, or the exception it threw.
+	 */
+	template <typename Function>
+	auto submit(Function function) -> std::future<decltype(function())> {
+		auto task = std::make_shared<std::packaged_task<decltype(function())()>>(std::move(function));
+		auto future = task->get_future();
+		push([task]() { (*task)(); });
+		return future;
+	}
+
+	/**
+	 * @brief Gets the count of workers.
+	 *
+	 * @return unsigned The count of workers.
+	 */
+	unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+	/**
+	 * @brief Queues a task and wakes a worker.
+	 *
+	 * @param task The task.
+	 */
+	void push(std::function<void()> task);
+
+	/**
+	 * @brief Runs the queued tasks until the pool is destroyed.
+	 */
+	void work();
+
+	std::vector<std::thread> workers;        /**< Worker threads. */
+	std::deque<std::function<void()>> tasks; /**< Queued tasks. */
+	std::mutex mutex;                        /**< Guards tasks and stopping. */
+	std::condition_variable available;       /**< Signals queued tasks or stopping. */
+	bool stopping{};                         /**< The pool is being destroyed. */
+};
+
+} // namespace dfml
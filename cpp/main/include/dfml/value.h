@@ -10,15 +10,44 @@
 
 #pragma once
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
 
 namespace dfml {
 
 /**
  * @brief Class representing a value in the Dragonfly Markup Language (DFML).
+ *
+ * The value is stored in its native type: a long, a double, a bool or a
+ * string (short strings are kept inline). The text of numbers and booleans
+ * is only produced by get_value().
+ *
+ * Strings are allocated from a std::pmr::memory_resource, the default one
+ * unless the value is copied into a Document.
  */
 class Value {
 public:
+	/**
+	 * @brief Default constructor for the Value class: an empty string.
+	 */
+	Value() = default;
+
+	/**
+	 * @brief Copies a value, allocating its string from the given resource.
+	 * 
+	 * @param value The value to copy.
+	 * @param resource The memory resource of the string.
+	 */
+	Value(const Value &value, std::pmr::memory_resource *resource);
+
+	Value(const Value &) = default;
+	Value(Value &&) = default;
+	Value &operator=(const Value &) = default;
+	Value &operator=(Value &&) = default;
+
 	/**
 	 * @brief Constant representing a string type value.
 	 */
@@ -44,46 +73,122 @@ public:
 	 * 
 	 * @return const int The type of the value.
 	 */
-	const int get_type() { return type; };
+	const int get_type() const { return static_cast<int>(data.index()); };
 
 	/**
 	 * @brief Sets the value as a string.
 	 * 
 	 * @param data The string data to set.
 	 */
-	void set_string(const std::string data);
+	void set_string(std::string_view data);
 
 	/**
 	 * @brief Sets the value as an integer.
 	 * 
 	 * @param data The integer data to set.
 	 */
-	void set_integer(long data);
+	void set_integer(long data) { this->data = data; }
 
 	/**
 	 * @brief Sets the value as a double.
 	 * 
 	 * @param data The double data to set.
 	 */
-	void set_double(double data);
+	void set_double(double data) { this->data = data; }
 
 	/**
 	 * @brief Sets the value as a boolean.
 	 * 
 	 * @param data The boolean data to set.
 	 */
-	void set_boolean(bool data);
+	void set_boolean(bool data) { this->data = data; }
+
+	/**
+	 * @brief Gets the data of a string value.
+	 * 
+	 * @return std::string_view The string data.
+	 * @throws std::bad_variant_access If the value is not a string.
+	 */
+	std::string_view get_string() const { return std::get<std::pmr::string>(data); }
+
+	/**
+	 * @brief Gets the data of an integer value.
+	 * 
+	 * @return long The integer data.
+	 * @throws std::bad_variant_access If the value is not an integer.
+	 */
+	long get_integer() const { return std::get<long>(data); }
+
+	/**
+	 * @brief Gets the data of a double value.
+	 * 
+	 * @return double The double data.
+	 * @throws std::bad_variant_access If the value is not a double.
+	 */
+	double get_double() const { return std::get<double>(data); }
+
+	/**
+	 * @brief Gets the data of a boolean value.
+	 * 
+	 * @return bool The boolean data.
+	 * @throws std::bad_variant_access If the value is not a boolean.
+	 */
+	bool get_boolean() const { return std::get<bool>(data); }
+
+	/**
+	 * @brief Checks if the value is of one of the stored types.
+	 * 
+	 * @tparam T std::string, std::string_view, long, double or bool.
+	 * @return true If get<T>() would succeed.
+	 */
+	template <typename T>
+	bool is() const {
+		if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+			return std::holds_alternative<std::pmr::string>(data);
+		else
+			return std::holds_alternative<T>(data);
+	}
+
+	/**
+	 * @brief Gets the data as one of the stored types.
+	 * 
+	 * @tparam T std::string, std::string_view, long, double or bool.
+	 * @return T The data.
+	 * @throws std::bad_variant_access If the value is not of type T.
+	 */
+	template <typename T>
+	T get() const {
+		if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+			return T(get_string());
+		else
+			return std::get<T>(data);
+	}
 
 	/**
 	 * @brief Gets the string representation of the value.
+	 * Doubles use the shortest text that reads back to the same double,
+	 * always with a '.' or an exponent.
 	 * 
 	 * @return const std::string The string representation of the value.
 	 */
-	const std::string get_value() { return value; };
+	const std::string get_value() const;
+
+	/**
+	 * @brief Writes the text of an integer, double or boolean value.
+	 * Strings are not written.
+	 * 
+	 * @param first Start of the output, at least TEXT_SIZE bytes.
+	 * @return char* End of the written text.
+	 */
+	char *to_chars(char *first) const;
+
+	/**
+	 * @brief Room needed by to_chars().
+	 */
+	static constexpr size_t TEXT_SIZE = 32;
 
 private:
-	int type{}; /**< Type of the value. */
-	std::string value{}; /**< String representation of the value. */
+	std::variant<std::pmr::string, long, double, bool> data{}; /**< Data of the value. */
 };
 
 } // namespace dfml
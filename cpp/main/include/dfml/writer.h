@@ -0,0 +1,199 @@
+/**
+ * @file writer.h
+ * @brief Declaration of the Writer class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-30
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <dfml/builder.h>
+
+namespace dfml {
+
+class Sink;
+class Value;
+
+/**
+ * @class WriterException
+ * @brief Exception class for writer-related errors, such as calls out of order.
+ */
+class WriterException : public std::exception {
+public:
+	/**
+	 * @brief Constructor for the WriterException class.
+	 * @param message The custom error message associated with the exception.
+	 */
+	explicit WriterException(const std::string &message) : message(message) {}
+
+	/**
+	 * @brief Returns the error message associated with the exception.
+	 * @return A pointer to the C-style string representing the error message.
+	 */
+	const char *what() const noexcept override {
+		return message.c_str();
+	}
+
+private:
+	/// The custom error message associated with the exception.
+	std::string message;
+};
+
+/**
+ * @brief Streaming writer of DFML documents, without building Element objects.
+ *
+ * Each call writes its text to the sink right away, so the memory used only
+ * depends on the nesting depth. The output is the same as the Builder output
+ * for the same settings; top level elements are separated by a new line (or
+ * a space without format).
+ *
+ * Example:
+ * @code
+ * dfml::FdSink sink(fd);
+ * dfml::Writer writer(sink);
+ * writer.begin_node("row");
+ * writer.attribute("id", id);
+ * writer.data(value);
+ * writer.end_node();
+ * writer.finish();
+ * @endcode
+ */
+class Writer {
+public:
+	/**
+	 * @brief Constructor for the Writer class.
+	 *
+	 * @param sink The output, which must outlive the writer.
+	 */
+	Writer(Sink &sink) : sink(sink) {}
+
+	/**
+	 * @brief Creates and returns a shared pointer to a Writer instance.
+	 *
+	 * @param sink The output, which must outlive the writer.
+	 * @return std::shared_ptr<Writer> Shared pointer to the new Writer instance.
+	 */
+	static std::shared_ptr<Writer> create(Sink &sink);
+
+	/**
+	 * @brief Format the code, as Builder::set_format().
+	 *
+	 * @param f true for format.
+	 */
+	void set_format(const bool f) { builder.set_format(f); }
+
+	/**
+	 * @brief Use spaces for indent, as Builder::use_spaces_for_indent().
+	 *
+	 * @param us true for spaces indent.
+	 */
+	void use_spaces_for_indent(const bool us) { builder.use_spaces_for_indent(us); }
+
+	/**
+	 * @brief Set the space count for indent, as Builder::set_space_count().
+	 *
+	 * @param count count of spaces.
+	 */
+	void set_space_count(const unsigned count) { builder.set_space_count(count); }
+
+	/**
+	 * @brief Starts a node. Its attributes and children follow, then end_node().
+	 *
+	 * @param name The name of the node.
+	 * @throws WriterException If the name is empty or the writer is finished.
+	 */
+	void begin_node(std::string_view name);
+
+	/**
+	 * @brief Writes an attribute of the current node.
+	 *
+	 * @param key The key of the attribute.
+	 * @param value The value of the attribute.
+	 * @throws WriterException If there is no node, or it already has children.
+	 */
+	void attribute(std::string_view key, const Value &value);
+
+	/**
+	 * @brief Writes a data element.
+	 *
+	 * @param value The value of the data.
+	 * @throws WriterException If the writer is finished.
+	 */
+	void data(const Value &value);
+
+	/**
+	 * @brief Writes a comment.
+	 *
+	 * @param text The content of the comment.
+	 * @throws WriterException If the writer is finished.
+	 */
+	void comment(std::string_view text);
+
+	/**
+	 * @brief Ends the current node.
+	 *
+	 * @throws WriterException If there is no node to end.
+	 */
+	void end_node();
+
+	/**
+	 * @brief Flushes the sink.
+	 */
+	void flush();
+
+	/**
+	 * @brief Ends the document and flushes the sink.
+	 *
+	 * @throws WriterException If some node was not ended.
+	 */
+	void finish();
+
+	/**
+	 * @brief Gets the count of open nodes.
+	 *
+	 * @return size_t The nesting depth.
+	 */
+	size_t depth() const { return nodes.size(); }
+
+private:
+	/**
+	 * @brief State of an open node.
+	 */
+	struct Frame {
+		bool attributes; /**< The attribute list is open. */
+		bool children;   /**< Some child was written. */
+	};
+
+	/**
+	 * @brief Starts an element: closes the attribute list and opens the
+	 * children of the current node, or separates top level elements.
+	 */
+	void begin_element();
+
+	/**
+	 * @brief Ends an element, writing the separator of the children.
+	 */
+	void end_element();
+
+	/**
+	 * @brief Throws if the writer was finished.
+	 */
+	void check_open() const;
+
+	Sink &sink;                /**< Output. */
+	Builder builder;           /**< Settings and value formatting. */
+	std::vector<Frame> nodes;  /**< Open nodes. */
+	bool top_level_written{};  /**< Some top level element was written. */
+	bool finished{};           /**< finish() was called. */
+};
+
+} // namespace dfml
@@ -0,0 +1,115 @@
+/**
+ * @file attribute_map.cpp
+ * @brief Implementation of the AttributeMap class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/attribute_map.h>
+
+#include <functional>
+#include <tuple>
+
+namespace dfml {
+
+/**
+ * @brief Sets an attribute, adding it at the end if it does not exist.
+ * The value is copied to the memory resource of the map.
+ *
+ * @param key The key of the attribute.
+ * @param value The value of the attribute.
+ * @return Value& The stored value.
+ */
+Value &AttributeMap::set(std::string_view key, const Value &value) {
+	std::pmr::memory_resource *resource = entries.get_allocator().resource();
+	size_t position = locate(key);
+
+	if (position < entries.size()) {
+		entries[position].second = Value(value, resource);
+		return entries[position].second;
+	}
+
+	entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+			std::forward_as_tuple(value, resource));
+	index_position(position);
+	return entries.back().second;
+}
+
+/**
+ * @brief Gets an attribute, adding it as an empty string if it does not exist.
+ *
+ * @param key The key of the attribute.
+ * @return Value& The stored value.
+ */
+Value &AttributeMap::get(std::string_view key) {
+	size_t position = locate(key);
+	if (position < entries.size()) return entries[position].second;
+
+	entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+			std::forward_as_tuple(Value(), entries.get_allocator().resource()));
+	index_position(position);
+	return entries.back().second;
+}
+
+/**
+ * @brief Gets the position of an attribute.
+ *
+ * @param key The key of the attribute.
+ * @return size_t The position, or size() if there is no such attribute.
+ */
+size_t AttributeMap::locate(std::string_view key) const {
+	if (index.empty()) {
+		for (size_t n = 0; n < entries.size(); n++) {
+			if (entries[n].first == key) return n;
+		}
+		return entries.size();
+	}
+
+	size_t mask = index.size() - 1;
+	for (size_t slot = std::hash<std::string_view>()(key) & mask; index[slot]; slot = (slot + 1) & mask) {
+		size_t position = index[slot] - 1;
+		if (entries[position].first == key) return position;
+	}
+	return entries.size();
+}
+
+/**
+ * @brief Adds the position of an attribute to the hash index.
+ * The index is created above INDEX_THRESHOLD attributes and kept at most
+ * half full.
+ *
+ * @param position The position of the attribute.
+ */
+void AttributeMap::index_position(size_t position) {
+	if (entries.size() <= INDEX_THRESHOLD) return;
+	if (entries.size() * 2 > index.size()) {
+		rebuild_index();
+		return;
+	}
+
+	size_t mask = index.size() - 1;
+	size_t slot = std::hash<std::string_view>()(entries[position].first) & mask;
+	while (index[slot]) slot = (slot + 1) & mask;
+	index[slot] = static_cast<uint32_t>(position + 1);
+}
+
+/**
+ * @brief Rebuilds the hash index for the current attributes.
+ */
+void AttributeMap::rebuild_index() {
+	size_t slots = 32;
+	while (slots < entries.size() * 4) slots *= 2;
+
+	index.assign(slots, 0);
+	size_t mask = slots - 1;
+	for (size_t position = 0; position < entries.size(); position++) {
+		size_t slot = std::hash<std::string_view>()(entries[position].first) & mask;
+		while (index[slot]) slot = (slot + 1) & mask;
+		index[slot] = static_cast<uint32_t>(position + 1);
+	}
+}
+
+} // namespace dfml
@@ -0,0 +1,466 @@
+/**
+ * @file binary.cpp
+ * @brief Implementation of the BinaryEncoder and BinaryDecoder classes in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-06
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/binary.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <dfml/comment.h>
+#include <dfml/data.h>
+#include <dfml/document.h>
+#include <dfml/element.h>
+#include <dfml/node.h>
+#include <dfml/parser.h>
+#include <dfml/sink.h>
+#include <dfml/tape.h>
+
+namespace dfml {
+
+/**
+ * @brief Size of the pending output written to the sink at once.
+ */
+static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+/**
+ * @brief Constructor for the BinaryEncoder class. Writes the signature.
+ *
+ * @param sink The output, which must outlive the encoder.
+ */
+BinaryEncoder::BinaryEncoder(Sink &sink) : sink(sink) {
+	buffer.reserve(BUFFER_SIZE + 64);
+	buffer.append(binary::MAGIC);
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a BinaryEncoder instance.
+ *
+ * @param sink The output, which must outlive the encoder.
+ * @return std::shared_ptr<BinaryEncoder> Shared pointer to the new BinaryEncoder instance.
+ */
+std::shared_ptr<BinaryEncoder> BinaryEncoder::create(Sink &sink) {
+	return std::make_shared<BinaryEncoder>(sink);
+}
+
+/**
+ * @brief Encodes an Element and its children.
+ * The nested nodes are followed with an explicit stack, so any depth is supported.
+ *
+ * @param element The Element to encode.
+ */
+void BinaryEncoder::write(const Element &element) {
+	// Open node and position of its next child
+	struct Frame {
+		const Node *node;
+		size_t next;
+	};
+
+	std::vector<Frame> stack;
+	const Element *current = &element;
+
+	for (;;) {
+		switch (current->get_element_type()) {
+		case Element::NODE: {
+			auto &node = static_cast<const Node &>(*current);
+			on_node_begin(node.name);
+			for (auto &attribute : node.attrs) on_attribute(attribute.first, attribute.second);
+			stack.push_back(Frame{&node, 0});
+			break;
+		}
+
+		case Element::DATA:
+			on_data(static_cast<const Data &>(*current).get_value());
+			break;
+
+		default:
+			on_comment(static_cast<const Comment &>(*current).string);
+		}
+
+		// Next child, ending the nodes without more children
+		current = nullptr;
+		while (!current && !stack.empty()) {
+			Frame &frame = stack.back();
+			if (frame.next < frame.node->children.size()) {
+				current = frame.node->children[frame.next++].get();
+			} else {
+				on_node_end();
+				stack.pop_back();
+			}
+		}
+		if (!current) return;
+	}
+}
+
+/**
+ * @brief Writes the pending output to the sink and flushes it.
+ */
+void BinaryEncoder::finish() {
+	sink.write(buffer);
+	buffer.clear();
+	sink.flush();
+}
+
+void BinaryEncoder::on_node_begin(std::string_view name) {
+	buffer.push_back(binary::NODE);
+	put_name(name);
+	check_buffer();
+}
+
+void BinaryEncoder::on_attribute(std::string_view key, const Value &value) {
+	buffer.push_back(binary::ATTRIBUTE);
+	put_name(key);
+	put_value(value);
+	check_buffer();
+}
+
+void BinaryEncoder::on_data(const Value &value) {
+	put_value(value);
+	check_buffer();
+}
+
+void BinaryEncoder::on_comment(std::string_view text) {
+	buffer.push_back(binary::COMMENT);
+	put_string(text);
+	check_buffer();
+}
+
+void BinaryEncoder::on_node_end() {
+	buffer.push_back(binary::END);
+	check_buffer();
+}
+
+/**
+ * @brief Writes an unsigned varint.
+ *
+ * @param number The number.
+ */
+void BinaryEncoder::put_varint(uint64_t number) {
+	while (number >= 0x80) {
+		buffer.push_back(static_cast<char>(number | 0x80));
+		number >>= 7;
+	}
+	buffer.push_back(static_cast<char>(number));
+}
+
+/**
+ * @brief Writes a length prefixed string.
+ *
+ * @param string The string.
+ */
+void BinaryEncoder::put_string(std::string_view string) {
+	put_varint(string.size());
+	buffer.append(string);
+}
+
+/**
+ * @brief Writes a name or key reference, adding new ones to the string table.
+ *
+ * @param name The name or key.
+ */
+void BinaryEncoder::put_name(std::string_view name) {
+	auto it = table.find(name);
+	if (it != table.end()) {
+		put_varint(it->second + 1);
+		return;
+	}
+
+	put_varint(0);
+	put_string(name);
+	if (table.size() < binary::TABLE_SIZE) {
+		names.emplace_back(name);
+		table.emplace(names.back(), static_cast<uint32_t>(table.size()));
+	}
+}
+
+/**
+ * @brief Writes a value record.
+ *
+ * @param value The value.
+ */
+void BinaryEncoder::put_value(const Value &value) {
+	uint64_t number;
+
+	switch (value.get_type()) {
+	case Value::INTEGER:
+		buffer.push_back(binary::INTEGER);
+		number = static_cast<uint64_t>(value.get_integer());
+		break;
+
+	case Value::DOUBLE: {
+		double dbl = value.get_double();
+		std::memcpy(&number, &dbl, sizeof(number));
+		buffer.push_back(binary::DOUBLE);
+		break;
+	}
+
+	case Value::BOOLEAN:
+		buffer.push_back(value.get_boolean() ? binary::BOOLEAN_TRUE : binary::BOOLEAN_FALSE);
+		return;
+
+	default:
+		buffer.push_back(binary::STRING);
+		put_string(value.get_string());
+		return;
+	}
+
+	char bytes[8];
+	for (int n = 0; n < 8; n++) bytes[n] = static_cast<char>(number >> (n * 8));
+	buffer.append(bytes, sizeof(bytes));
+}
+
+/**
+ * @brief Writes the buffer to the sink when it is full.
+ */
+void BinaryEncoder::check_buffer() {
+	if (buffer.size() < BUFFER_SIZE) return;
+	sink.write(buffer);
+	buffer.clear();
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a BinaryDecoder instance.
+ * The data is decoded in place: it must outlive the decoder.
+ *
+ * @param data The binary data to decode.
+ * @return std::shared_ptr<BinaryDecoder> Shared pointer to the new BinaryDecoder instance.
+ */
+std::shared_ptr<BinaryDecoder> BinaryDecoder::create(std::string_view data) {
+	return std::make_shared<BinaryDecoder>(data);
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a BinaryDecoder instance.
+ * The decoder takes ownership of the data.
+ *
+ * @param data The binary data to decode.
+ * @return std::shared_ptr<BinaryDecoder> Shared pointer to the new BinaryDecoder instance.
+ */
+std::shared_ptr<BinaryDecoder> BinaryDecoder::create(std::string data) {
+	return std::make_shared<BinaryDecoder>(std::move(data));
+}
+
+/**
+ * @brief Decodes the data and returns the top level elements.
+ *
+ * @return std::list<std::shared_ptr<Element>> The decoded elements.
+ * @throws ParserException If the data is not valid.
+ */
+std::list<std::shared_ptr<Element>> BinaryDecoder::decode() {
+	TreeHandler tree;
+
+	decode(tree);
+
+	return std::move(tree.get_elements());
+}
+
+/**
+ * @brief Decodes the data into a Document.
+ * The first arena block is sized after the data.
+ *
+ * @return std::shared_ptr<Document> The decoded document.
+ * @throws ParserException If the data is not valid.
+ */
+std::shared_ptr<Document> BinaryDecoder::decode_document() {
+	auto document = Document::create(std::max(data.size() * 2, size_t(4096)));
+	TreeHandler tree(document.get());
+
+	decode(tree);
+
+	return document;
+}
+
+/**
+ * @brief Decodes the data into an immutable Tape.
+ *
+ * @return std::shared_ptr<Tape> The decoded tape.
+ * @throws ParserException If the data is not valid.
+ */
+std::shared_ptr<Tape> BinaryDecoder::decode_tape() {
+	TapeHandler tape;
+
+	decode(tape);
+
+	return tape.get_tape();
+}
+
+/**
+ * @brief Decodes the data reporting each element to the handler.
+ * The events are checked before they are reported: attributes only follow
+ * a node or another attribute, and every node is ended.
+ *
+ * @param handler The handler that receives the decoding events.
+ * @throws ParserException If the data is not valid.
+ */
+void BinaryDecoder::decode(Handler &handler) {
+	position = 0;
+	table.clear();
+
+	if (data.substr(0, binary::MAGIC.size()) != binary::MAGIC) error("Not binary DFML data");
+	position = binary::MAGIC.size();
+
+	size_t depth = 0;
+	bool attributes = false; // Attributes allowed
+
+	while (position < data.size()) {
+		uint8_t tag = get_byte();
+
+		switch (tag) {
+		case binary::NODE:
+			handler.on_node_begin(get_name());
+			depth++;
+			attributes = true;
+			break;
+
+		case binary::ATTRIBUTE: {
+			if (!attributes) error("Attribute outside of a node");
+			std::string_view key = get_name();
+			tag = get_byte();
+			handler.on_attribute(key, get_value(tag));
+			break;
+		}
+
+		case binary::END:
+			if (!depth) error("Node end outside of a node");
+			handler.on_node_end();
+			depth--;
+			attributes = false;
+			break;
+
+		case binary::COMMENT:
+			handler.on_comment(get_string());
+			attributes = false;
+			break;
+
+		default:
+			handler.on_data(get_value(tag));
+			attributes = false;
+		}
+	}
+
+	if (depth) error("Unexpected end of data: " + std::to_string(depth) + " nodes not ended");
+}
+
+/**
+ * @brief Reads a byte.
+ *
+ * @return uint8_t The byte.
+ */
+uint8_t BinaryDecoder::get_byte() {
+	if (position >= data.size()) error("Unexpected end of data");
+	return static_cast<uint8_t>(data[position++]);
+}
+
+/**
+ * @brief Reads an unsigned varint.
+ *
+ * @return uint64_t The number.
+ */
+uint64_t BinaryDecoder::get_varint() {
+	// Lengths and references are mostly below 128
+	if (position < data.size() && !(data[position] & 0x80)) return static_cast<uint8_t>(data[position++]);
+
+	uint64_t number = 0;
+
+	for (int shift = 0; shift < 64; shift += 7) {
+		uint8_t byte = get_byte();
+		number |= uint64_t(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) return number;
+	}
+
+	error("Invalid varint");
+}
+
+/**
+ * @brief Reads 8 bytes little endian.
+ *
+ * @return uint64_t The number.
+ */
+uint64_t BinaryDecoder::get_fixed() {
+	if (data.size() - position < 8) error("Unexpected end of data");
+
+	uint64_t number = 0;
+	const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data.data() + position);
+	for (int n = 0; n < 8; n++) number |= uint64_t(bytes[n]) << (n * 8);
+
+	position += 8;
+	return number;
+}
+
+/**
+ * @brief Reads a length prefixed string.
+ *
+ * @return std::string_view The string, in the data.
+ */
+std::string_view BinaryDecoder::get_string() {
+	uint64_t length = get_varint();
+	if (length > data.size() - position) error("Unexpected end of data");
+
+	std::string_view string = data.substr(position, length);
+	position += length;
+	return string;
+}
+
+/**
+ * @brief Reads a name or key reference.
+ *
+ * @return std::string_view The name or key, in the data.
+ */
+std::string_view BinaryDecoder::get_name() {
+	uint64_t reference = get_varint();
+
+	if (reference) {
+		if (reference > table.size()) error("Invalid string reference");
+		return table[reference - 1];
+	}
+
+	std::string_view name = get_string();
+	if (name.empty()) error("Empty name");
+	if (table.size() < binary::TABLE_SIZE) table.push_back(name);
+	return name;
+}
+
+/**
+ * @brief Reads a value given its tag.
+ *
+ * @param tag The value tag.
+ * @return const Value& The value, valid until the next value is read.
+ */
+const Value &BinaryDecoder::get_value(uint8_t tag) {
+	switch (tag) {
+	case binary::STRING: value.set_string(get_string()); break;
+	case binary::INTEGER: value.set_integer(static_cast<long>(get_fixed())); break;
+
+	case binary::DOUBLE: {
+		uint64_t number = get_fixed();
+		double dbl;
+		std::memcpy(&dbl, &number, sizeof(dbl));
+		value.set_double(dbl);
+		break;
+	}
+
+	case binary::BOOLEAN_FALSE: value.set_boolean(false); break;
+	case binary::BOOLEAN_TRUE: value.set_boolean(true); break;
+	default: error("Invalid tag " + std::to_string(tag));
+	}
+
+	return value;
+}
+
+/**
+ * @brief Throws a ParserException for invalid data.
+ *
+ * @param message Description of the error.
+ */
+void BinaryDecoder::error(const std::string &message) const {
+	throw ParserException("Binary DFML: " + message + " at byte " + std::to_string(position));
+}
+
+} // namespace dfml
@@ -10,14 +10,16 @@
 
 #include <dfml/builder.h>
 
-#include <sstream>
 #include <algorithm>
+#include <string_view>
+#include <vector>
 
 #include <dfml/element.h>
 #include <dfml/node.h>
 #include <dfml/data.h>
 #include <dfml/comment.h>
 #include <dfml/value.h>
+#include <dfml/sink.h>
 
 namespace dfml {
 
@@ -40,6 +42,16 @@ std::shared_ptr<Builder> Builder::create() {
 	return std::make_shared<Builder>();
 }
 
+/**
+ * @brief Writes the DFML representation of an Element to a sink.
+ * 
+ * @param element The Element to write.
+ * @param sink The output.
+ */
+void Builder::write(const Element &element, Sink &sink) const {
+	write_element(element, sink, 0);
+}
+
 /**
  * @brief Builds and returns the DFML representation of a Node.
  * 
@@ -47,24 +59,9 @@ std::shared_ptr<Builder> Builder::create() {
  * @return const std::string The DFML representation of the Node.
  */
 const std::string Builder::build_node(const std::shared_ptr<Node> node) {
-	std::stringstream ss;
-	ss << indent() << node->get_name();
-
-	if (!node->get_attr_keys().empty())
-		ss << build_attributes(node);
-
-	// Construct children:
-	auto children = node->get_children();
-	if (!children.empty()) {
-		ss << (format ? " {\n" : " { ");
-		level++;
-		for (auto &e : children) {
-			ss << build_element(e) << (format ? "\n" : " ");
-		}
-		level--;
-		ss << indent() << "}";
-	}
-	return ss.str();
+	BufferSink sink;
+	write_node(*node, sink, 0);
+	return sink.take();
 }
 
 /**
@@ -74,12 +71,9 @@ const std::string Builder::build_node(const std::shared_ptr<Node> node) {
  * @return const std::string The DFML representation of the Element.
  */
 const std::string Builder::build_element(const std::shared_ptr<Element> element) {
-	if (element->get_element_type() == Element::NODE)
-		return build_node(std::static_pointer_cast<Node>(element));
-	else if (element->get_element_type() == Element::DATA)
-		return build_data(std::static_pointer_cast<Data>(element));
-	else
-		return build_comment(std::static_pointer_cast<Comment>(element));
+	BufferSink sink;
+	write_element(*element, sink, 0);
+	return sink.take();
 }
 
 /**
@@ -89,7 +83,9 @@ const std::string Builder::build_element(const std::shared_ptr<Element> element)
  * @return const std::string The DFML representation of the Data.
  */
 const std::string Builder::build_data(const std::shared_ptr<Data> data) const {
-	return indent() + build_value(data->get_value());
+	BufferSink sink;
+	write_element(*data, sink, 0);
+	return sink.take();
 }
 
 /**
@@ -99,7 +95,9 @@ const std::string Builder::build_data(const std::shared_ptr<Data> data) const {
  * @return const std::string The DFML representation of the Comment.
  */
 const std::string Builder::build_comment(const std::shared_ptr<Comment> comment) const {
-	return indent() + "/*" + comment->get_string() + "*/";
+	BufferSink sink;
+	write_element(*comment, sink, 0);
+	return sink.take();
 }
 
 /**
@@ -108,24 +106,10 @@ const std::string Builder::build_comment(const std::shared_ptr<Comment> comment)
  * @param value The Value to build.
  * @return const std::string The DFML representation of the Value.
  */
-const std::string Builder::build_value(Value value) const {
-	if (value.get_type() == Value::STRING) {
-
-		bool dbl = (value.get_value().find('\"') != std::string::npos);
-		bool sgl = (value.get_value().find('\'') != std::string::npos);
-
-		if (dbl && sgl) {
-			// remove all '"'
-			std::string val = value.get_value();
-			val.erase(std::remove(val.begin(), val.end(), '\"'), val.end());
-			return "\"" + val + "\"";
-		}
-		if (dbl)
-			return "\'" + value.get_value() + "\'";
-
-		return "\"" + value.get_value() + "\"";
-	} else
-		return value.get_value();
+const std::string Builder::build_value(const Value &value) const {
+	BufferSink sink;
+	write_value(value, sink);
+	return sink.take();
 }
 
 /**
@@ -135,37 +119,174 @@ const std::string Builder::build_value(Value value) const {
  * @return const std::string The DFML representation of attributes for the Node.
  */
 const std::string Builder::build_attributes(const std::shared_ptr<Node> node) {
-	std::stringstream ss;
-	std::string sep = "";
+	BufferSink sink;
+	write_attributes(*node, sink);
+	return sink.take();
+}
 
-	ss << "(";
-	for (auto &e : node->get_attr_keys()) {
-		ss << sep;
-		sep = ", ";
-		ss << e << ": " << build_value(node->get_attr(e));
+/**
+ * @brief Writes an Element at the given level of indentation.
+ * 
+ * @param element The Element to write.
+ * @param sink The output.
+ * @param level The level of indentation.
+ */
+void Builder::write_element(const Element &element, Sink &sink, unsigned level) const {
+	switch (element.get_element_type()) {
+	case Element::NODE:
+		write_node(static_cast<const Node &>(element), sink, 0);
+		break;
+
+	case Element::DATA:
+		write_indent(sink, level);
+		write_value(static_cast<const Data &>(element).get_value(), sink);
+		break;
+
+	default:
+		write_indent(sink, level);
+		sink.write("/*");
+		sink.write(static_cast<const Comment &>(element).string);
+		sink.write("*/");
 	}
-	ss << ")";
+}
+
+/**
+ * @brief Writes a Node and its children.
+ * The nested nodes are followed with an explicit stack, so any depth is supported.
+ * 
+ * @param root The Node to write.
+ * @param sink The output.
+ * @param level The level of indentation.
+ */
+void Builder::write_node(const Node &root, Sink &sink, unsigned level) const {
+	// Open node and position of its next child
+	struct Frame {
+		const Node *node;
+		size_t next;
+	};
+
+	std::string_view separator = format ? "\n" : " ";
+	std::vector<Frame> stack;
+	const Node *node = &root;
+
+	for (;;) {
+		write_indent(sink, level + stack.size());
+		sink.write(node->name);
+
+		if (!node->attrs.empty()) write_attributes(*node, sink);
 
-	return ss.str();
+		if (!node->children.empty()) {
+			sink.write(format ? " {\n" : " { ");
+			stack.push_back(Frame{node, 0});
+		} else if (stack.empty()) {
+			return;
+		} else {
+			sink.write(separator);
+		}
+
+		// Write children up to the next nested node, closing the ended ones:
+		node = nullptr;
+		while (!node) {
+			Frame &frame = stack.back();
+			if (frame.next == frame.node->children.size()) {
+				stack.pop_back();
+				write_indent(sink, level + stack.size());
+				sink.write("}");
+				if (stack.empty()) return;
+				sink.write(separator);
+				continue;
+			}
+
+			const Element &child = *frame.node->children[frame.next++];
+			if (child.get_element_type() == Element::NODE) {
+				node = static_cast<const Node *>(&child);
+			} else {
+				write_element(child, sink, level + stack.size());
+				sink.write(separator);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Writes the attribute list of a Node.
+ * 
+ * @param node The Node to write.
+ * @param sink The output.
+ */
+void Builder::write_attributes(const Node &node, Sink &sink) const {
+	std::string_view sep = "";
+
+	sink.write("(");
+	for (auto &attribute : node.attrs) {
+		sink.write(sep);
+		sep = ", ";
+		sink.write(attribute.first);
+		sink.write(": ");
+		write_value(attribute.second, sink);
+	}
+	sink.write(")");
 }
 
 /**
- * @brief Gets the current indentation based on the builder's level.
+ * @brief Writes a Value.
+ * Strings are quoted with '"', or with '\'' if they contain a '"'. Strings
+ * containing both quotes are written without their '"'.
  * 
- * @return const std::string The current indentation.
+ * @param value The Value to write.
+ * @param sink The output.
  */
-const std::string Builder::indent() const {
-	if (!format) return "";
-	if (!level) return "";
-	std::stringstream ss;
-	std::string ind(space_count, ' ');
-
-	for (int i = 0; i < level; i++) {
-		if (use_spaces) ss << ind;	
-		else ss << "\t";
+void Builder::write_value(const Value &value, Sink &sink) const {
+	if (value.get_type() != Value::STRING) {
+		char buffer[Value::TEXT_SIZE];
+		sink.write(buffer, value.to_chars(buffer) - buffer);
+		return;
 	}
 
-	return ss.str();
+	std::string_view string = value.get_string();
+	bool dbl = (string.find('\"') != std::string_view::npos);
+	bool sgl = (string.find('\'') != std::string_view::npos);
+
+	if (dbl && sgl) {
+		// remove all '"'
+		sink.write("\"");
+		size_t start = 0, quote;
+		while ((quote = string.find('\"', start)) != std::string_view::npos) {
+			sink.write(string.substr(start, quote - start));
+			start = quote + 1;
+		}
+		sink.write(string.substr(start));
+		sink.write("\"");
+		return;
+	}
+
+	const char *quote = dbl ? "\'" : "\"";
+	sink.write(quote);
+	sink.write(string);
+	sink.write(quote);
+}
+
+/**
+ * @brief Writes the indentation of a level.
+ * The indentation is written by chunks of a constant run, so a Builder can
+ * be shared by concurrent writers.
+ * 
+ * @param sink The output.
+ * @param level The level of indentation.
+ */
+void Builder::write_indent(Sink &sink, unsigned level) const {
+	if (!format || !level) return;
+
+	static const std::string tabs(64, '\t');
+	static const std::string spaces(64, ' ');
+
+	const std::string &run = use_spaces ? spaces : tabs;
+	size_t size = static_cast<size_t>(level) * (use_spaces ? space_count : 1);
+	while (size > 0) {
+		size_t chunk = std::min(size, run.size());
+		sink.write(run.data(), chunk);
+		size -= chunk;
+	}
 }
 
 } // namespace dfml
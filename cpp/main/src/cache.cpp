@@ -0,0 +1,329 @@
+/**
+ * @file cache.cpp
+ * @brief Implementation of the Cache class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-13
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/cache.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <dfml/binary.h>
+#include <dfml/comment.h>
+#include <dfml/data.h>
+#include <dfml/document.h>
+#include <dfml/handler.h>
+#include <dfml/mapped_file.h>
+#include <dfml/node.h>
+#include <dfml/parser.h>
+#include <dfml/sink.h>
+#include <dfml/tape.h>
+
+namespace dfml {
+
+namespace {
+
+/**
+ * @brief Handler reporting the events to two handlers.
+ */
+class TeeHandler : public Handler {
+public:
+	TeeHandler(Handler &first, Handler &second) : first(first), second(second) {}
+
+	void on_node_begin(std::string_view name) override {
+		first.on_node_begin(name);
+		second.on_node_begin(name);
+	}
+
+	void on_attribute(std::string_view key, const Value &value) override {
+		first.on_attribute(key, value);
+		second.on_attribute(key, value);
+	}
+
+	void on_data(const Value &value) override {
+		first.on_data(value);
+		second.on_data(value);
+	}
+
+	void on_comment(std::string_view text) override {
+		first.on_comment(text);
+		second.on_comment(text);
+	}
+
+	void on_node_end() override {
+		first.on_node_end();
+		second.on_node_end();
+	}
+
+private:
+	Handler &first;  /**< First receiver of the events. */
+	Handler &second; /**< Second receiver of the events. */
+};
+
+/**
+ * @brief Reports elements and their descendants to a handler, as parsed.
+ * The nested nodes are followed with an explicit stack, so any depth is
+ * supported.
+ *
+ * @param elements The top level elements.
+ * @param handler The handler that receives the events.
+ */
+void report(const std::list<std::shared_ptr<Element>> &elements, Handler &handler) {
+	// Children of an open node and position of the next one
+	struct Frame {
+		ChildRange children;
+		size_t next;
+	};
+
+	std::vector<Frame> stack;
+	for (auto &top : elements) {
+		const Element *current = top.get();
+		for (;;) {
+			switch (current->get_element_type()) {
+			case Element::NODE: {
+				auto &node = static_cast<const Node &>(*current);
+				handler.on_node_begin(node.get_name());
+				for (auto &attribute : node.get_attributes()) handler.on_attribute(attribute.first, attribute.second);
+				stack.push_back(Frame{node.get_children(), 0});
+				break;
+			}
+
+			case Element::DATA:
+				handler.on_data(static_cast<const Data &>(*current).get_value());
+				break;
+
+			default:
+				handler.on_comment(static_cast<const Comment &>(*current).get_string());
+			}
+
+			// Next child, ending the nodes without more children
+			current = nullptr;
+			while (!current && !stack.empty()) {
+				Frame &frame = stack.back();
+				if (frame.next < frame.children.size()) {
+					current = frame.children[frame.next++].get();
+				} else {
+					handler.on_node_end();
+					stack.pop_back();
+				}
+			}
+			if (!current) break;
+		}
+	}
+}
+
+} // namespace
+
+/**
+ * @brief Constructor for the Cache class. Creates the directory if needed.
+ *
+ * @param directory The cache directory.
+ * @throws std::runtime_error If the directory cannot be created.
+ */
+Cache::Cache(const std::string directory) : directory(directory) {
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (!std::filesystem::is_directory(directory, error)) {
+		throw std::runtime_error("Cannot create the cache directory: " + directory);
+	}
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a Cache instance.
+ *
+ * @param directory The cache directory.
+ * @return std::shared_ptr<Cache> Shared pointer to the new Cache instance.
+ * @throws std::runtime_error If the directory cannot be created.
+ */
+std::shared_ptr<Cache> Cache::create(const std::string directory) {
+	return std::make_shared<Cache>(directory);
+}
+
+/**
+ * @brief Loads a DFML file and returns its top level elements.
+ *
+ * @param path Path of the DFML file.
+ * @return std::list<std::shared_ptr<Element>> The elements.
+ * @throws std::runtime_error If the file cannot be read.
+ * @throws ParserException If the file is not valid DFML.
+ */
+std::list<std::shared_ptr<Element>> Cache::load(const std::string path) {
+	std::optional<TreeHandler> tree;
+
+	load(path, [&tree](bool) -> Handler & { return tree.emplace(); });
+
+	return std::move(tree->get_elements());
+}
+
+/**
+ * @brief Loads a DFML file into a Document.
+ *
+ * @param path Path of the DFML file.
+ * @return std::shared_ptr<Document> The document.
+ * @throws std::runtime_error If the file cannot be read.
+ * @throws ParserException If the file is not valid DFML.
+ */
+std::shared_ptr<Document> Cache::load_document(const std::string path) {
+	std::shared_ptr<Document> document;
+	std::optional<TreeHandler> tree;
+
+	load(path, [&document, &tree](bool) -> Handler & {
+		tree.reset();
+		document = Document::create();
+		return tree.emplace(document.get());
+	});
+
+	return document;
+}
+
+/**
+ * @brief Loads a DFML file into a Tape.
+ *
+ * @param path Path of the DFML file.
+ * @return std::shared_ptr<Tape> The tape.
+ * @throws std::runtime_error If the file cannot be read.
+ * @throws ParserException If the file is not valid DFML.
+ */
+std::shared_ptr<Tape> Cache::load_tape(const std::string path) {
+	std::optional<TapeHandler> tape;
+
+	load(path, [&tape](bool) -> Handler & { return tape.emplace(); });
+
+	return tape->get_tape();
+}
+
+/**
+ * @brief Loads a DFML file reporting each element to the handler.
+ * On a hit the entry is decoded into elements first, so a corrupt entry
+ * reports nothing before the file is parsed. On a miss the events of the
+ * parse go straight to the handler.
+ *
+ * @param path Path of the DFML file.
+ * @param handler The handler that receives the events.
+ * @throws std::runtime_error If the file cannot be read.
+ * @throws ParserException If the file is not valid DFML.
+ */
+void Cache::load(const std::string path, Handler &handler) {
+	std::optional<TreeHandler> tree;
+
+	load(path, [&tree, &handler](bool decode) -> Handler & {
+		if (decode) return tree.emplace();
+		tree.reset();
+		return handler;
+	});
+
+	if (tree) report(tree->get_elements(), handler);
+}
+
+/**
+ * @brief Loads a DFML file into a handler made for the load.
+ * On a hit the entry is decoded once into the handler. An entry that
+ * cannot be read or decoded is removed, and the load is a miss: the text
+ * is parsed into a handler made again, feeding the encoder of the new
+ * entry too.
+ *
+ * @param path Path of the DFML file.
+ * @param make Makes the handler, given true to decode an entry, false to
+ * parse the file.
+ * @throws std::runtime_error If the file cannot be read.
+ * @throws ParserException If the file is not valid DFML.
+ */
+void Cache::load(const std::string path, const std::function<Handler &(bool)> &make) {
+	auto start = std::chrono::steady_clock::now();
+	auto source = MappedFile::open(path);
+	std::string entry = entry_path(source->view());
+
+	std::error_code error;
+	if (std::filesystem::is_regular_file(entry, error)) {
+		try {
+			auto cached = MappedFile::open(entry);
+			BinaryDecoder(cached->view()).decode(make(true));
+
+			auto time = std::chrono::steady_clock::now() - start;
+			hits++;
+			hit_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+			return;
+		} catch (const std::exception &) {
+			std::filesystem::remove(entry, error);
+		}
+	}
+
+	Handler &handler = make(false);
+	std::string temporary = entry + "." + std::to_string(std::random_device()()) + ".tmp";
+	std::ofstream stream(temporary, std::ios::binary);
+	StreamSink sink(stream);
+	BinaryEncoder encoder(sink);
+	TeeHandler tee(handler, encoder);
+
+	try {
+		Parser(source).parse(tee);
+		encoder.finish();
+	} catch (...) {
+		stream.close();
+		std::filesystem::remove(temporary, error);
+		throw;
+	}
+
+	// An entry that cannot be written only costs the next load a parse
+	stream.close();
+	if (!stream || std::rename(temporary.c_str(), entry.c_str()) != 0) {
+		std::filesystem::remove(temporary, error);
+	}
+
+	auto time = std::chrono::steady_clock::now() - start;
+	misses++;
+	miss_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+}
+
+/**
+ * @brief Gets the statistics of the loads so far.
+ *
+ * @return Stats The statistics.
+ */
+Cache::Stats Cache::get_stats() const {
+	return Stats{hits, misses, hit_nanoseconds / 1e9, miss_nanoseconds / 1e9};
+}
+
+/**
+ * @brief Gets the 64 bit FNV-1a hash of some data.
+ *
+ * @param data The data.
+ * @return uint64_t The hash.
+ */
+uint64_t Cache::hash(std::string_view data) {
+	uint64_t hash = 0xcbf29ce484222325;
+
+	for (unsigned char ch : data) {
+		hash ^= ch;
+		hash *= 0x100000001b3;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief Gets the path of the cache entry of some source data.
+ * The name has the hash and the size of the data.
+ *
+ * @param data The source data.
+ * @return std::string Path of the entry.
+ */
+std::string Cache::entry_path(std::string_view data) const {
+	char name[48];
+	std::snprintf(name, sizeof(name), "%016llx-%llu.dfmb",
+			static_cast<unsigned long long>(hash(data)), static_cast<unsigned long long>(data.size()));
+	return (std::filesystem::path(directory) / name).string();
+}
+
+} // namespace dfml
@@ -0,0 +1,143 @@
+/**
+ * @file document.cpp
+ * @brief Implementation of the Document class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-02
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/document.h>
+
+#include <dfml/node.h>
+#include <dfml/data.h>
+#include <dfml/comment.h>
+#include <dfml/value.h>
+#include <dfml/name_index.h>
+
+namespace dfml {
+
+namespace {
+
+/**
+ * @brief Arena type of the documents.
+ */
+using Arena = std::pmr::monotonic_buffer_resource;
+
+/**
+ * @brief Allocator of the elements of a document, sharing its arena.
+ * The allocator is kept in the control block of the element, so the arena
+ * is released after the document and its last element.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	ArenaAllocator(const std::shared_ptr<Arena> &arena) : arena(arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+	T *allocate(size_t count) {
+		return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *p, size_t count) {
+		arena->deallocate(p, count * sizeof(T), alignof(T));
+	}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+
+	std::shared_ptr<Arena> arena; /**< Arena of the document. */
+};
+
+} // namespace
+
+/**
+ * @brief Constructor for the Document class.
+ *
+ * @param block_size Size of the first arena block, 0 for the default.
+ */
+Document::Document(size_t block_size)
+		: arena(std::make_shared<Arena>(block_size ? block_size : 4096)), elements(arena.get()) {}
+
+/**
+ * @brief Destructor for the Document class.
+ * Destroys the elements before releasing the arena, unless some of them are
+ * still referenced.
+ */
+Document::~Document() {
+	index.reset();
+	elements.clear();
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a Document instance.
+ *
+ * @param block_size Size of the first arena block, 0 for the default.
+ * @return std::shared_ptr<Document> Shared pointer to the new Document instance.
+ */
+std::shared_ptr<Document> Document::create(size_t block_size) {
+	return std::make_shared<Document>(block_size);
+}
+
+/**
+ * @brief Adds a top level element, to the index too if there is one.
+ *
+ * @param element The element to add.
+ */
+void Document::add_element(std::shared_ptr<Element> element) {
+	elements.push_back(std::move(element));
+	if (index) index->add(*elements.back());
+}
+
+/**
+ * @brief Creates the name index of the document, with the current elements.
+ *
+ * @return NameIndex& The index.
+ */
+NameIndex &Document::create_index() {
+	if (!index) {
+		index = std::make_unique<NameIndex>();
+		for (auto &element : elements) index->add(*element);
+	}
+	return *index;
+}
+
+/**
+ * @brief Creates a Node in the arena of the document.
+ *
+ * @param name The name of the node.
+ * @return std::shared_ptr<Node> Shared pointer to the new Node.
+ */
+std::shared_ptr<Node> Document::create_node(std::string_view name) {
+	return std::allocate_shared<Node>(ArenaAllocator<Node>(arena), name, arena.get());
+}
+
+/**
+ * @brief Creates a Data in the arena of the document.
+ *
+ * @param value The value of the data, copied to the arena.
+ * @return std::shared_ptr<Data> Shared pointer to the new Data.
+ */
+std::shared_ptr<Data> Document::create_data(const Value &value) {
+	return std::allocate_shared<Data>(ArenaAllocator<Data>(arena), value, arena.get());
+}
+
+/**
+ * @brief Creates a Comment in the arena of the document.
+ *
+ * @param string The content of the comment.
+ * @return std::shared_ptr<Comment> Shared pointer to the new Comment.
+ */
+std::shared_ptr<Comment> Document::create_comment(std::string_view string) {
+	return std::allocate_shared<Comment>(ArenaAllocator<Comment>(arena), string, arena.get());
+}
+
+} // namespace dfml
@@ -0,0 +1,57 @@
+/**
+ * @file element.cpp
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of the Element class in the context of the Dragonfly Markup Language (DFML).
+ * @date 2024-01-13
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#include <dfml/element.h>
+#include <dfml/node.h>
+
+#include <vector>
+
+namespace dfml {
+
+/**
+ * @brief Moves to the parent of the current ancestor.
+ * 
+ * @return Iterator& This iterator.
+ */
+AncestorRange::Iterator &AncestorRange::Iterator::operator++() {
+	node = node->get_parent();
+	return *this;
+}
+
+/**
+ * @brief Gets the count of ancestors of the element.
+ * 
+ * @return size_t The depth, 0 at the top level.
+ */
+size_t Element::depth() const {
+	size_t depth = 0;
+	for (Node *node = parent; node; node = node->get_parent()) depth++;
+	return depth;
+}
+
+/**
+ * @brief Gets the names of the nodes from the root down to the element.
+ * 
+ * @return std::string The path, as "/root/child/node".
+ */
+std::string Element::path() const {
+	std::vector<const Node *> nodes;
+	if (get_element_type() == NODE) nodes.push_back(static_cast<const Node *>(this));
+	for (Node *node : ancestors()) nodes.push_back(node);
+
+	std::string path;
+	for (auto it = nodes.rbegin(); it != nodes.rend(); it++) {
+		path += '/';
+		path += (*it)->get_name();
+	}
+	return path.empty() ? "/" : path;
+}
+
+} // namespace dfml
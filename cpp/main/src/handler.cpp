@@ -0,0 +1,84 @@
+/**
+ * @file handler.cpp
+ * @brief Implementation of the TreeHandler class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-03
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/handler.h>
+
+#include <dfml/node.h>
+#include <dfml/data.h>
+#include <dfml/comment.h>
+#include <dfml/document.h>
+#include <dfml/value.h>
+
+#include <utility>
+
+namespace dfml {
+
+/**
+ * @brief Creates the node and makes it the current one.
+ *
+ * @param name The name of the node.
+ */
+void TreeHandler::on_node_begin(std::string_view name) {
+	auto node = document ? document->create_node(name) : Node::create(std::string(name));
+	add(node);
+	nodes.push_back(std::move(node));
+}
+
+/**
+ * @brief Sets the attribute on the current node.
+ *
+ * @param key The key of the attribute.
+ * @param value The value of the attribute.
+ */
+void TreeHandler::on_attribute(std::string_view key, const Value &value) {
+	nodes.back()->set_attribute(key, value);
+}
+
+/**
+ * @brief Adds a Data element.
+ *
+ * @param value The value of the data.
+ */
+void TreeHandler::on_data(const Value &value) {
+	if (document) add(document->create_data(value));
+	else add(Data::create(value));
+}
+
+/**
+ * @brief Adds a Comment element.
+ *
+ * @param text The content of the comment.
+ */
+void TreeHandler::on_comment(std::string_view text) {
+	if (document) add(document->create_comment(text));
+	else add(Comment::create(std::string(text)));
+}
+
+/**
+ * @brief Closes the current node.
+ */
+void TreeHandler::on_node_end() {
+	nodes.pop_back();
+}
+
+/**
+ * @brief Adds an element to the current node, or to the top level.
+ *
+ * @param element The element to add.
+ */
+void TreeHandler::add(std::shared_ptr<Element> element) {
+	if (nodes.empty()) {
+		if (document) document->add_element(std::move(element));
+		else elements.push_back(std::move(element));
+	}
+	else nodes.back()->add_child(std::move(element));
+}
+
+} // namespace dfml
@@ -0,0 +1,130 @@
+/**
+ * @file loader.cpp
+ * @brief Implementation of the load_files() function in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/loader.h>
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <dfml/cache.h>
+#include <dfml/mapped_file.h>
+#include <dfml/parser.h>
+#include <dfml/thread_pool.h>
+
+namespace dfml {
+
+namespace {
+
+/**
+ * @brief Mapping of a file of the batch, made once by whichever load needs
+ * it first: its own, or the read ahead of the previous file.
+ */
+struct Mapping {
+	std::once_flag once;               /**< Maps the file once. */
+	std::shared_ptr<MappedFile> file;  /**< Mapped file, until its load takes it. */
+};
+
+/**
+ * @brief Maps a file of the batch and asks the kernel to read it ahead.
+ *
+ * @param mapping Mapping of the file.
+ * @param path Path of the file.
+ * @throws std::runtime_error If the file cannot be mapped.
+ */
+void read_ahead(Mapping &mapping, const std::string &path) {
+	std::call_once(mapping.once, [&mapping, &path]() {
+		mapping.file = MappedFile::open(path);
+		mapping.file->will_need();
+	});
+}
+
+/**
+ * @brief Loads one file, keeping the error in its result.
+ * The next file is read ahead before this one is parsed.
+ *
+ * @param results The results of the batch.
+ * @param mappings Mappings of the files of the batch.
+ * @param n Position of the file.
+ * @param cache Cache to load the file through, or nullptr.
+ */
+void load_file(LoadResults &results, std::vector<Mapping> &mappings, size_t n, Cache *cache) {
+	FileResult &result = results.files[n];
+	try {
+		read_ahead(mappings[n], result.path);
+		auto file = std::move(mappings[n].file);
+
+		if (n + 1 < mappings.size()) {
+			// Its load reports the error
+			try { read_ahead(mappings[n + 1], results.files[n + 1].path); } catch (...) {}
+		}
+
+		result.size = file->size();
+		if (cache) result.elements = cache->load(result.path);
+		else result.elements = Parser(file).parse();
+	} catch (...) {
+		result.elements.clear();
+		result.error = std::current_exception();
+		try {
+			throw;
+		} catch (const std::exception &e) {
+			result.message = e.what();
+		} catch (...) {
+			result.message = "Unknown error";
+		}
+	}
+}
+
+} // namespace
+
+/**
+ * @brief Loads a batch of DFML files concurrently.
+ *
+ * @param paths Paths of the files.
+ * @param options Pool and cache to use.
+ * @return LoadResults The result of each file and the totals.
+ */
+LoadResults load_files(const std::vector<std::string> &paths, const LoadOptions &options) {
+	auto start = std::chrono::steady_clock::now();
+	LoadResults results;
+
+	results.files.resize(paths.size());
+	for (size_t n = 0; n < paths.size(); n++) results.files[n].path = paths[n];
+	std::vector<Mapping> mappings(paths.size());
+
+	std::unique_ptr<ThreadPool> temporary;
+	ThreadPool *pool = options.pool;
+	if (!pool) {
+		temporary = std::make_unique<ThreadPool>(options.threads);
+		pool = temporary.get();
+	}
+
+	std::vector<std::future<void>> done;
+	done.reserve(paths.size());
+	for (size_t n = 0; n < paths.size(); n++) {
+		done.push_back(pool->submit([&results, &mappings, n, &options]() {
+			load_file(results, mappings, n, options.cache);
+		}));
+	}
+	for (auto &task : done) task.get();
+
+	for (auto &file : results.files) {
+		if (file.ok()) results.bytes += file.size;
+		else results.failures++;
+	}
+	results.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return results;
+}
+
+} // namespace dfml
@@ -0,0 +1,89 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Implementation of the MappedFile class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-03
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/mapped_file.h>
+
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DFML_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace dfml {
+
+/**
+ * @brief Maps the given file in read-only mode.
+ *
+ * @param path Path of the file to map.
+ * @return std::shared_ptr<MappedFile> Shared pointer to the new MappedFile instance.
+ */
+std::shared_ptr<MappedFile> MappedFile::open(const std::string path) {
+	auto file = std::shared_ptr<MappedFile>(new MappedFile());
+
+#ifdef DFML_HAS_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) throw std::runtime_error("Unable to open file: " + path);
+
+	struct stat st;
+	if (::fstat(fd, &st) == -1) {
+		::close(fd);
+		throw std::runtime_error("Unable to stat file: " + path);
+	}
+
+	// Empty files can't be mapped: leave the view empty.
+	if (st.st_size > 0) {
+		void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED) {
+			::close(fd);
+			throw std::runtime_error("Unable to map file: " + path);
+		}
+		file->bytes = static_cast<const char *>(addr);
+		file->length = st.st_size;
+	}
+	::close(fd);
+#else
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream) throw std::runtime_error("Unable to open file: " + path);
+
+	file->buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	file->bytes = file->buffer.data();
+	file->length = file->buffer.size();
+#endif
+
+	return file;
+}
+
+/**
+ * @brief Asks the kernel to read the whole file ahead, without waiting.
+ * Does nothing where mmap() is unavailable, as the file is already read.
+ */
+void MappedFile::will_need() const {
+#ifdef DFML_HAS_MMAP
+	if (bytes) ::posix_madvise(const_cast<char *>(bytes), length, POSIX_MADV_WILLNEED);
+#endif
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+MappedFile::~MappedFile() {
+#ifdef DFML_HAS_MMAP
+	if (bytes) ::munmap(const_cast<char *>(bytes), length);
+#endif
+}
+
+} // namespace dfml
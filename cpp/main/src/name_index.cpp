@@ -0,0 +1,342 @@
+/**
+ * @file name_index.cpp
+ * @brief Implementation of the NameIndex class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-13
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/name_index.h>
+#include <dfml/node.h>
+
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+namespace dfml {
+
+namespace {
+
+/**
+ * @brief Empty list returned for missing names and keys.
+ */
+const NameIndex::Nodes no_nodes;
+
+/**
+ * @brief Visits a node and its descendant nodes in document order.
+ * An explicit stack is used, so any depth is supported.
+ */
+template <typename Visit>
+void walk(Node &root, Visit visit) {
+	// New nodes, as added by the parser, have no children yet
+	if (root.get_children().empty()) {
+		visit(root);
+		return;
+	}
+
+	std::vector<Node *> stack{&root};
+	while (!stack.empty()) {
+		Node *node = stack.back();
+		stack.pop_back();
+		visit(*node);
+
+		auto children = node->get_children();
+		for (size_t n = children.size(); n > 0; n--) {
+			if (children[n - 1]->get_element_type() == Element::NODE) {
+				stack.push_back(static_cast<Node *>(children[n - 1].get()));
+			}
+		}
+	}
+}
+
+} // namespace
+
+/**
+ * @brief Destructor for the NameIndex class.
+ * Clears the link to the index of the indexed nodes.
+ */
+NameIndex::~NameIndex() {
+	clear();
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a NameIndex instance.
+ *
+ * @return std::shared_ptr<NameIndex> Shared pointer to the new instance.
+ */
+std::shared_ptr<NameIndex> NameIndex::create() {
+	return std::make_shared<NameIndex>();
+}
+
+/**
+ * @brief Adds an element and its descendants to the index.
+ *
+ * @param element The element to add.
+ */
+void NameIndex::add(Element &element) {
+	if (element.get_element_type() != Element::NODE) return;
+	Node &root = static_cast<Node &>(element);
+	if (!root.get_parent() && root.index != this) roots.push_back(&root);
+
+	walk(root, [this](Node &node) {
+		if (node.index == this) return;
+		node.index = this;
+
+		// Nodes added in document order go at the end of every list
+		if (!count || (tail && precedes(tail, &node))) tail = &node;
+		count++;
+
+		insert(names, node.name, &node);
+		for (auto &attribute : node.attrs) insert(keys, attribute.first, &node);
+	});
+}
+
+/**
+ * @brief Adds top level elements and their descendants to the index.
+ *
+ * @param elements The elements to add.
+ */
+void NameIndex::add(const std::list<std::shared_ptr<Element>> &elements) {
+	for (auto &element : elements) add(*element);
+}
+
+/**
+ * @brief Removes an element and its descendants from the index.
+ *
+ * @param element The element to remove.
+ */
+void NameIndex::remove(Element &element) {
+	if (element.get_element_type() != Element::NODE) return;
+	Node &root = static_cast<Node &>(element);
+	roots.erase(std::remove(roots.begin(), roots.end(), &root), roots.end());
+
+	walk(root, [this](Node &node) {
+		if (node.index != this) return;
+		node.index = nullptr;
+		if (tail == &node) tail = nullptr;
+		count--;
+		erase(names, node.name, &node);
+		for (auto &attribute : node.attrs) erase(keys, attribute.first, &node);
+	});
+}
+
+/**
+ * @brief Removes a node being destroyed, with the descendants destroyed
+ * with it: those not referenced from elsewhere.
+ * A single node is searched in its lists; a subtree is taken out of every
+ * list it is in with one pass per list.
+ *
+ * @param root The node.
+ */
+void NameIndex::forget(Node &root) {
+	if (!root.get_parent()) {
+		auto position = std::find(roots.rbegin(), roots.rend(), &root);
+		if (position != roots.rend()) roots.erase(std::next(position).base());
+	}
+
+	std::vector<Node *> gone;
+	std::vector<Node *> stack{&root};
+	while (!stack.empty()) {
+		Node *node = stack.back();
+		stack.pop_back();
+		if (node->index != this) continue;
+		node->index = nullptr;
+		if (tail == node) tail = nullptr;
+		gone.push_back(node);
+
+		for (auto &child : node->get_children()) {
+			if (child.use_count() == 1 && child->get_element_type() == Element::NODE) {
+				stack.push_back(static_cast<Node *>(child.get()));
+			}
+		}
+	}
+	count -= gone.size();
+
+	if (gone.size() == 1) {
+		erase(names, root.name, &root);
+		for (auto &attribute : root.attrs) erase(keys, attribute.first, &root);
+		return;
+	}
+
+	std::unordered_set<const Node *> removed(gone.begin(), gone.end());
+	std::unordered_set<Nodes *> lists;
+	for (Node *node : gone) {
+		if (auto it = names.find(node->name); it != names.end()) lists.insert(&it->second);
+		for (auto &attribute : node->attrs) {
+			if (auto it = keys.find(attribute.first); it != keys.end()) lists.insert(&it->second);
+		}
+	}
+	for (Nodes *nodes : lists) {
+		nodes->erase(std::remove_if(nodes->begin(), nodes->end(),
+				[&removed](const Node *node) { return removed.count(node) > 0; }), nodes->end());
+	}
+}
+
+/**
+ * @brief Removes every node from the index.
+ */
+void NameIndex::clear() {
+	for (auto &entry : names) {
+		for (Node *node : entry.second) node->index = nullptr;
+	}
+	names.clear();
+	keys.clear();
+	std::fill(std::begin(cache), std::end(cache), Cached());
+	strings.clear();
+	roots.clear();
+	tail = nullptr;
+	count = 0;
+}
+
+/**
+ * @brief Gets the nodes with a name.
+ *
+ * @param name The name of the nodes.
+ * @return const Nodes& The nodes in document order.
+ */
+const NameIndex::Nodes &NameIndex::find_nodes(std::string_view name) const {
+	auto it = names.find(name);
+	return it == names.end() ? no_nodes : it->second;
+}
+
+/**
+ * @brief Gets the nodes with an attribute.
+ *
+ * @param key The key of the attribute.
+ * @return const Nodes& The nodes in document order.
+ */
+const NameIndex::Nodes &NameIndex::find_keys(std::string_view key) const {
+	auto it = keys.find(key);
+	return it == keys.end() ? no_nodes : it->second;
+}
+
+/**
+ * @brief Checks if a node comes before another one in document order.
+ *
+ * @param a The first node.
+ * @param b The second node.
+ * @return true If a comes before b.
+ */
+bool NameIndex::precedes(const Node *a, const Node *b) const {
+	if (a == b) return false;
+	if (b->get_parent() == a) return true;
+
+	// Usual case: a below a sibling of b, as when nodes are added in order
+	for (const Node *x = a; x; x = x->get_parent()) {
+		if (x->get_parent() == b->get_parent()) return x != b && sibling_precedes(x, b);
+	}
+
+	size_t depth_a = a->depth(), depth_b = b->depth();
+	const Node *x = a, *y = b;
+	for (; depth_a > depth_b; depth_a--) x = x->get_parent();
+	for (; depth_b > depth_a; depth_b--) y = y->get_parent();
+
+	// One is an ancestor of the other
+	if (x == y) return x == a;
+
+	while (x->get_parent() != y->get_parent()) {
+		x = x->get_parent();
+		y = y->get_parent();
+	}
+	return sibling_precedes(x, y);
+}
+
+/**
+ * @brief Checks if a node comes before one of its siblings.
+ * The siblings are searched from the last one, where nodes are usually added.
+ *
+ * @param x The first node.
+ * @param y The second node, with the same parent.
+ * @return true If x comes before y.
+ */
+bool NameIndex::sibling_precedes(const Node *x, const Node *y) const {
+	if (const Node *parent = x->get_parent()) {
+		auto children = parent->get_children();
+		for (size_t n = children.size(); n > 0; n--) {
+			const Element *child = children[n - 1].get();
+			if (child == x) return false;
+			if (child == y) return true;
+		}
+	} else {
+		for (size_t n = roots.size(); n > 0; n--) {
+			if (roots[n - 1] == x) return false;
+			if (roots[n - 1] == y) return true;
+		}
+	}
+
+	// Unrelated trees
+	return std::less<const Node *>()(x, y);
+}
+
+/**
+ * @brief Adds a node to the list of a name or key, in document order.
+ * The last node in document order is appended without comparisons, other
+ * nodes after a single comparison when they follow the list.
+ *
+ * @param map The map of names or keys.
+ * @param name The name or key.
+ * @param node The node.
+ */
+void NameIndex::insert(Map &map, std::string_view name, Node *node) {
+	// The few names of a document repeat: most are found in the cache
+	size_t slot = name.empty() ? 0 : name.size() * 31 + name.front() * 7 + name.back();
+	Cached &cached = cache[slot % CACHE_SIZE];
+	if (cached.map != &map || cached.name != name) {
+		auto it = map.find(name);
+		if (it == map.end()) {
+			strings.emplace_back(name);
+			it = map.emplace(strings.back(), Nodes()).first;
+		}
+		cached = Cached{&map, it->first, &it->second};
+	}
+
+	Nodes &nodes = *cached.nodes;
+	if (node == tail || nodes.empty() || precedes(nodes.back(), node)) {
+		nodes.push_back(node);
+	} else {
+		nodes.insert(std::upper_bound(nodes.begin(), nodes.end(), node,
+				[this](const Node *a, const Node *b) { return precedes(a, b); }), node);
+	}
+}
+
+/**
+ * @brief Removes a node from the list of a name or key.
+ * The list is searched from both ends at once, where the first and last
+ * nodes of a document are.
+ *
+ * @param map The map of names or keys.
+ * @param name The name or key.
+ * @param node The node.
+ */
+void NameIndex::erase(Map &map, std::string_view name, Node *node) {
+	auto it = map.find(name);
+	if (it == map.end()) return;
+
+	Nodes &nodes = it->second;
+	for (size_t front = 0, back = nodes.size(); front < back; front++, back--) {
+		if (nodes[front] == node) {
+			nodes.erase(nodes.begin() + front);
+			return;
+		}
+		if (nodes[back - 1] == node) {
+			nodes.erase(nodes.begin() + (back - 1));
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Updates the index after a node is renamed.
+ *
+ * @param node The node, with the new name.
+ * @param old_name The previous name.
+ */
+void NameIndex::rename(Node &node, std::string_view old_name) {
+	erase(names, old_name, &node);
+	insert(names, node.name, &node);
+}
+
+} // namespace dfml
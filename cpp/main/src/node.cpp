@@ -10,12 +10,72 @@
 
 #include <dfml/node.h>
 
-#include <sstream>
+#include <unordered_map>
+#include <utility>
 
 #include <dfml/value.h>
+#include <dfml/name_index.h>
 
 namespace dfml {
 
+namespace {
+
+/**
+ * @brief Child count from which nodes index their children by name.
+ */
+std::atomic<size_t> child_index_threshold{Node::CHILD_INDEX_THRESHOLD};
+
+/**
+ * @brief Gets a child as a node.
+ * 
+ * @param child The child element.
+ * @return Node* The node, or nullptr if the child is not a node.
+ */
+Node *as_node(const std::shared_ptr<Element> &child) {
+	return child->get_element_type() == Element::NODE ? static_cast<Node *>(child.get()) : nullptr;
+}
+
+} // namespace
+
+/**
+ * @brief Index of the children of a node by name.
+ * Each name leads to the position of its first child, and each child to the
+ * position of the next one with the same name, so the children of a name
+ * are followed in order without a list per name.
+ */
+struct Node::ChildIndex {
+	/**
+	 * @brief Positions of the first and last children of a name.
+	 */
+	struct Chain {
+		size_t first; /**< Position of the first child. */
+		size_t last;  /**< Position of the last child. */
+	};
+
+	/**
+	 * @brief Position that ends a chain.
+	 */
+	static constexpr size_t END = static_cast<size_t>(-1);
+
+	/**
+	 * @brief Adds a child at the end of the chain of its name.
+	 * 
+	 * @param name The name of the child, stored in the child.
+	 * @param position Position of the child.
+	 */
+	void add(std::string_view name, size_t position) {
+		next.resize(position + 1, END);
+		auto result = chains.try_emplace(name, Chain{position, position});
+		if (!result.second) {
+			next[result.first->second.last] = position;
+			result.first->second.last = position;
+		}
+	}
+
+	std::unordered_map<std::string_view, Chain> chains; /**< Chains by name. */
+	std::vector<size_t> next; /**< Position of the next child with the same name, by position. */
+};
+
 /**
  * @brief Creates and returns a shared pointer to a Node instance with the specified name.
  * 
@@ -30,22 +90,107 @@ std::shared_ptr<Node> Node::create(const std::string name) {
 
 /**
  * @brief Adds a child element to the node.
+ * An element with a parent is removed from it first, and a top level node
+ * from its name index.
  * 
  * @param element The child element to add.
  */
 void Node::add_child(std::shared_ptr<Element> element) {
-	children.push_back(element);
+	if (Node *previous = element->parent) {
+		// Usually the last child, as when nodes are moved in order
+		size_t position = previous->children.size();
+		while (position > 0 && previous->children[position - 1] != element) position--;
+		previous->remove_child(position - 1);
+	} else if (Node *node = as_node(element); node && node->index) {
+		node->index->remove(*node);
+	}
+
+	element->parent = this;
+	children.push_back(std::move(element));
+	if (index) index->add(*children.back());
+
+	// An index already built follows the new child
+	ChildIndex *built = child_index.load(std::memory_order_relaxed);
+	if (built) {
+		if (Node *node = as_node(children.back())) built->add(node->name, children.size() - 1);
+	}
+}
+
+/**
+ * @brief Removes a child element given its position, clearing its parent.
+ * 
+ * @param index Position of the child, less than child_count().
+ * @return std::shared_ptr<Element> The removed child.
+ */
+std::shared_ptr<Element> Node::remove_child(size_t index) {
+	if (this->index) this->index->remove(*children[index]);
+	drop_child_index();
+	std::shared_ptr<Element> element = std::move(children[index]);
+	children.erase(children.begin() + index);
+	element->parent = nullptr;
+	return element;
+}
+
+/**
+ * @brief Destructor for the Node class.
+ * Leaves the name index, and clears the parent link of the children that
+ * outlive the node. The child nodes freed with it are taken out first and
+ * freed from a local stack, so the destruction of a deep tree doesn't
+ * recurse once per level.
+ */
+Node::~Node() {
+	drop_child_index();
+	if (index) index->forget(*this);
+
+	std::vector<std::shared_ptr<Element>> stack;
+	auto detach = [&stack](Node &node) {
+		for (auto &child : node.children) {
+			if (!child) continue;
+			if (child.use_count() > 1) {
+				if (child->parent == &node) child->parent = nullptr;
+			} else if (child->get_element_type() == Element::NODE) {
+				stack.push_back(std::move(child));
+			}
+		}
+	};
+
+	detach(*this);
+	while (!stack.empty()) {
+		std::shared_ptr<Element> element = std::move(stack.back());
+		stack.pop_back();
+		detach(static_cast<Node &>(*element));
+	}
 }
 
 /**
  * @brief Sets an attribute for the node with the given value.
+ * The value is copied to the memory resource of the node.
  * 
  * @param name The name of the attribute.
  * @param value The value of the attribute.
  */
-void Node::set_attribute(const std::string name, const Value value) {
-	if (!this->has_attr(name)) keys.push_back(name);
-	attrs[name] = value;
+void Node::set_attribute(std::string_view name, const Value &value) {
+	size_t size = attrs.size();
+	attrs.set(name, value);
+	if (index && attrs.size() != size) index->add_key(*this, name);
+}
+
+/**
+ * @brief Sets the name of the node, updating its index and the children
+ * index of its parent.
+ * 
+ * @param name The name to set for the node.
+ */
+void Node::set_name(const std::string name) {
+	if (parent) parent->drop_child_index();
+	if (!index) {
+		this->name.assign(name);
+		return;
+	}
+
+	std::string old_name(this->name);
+	this->name.assign(name);
+	index->rename(*this, old_name);
 }
 
 /**
@@ -54,12 +199,10 @@ void Node::set_attribute(const std::string name, const Value value) {
  * @param name The name of the attribute.
  * @param value The value of the attribute as a string.
  */
-void Node::set_attr_string(const std::string name, const std::string value) {
+void Node::set_attr_string(std::string_view name, const std::string value) {
 	auto val = Value();
 	val.set_string(value);
-
-	if (!this->has_attr(name)) keys.push_back(name);
-	attrs[name] = val;
+	set_attribute(name, val);
 }
 
 /**
@@ -68,12 +211,10 @@ void Node::set_attr_string(const std::string name, const std::string value) {
  * @param name The name of the attribute.
  * @param value The value of the attribute as an integer.
  */
-void Node::set_attr_integer(const std::string name, long value) {
+void Node::set_attr_integer(std::string_view name, long value) {
 	auto val = Value();
 	val.set_integer(value);
-
-	if (!this->has_attr(name)) keys.push_back(name);
-	attrs[name] = val;
+	set_attribute(name, val);
 }
 
 /**
@@ -82,12 +223,10 @@ void Node::set_attr_integer(const std::string name, long value) {
  * @param name The name of the attribute.
  * @param value The value of the attribute as a double.
  */
-void Node::set_attr_double(const std::string name, double value) {
+void Node::set_attr_double(std::string_view name, double value) {
 	auto val = Value();
 	val.set_double(value);
-
-	if (!this->has_attr(name)) keys.push_back(name);
-	attrs[name] = val;
+	set_attribute(name, val);
 }
 
 /**
@@ -96,22 +235,22 @@ void Node::set_attr_double(const std::string name, double value) {
  * @param name The name of the attribute.
  * @param value The value of the attribute as a boolean.
  */
-void Node::set_attr_boolean(const std::string name, bool value) {
+void Node::set_attr_boolean(std::string_view name, bool value) {
 	auto val = Value();
 	val.set_boolean(value);
-
-	if (!this->has_attr(name)) keys.push_back(name);
-	attrs[name] = val;
+	set_attribute(name, val);
 }
 
 /**
  * @brief Gets the value of an attribute given its name.
+ * A missing attribute is added as an empty string.
  * 
  * @param name The name of the attribute.
  * @return const Value & Attribute's value reference.
  */
-Value &Node::get_attr(const std::string name) {
-	return attrs[name];
+Value &Node::get_attr(std::string_view name) {
+	if (index && !attrs.contains(name)) index->add_key(*this, name);
+	return attrs.get(name);
 }
 
 /**
@@ -121,12 +260,111 @@ Value &Node::get_attr(const std::string name) {
  * @return true If the node has the attribute.
  * @return false If the node does not have the attribute.
  */
-bool Node::has_attr(const std::string name) {
-	for (auto &k : keys) {
-		if (k == name) return true;
+bool Node::has_attr(std::string_view name) const {
+	return attrs.contains(name);
+}
+
+/**
+ * @brief Gets the value of an attribute, or a fallback if it is missing.
+ * 
+ * @param name The name of the attribute.
+ * @param fallback The value returned for a missing attribute.
+ * @return const Value & The attribute's value, or the fallback.
+ */
+const Value &Node::get_attr_or(std::string_view name, const Value &fallback) const {
+	const Value *value = attrs.find(name);
+	return value ? *value : fallback;
+}
+
+/**
+ * @brief Finds the first child node with a name.
+ * 
+ * @param name The name of the child.
+ * @return Node* The child, or nullptr if there is none.
+ */
+Node *Node::find_child(std::string_view name) const {
+	if (const ChildIndex *built = get_child_index()) {
+		auto it = built->chains.find(name);
+		return it == built->chains.end() ? nullptr : static_cast<Node *>(children[it->second.first].get());
 	}
 
-	return false;
+	for (auto &child : children) {
+		Node *node = as_node(child);
+		if (node && std::string_view(node->name) == name) return node;
+	}
+	return nullptr;
+}
+
+/**
+ * @brief Finds the child nodes with a name.
+ * 
+ * @param name The name of the children.
+ * @return std::vector<Node *> The children in order.
+ */
+std::vector<Node *> Node::find_children(std::string_view name) const {
+	std::vector<Node *> found;
+	if (const ChildIndex *built = get_child_index()) {
+		auto it = built->chains.find(name);
+		if (it == built->chains.end()) return found;
+		for (size_t n = it->second.first; n != ChildIndex::END; n = built->next[n]) {
+			found.push_back(static_cast<Node *>(children[n].get()));
+		}
+		return found;
+	}
+
+	for (auto &child : children) {
+		Node *node = as_node(child);
+		if (node && std::string_view(node->name) == name) found.push_back(node);
+	}
+	return found;
+}
+
+/**
+ * @brief Sets the child count from which nodes index their children by name.
+ * 
+ * @param count The child count.
+ */
+void Node::set_child_index_threshold(size_t count) {
+	child_index_threshold.store(count, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Gets the child count from which nodes index their children by name.
+ * 
+ * @return size_t The child count.
+ */
+size_t Node::get_child_index_threshold() {
+	return child_index_threshold.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Gets the index of the children by name, building it for wide nodes.
+ * Concurrent readers may build it at once: the first one published is kept,
+ * the others are discarded.
+ * 
+ * @return const ChildIndex* The index, or nullptr if the node is scanned.
+ */
+const Node::ChildIndex *Node::get_child_index() const {
+	ChildIndex *built = child_index.load(std::memory_order_acquire);
+	if (built || children.size() < get_child_index_threshold()) return built;
+
+	auto fresh = std::make_unique<ChildIndex>();
+	fresh->chains.reserve(children.size());
+	for (size_t n = 0; n < children.size(); n++) {
+		if (Node *node = as_node(children[n])) fresh->add(node->name, n);
+	}
+
+	if (child_index.compare_exchange_strong(built, fresh.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+		return fresh.release();
+	}
+	return built;
+}
+
+/**
+ * @brief Discards the index of the children by name.
+ */
+void Node::drop_child_index() {
+	delete child_index.exchange(nullptr, std::memory_order_relaxed);
 }
 
 } // namespace dfml
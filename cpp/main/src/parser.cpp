@@ -8,116 +8,427 @@
  */
 
 #include <dfml/parser.h>
-#include <dfml/node.h>
-#include <dfml/data.h>
-#include <dfml/comment.h>
+#include <dfml/handler.h>
+#include <dfml/value.h>
+#include <dfml/mapped_file.h>
+#include <dfml/document.h>
+#include <dfml/tape.h>
+#include <dfml/thread_pool.h>
+#include "scanner.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 
 namespace dfml {
 
+/**
+ * @brief Builds the message of the error, as thrown by ParserException.
+ * @return The message.
+ */
+std::string ParseError::get_message() const {
+	std::string line = std::to_string(this->line);
+
+	switch (code) {
+	case NONE: return "No error";
+	case INVALID_CHILD: return "Invalid character for node child on line: " + line;
+	case EMPTY_NODE_NAME: return "Empty node name encountered on line: " + line;
+	case DOUBLE_ATTRIBUTE_LIST: return "Double attribute list found in the node on line: " + line;
+	case UNEXPECTED_SEPARATOR: return "Unexpected attribute pair separator ',': " + line;
+	case INVALID_DOUBLE: return "Double conversion error on line: " + line;
+	case INVALID_INTEGER: return "Integer conversion error on line: " + line;
+	case INVALID_BOOLEAN: return "Boolean conversion error on line: " + line;
+	case INVALID_COMMENT: return "Unexpected comment termination on line: " + line;
+	case MAX_DEPTH:
+		return "Maximum depth of " + std::to_string(limit) + " exceeded on line: " + line;
+	case MAX_ELEMENTS:
+		return "Maximum element count of " + std::to_string(limit) + " exceeded on line: " + line;
+	case MAX_STRING_LENGTH:
+		return "Maximum string length of " + std::to_string(limit) + " exceeded on line: " + line;
+	case MAX_BYTES:
+		return "Maximum size of " + std::to_string(limit) + " bytes exceeded";
+	}
+	return "Unknown error";
+}
+
 /**
  * @brief Constructor for the Parser class.
+ * The data is scanned in place: it must outlive the parser.
  * @param data The DFML data to be parsed.
  */
-Parser::Parser(const std::string data) {
+Parser::Parser(std::string_view data) {
 	i.set_data(data);
 }
 
+/**
+ * @brief Constructor for the Parser class.
+ * The parser takes ownership of the data.
+ * @param data The DFML data to be parsed.
+ */
+Parser::Parser(std::string data) : source(std::move(data)) {
+	i.set_data(source);
+}
+
+/**
+ * @brief Constructor for the Parser class.
+ * The parser scans the mapped file and keeps it mapped while alive.
+ * @param file The mapped DFML file to be parsed.
+ */
+Parser::Parser(std::shared_ptr<MappedFile> file) : file(std::move(file)) {
+	i.set_data(this->file->view());
+}
+
 /**
  * @brief Static factory method to create an instance of the Parser class.
+ * The data is scanned in place: it must outlive the parser.
  * @param data The DFML data to be parsed.
  * @return A shared pointer to the created Parser object.
  */
-std::shared_ptr<Parser> Parser::create(const std::string data) {
+std::shared_ptr<Parser> Parser::create(std::string_view data) {
 	return std::make_shared<Parser>(data);
 }
 
+/**
+ * @brief Static factory method to create an instance of the Parser class.
+ * The data is scanned in place: it must outlive the parser.
+ * @param data The DFML data to be parsed (null terminated).
+ * @return A shared pointer to the created Parser object.
+ */
+std::shared_ptr<Parser> Parser::create(const char *data) {
+	return std::make_shared<Parser>(std::string_view(data));
+}
+
+/**
+ * @brief Static factory method to create an instance of the Parser class.
+ * The parser takes ownership of the data.
+ * @param data The DFML data to be parsed.
+ * @return A shared pointer to the created Parser object.
+ */
+std::shared_ptr<Parser> Parser::create(std::string data) {
+	return std::make_shared<Parser>(std::move(data));
+}
+
+/**
+ * @brief Static factory method to create a Parser over a memory mapped file.
+ * @param path Path of the DFML file.
+ * @return A shared pointer to the created Parser object.
+ */
+std::shared_ptr<Parser> Parser::open(const std::string path) {
+	return std::make_shared<Parser>(MappedFile::open(path));
+}
+
 /**
  * @brief Parses the DFML data and returns a list of shared pointers to parsed elements.
  * @return A list of shared pointers to parsed elements.
  */
 std::list<std::shared_ptr<Element>> Parser::parse() {
-	std::list<std::shared_ptr<Element>> list;
-	
-	parse_children(list);
+	return std::move(parse(std::nothrow).get_value());
+}
+
+/**
+ * @brief Parses the DFML data into a list of elements, without throwing on
+ * invalid data.
+ * @return The parsed elements, or the error found.
+ */
+ParseResult<std::list<std::shared_ptr<Element>>> Parser::parse(std::nothrow_t) {
+	TreeHandler tree;
+
+	parse_elements(tree);
+	if (error) return error;
+
+	return std::move(tree.get_elements());
+}
+
+/**
+ * @brief Parses the DFML data into a Document.
+ * @return The parsed document.
+ */
+std::shared_ptr<Document> Parser::parse_document() {
+	return parse_document(std::nothrow).get_value();
+}
 
-	return list;
+/**
+ * @brief Parses the DFML data into a Document, without throwing on invalid data.
+ * The first arena block is sized after the data, which is close to the
+ * memory needed by the elements.
+ * @return The parsed document, or the error found.
+ */
+ParseResult<std::shared_ptr<Document>> Parser::parse_document(std::nothrow_t) {
+	if (!check_size()) return error;
+	auto document = Document::create(std::max<size_t>(i.size(), 4096));
+	TreeHandler tree(document.get());
+	if (options.name_index) document->create_index();
+
+	parse_elements(tree);
+	if (error) return error;
+
+	return document;
+}
+
+/**
+ * @brief Parses the DFML data into an immutable Tape.
+ * @return The parsed tape.
+ */
+std::shared_ptr<Tape> Parser::parse_tape() {
+	return parse_tape(std::nothrow).get_value();
 }
 
 /**
- * @brief Parses child elements in the DFML data.
- * @param childs Reference to a list to store the parsed child elements.
+ * @brief Parses the DFML data into an immutable Tape, without throwing on
+ * invalid data.
+ * Strings longer than Tape::MAX_STRING_LENGTH fail with MAX_STRING_LENGTH,
+ * whatever the options allow.
+ * @return The parsed tape, or the error found.
  */
-void Parser::parse_children(std::list<std::shared_ptr<Element>> &childs) {
+ParseResult<std::shared_ptr<Tape>> Parser::parse_tape(std::nothrow_t) {
+	TapeHandler tape;
+
+	size_t max_string_length = options.max_string_length;
+	options.max_string_length = std::min(max_string_length, Tape::MAX_STRING_LENGTH);
+	parse_elements(tape);
+	options.max_string_length = max_string_length;
+	if (error) return error;
+
+	return tape.get_tape();
+}
+
+/**
+ * @brief Parses the DFML data reporting each element to the handler.
+ * @param handler The handler that receives the parsing events.
+ * @throws ParserException If the data is not valid or exceeds a limit.
+ */
+void Parser::parse(Handler &handler) {
+	parse(handler, std::nothrow).get_value();
+}
+
+/**
+ * @brief Parses the DFML data reporting each element to the handler,
+ * without throwing on invalid data.
+ * The events reported before an error are not undone.
+ * @param handler The handler that receives the parsing events.
+ * @return Nothing, or the error found.
+ */
+ParseResult<void> Parser::parse(Handler &handler, std::nothrow_t) {
+	parse_elements(handler);
+	return error;
+}
+
+/**
+ * @brief Sets the limits of the parser.
+ * @param options The limits.
+ */
+void Parser::set_options(const ParseOptions &options) {
+	this->options = options;
+}
+
+/**
+ * @brief Parses the DFML data on a pool of threads.
+ * The data is split in chunks of top level elements, which are parsed in
+ * parallel and spliced in document order. A '}' at the top level ends the
+ * document, as in parse(), so the chunks after it are dropped. If a chunk
+ * fails the whole data is parsed again in order, to throw the same error as
+ * parse().
+ * @param pool The pool of the workers. Must not be called from one of them.
+ * @return The parsed elements.
+ */
+std::list<std::shared_ptr<Element>> Parser::parse_parallel(ThreadPool &pool) {
+	if (!check_size()) throw ParserException(error);
+	std::string_view data = i.get_data();
+	size_t chunk_size = std::max(PARALLEL_CHUNK_SIZE, data.size() / (pool.size() * 8));
+	if (data.size() < chunk_size * 2 || pool.size() < 2) return parse();
+
+	struct Result {
+		std::list<std::shared_ptr<Element>> elements;
+		size_t count; // All the elements, for the element limit
+		bool more;
+		bool failed;
+	};
+	std::vector<std::future<Result>> results;
+
+	// The chunks are parsed while the next ones are searched
+	Scanner::split(data, chunk_size, [&](std::string_view chunk) {
+		results.push_back(pool.submit([this, chunk]() {
+			Parser parser(chunk);
+			TreeHandler tree;
+			parser.set_options(options);
+			bool more = parser.parse_elements(tree);
+			return Result{std::move(tree.get_elements()), parser.elements, more, bool(parser.error)};
+		}));
+	});
+
+	std::list<std::shared_ptr<Element>> elements;
+	bool failed = false, more = true;
+	size_t count = 0;
+	for (auto &result : results) {
+		try {
+			Result chunk = result.get();
+			if (more && chunk.failed) failed = true;
+			if (more && !failed) elements.splice(elements.end(), chunk.elements);
+			if (more) count += chunk.count;
+			more = more && chunk.more;
+		} catch (...) {
+			if (more) failed = true;
+		}
+	}
+
+	if (failed || count > options.max_elements) {
+		Parser serial(data);
+		serial.set_options(options);
+		return serial.parse();
+	}
+	return elements;
+}
+
+/**
+ * @brief Parses the DFML data on a temporary pool of threads.
+ * @param threads Count of threads, 0 for one per hardware thread.
+ * @return The parsed elements.
+ */
+std::list<std::shared_ptr<Element>> Parser::parse_parallel(unsigned threads) {
+	ThreadPool pool(threads);
+	return parse_parallel(pool);
+}
+
+/**
+ * @brief Parses the top level elements of the data.
+ * Parsing stops at the first error, which is kept in the error member.
+ * @param handler The handler that receives the parsing events.
+ * @return false If the elements end with a '}', which ends the document, or on error.
+ */
+bool Parser::parse_elements(Handler &handler) {
+	bool more = true;
 	int ch;
-	dfml::Value value;
-	while ((ch = i.next()) != -1) {
-		switch (ch) {
-		case ' ':
-		case '\t':
-		case '\n':
-		case '\r':
-			break; // space (continue)
 
-		case '/':
-		case '#':
+	error = {};
+	depth = 0;
+	elements = 0;
+	if (!check_size()) return false;
+
+	this->handler = &handler;
+	i.skip_space();
+	while (more && (ch = i.next()) != -1) {
+		more = parse_child(ch);
+		i.skip_space();
+	}
+	this->handler = nullptr;
+
+	return more;
+}
+
+/**
+ * @brief Parses a single child element in the DFML data.
+ * @param ch The first character of the child.
+ * @return false If ch closes the children list, or on error.
+ */
+bool Parser::parse_child(int ch) {
+	switch (ch) {
+	case ' ':
+	case '\t':
+	case '\n':
+	case '\r':
+		break; // space (continue)
+
+	case '/':
+	case '#':
+		i.back();
+		return parse_comment();
+
+	case '"':
+	case '\'': {
+		dfml::Value value;
+		if (!parse_string(value) || !count_element()) return false;
+		handler->on_data(value);
+		break;
+	}
+	
+	// End of parsing chidren
+	case '}': return false;
+	
+	default:
+		if (is_number_start(ch)) {
+			dfml::Value value;
 			i.back();
-			childs.push_back(parse_comment());
-			break;
+			if (!parse_number(value) || !count_element()) return false;
+			handler->on_data(value);
+			// Data numbers may be followed by a ','
+			if (!i.end() && i.next() != ',') i.back();
+		} else if (this->is_alpha(ch)) {
+			i.back();
+			return parse_node();
+		} else {
+			i.back();
+			return fail(ParseError::INVALID_CHILD);
+		}
+	}
 
-		case '"':
-		case '\'':
-			parse_string(value);
-			childs.push_back(dfml::Data::create(value));
-			break;
-		
-		// End of parsing chidren
-		case '}': return ;
-		
-		default:
-			if (this->is_alpha(ch)) {
-				i.back();
-				childs.push_back(parse_node());
-			} else if (std::isdigit(ch)) {
-				i.back();
-				parse_number(value);
-				childs.push_back(dfml::Data::create(value));
-			} else {
-				throw ParserException("Invalid character for node child on line: " +
-						i.get_line());
-			}
+	return true;
+}
+
+/**
+ * @brief Parses a node element and all its descendants in the DFML data.
+ * The nesting is followed with the depth counter instead of recursion, so
+ * the stack used doesn't depend on the data.
+ * @return false On error.
+ */
+bool Parser::parse_node() {
+	size_t base = depth;
+	int ch;
+
+	if (!parse_node_head()) return false;
+
+	// Children of the open nodes
+	while (depth > base) {
+		i.skip_space();
+		ch = i.next();
+
+		if (ch == -1) {
+			while (depth > base) close_node();
+		} else if (!is_number_start(ch) && is_alpha(ch)) {
+			i.back();
+			if (!parse_node_head()) return false;
+		} else if (!parse_child(ch)) {
+			if (error) return false;
+			close_node();
 		}
 	}
+
+	return true;
 }
 
 /**
- * @brief Parses a node element in the DFML data.
- * @return A shared pointer to the parsed node element.
+ * @brief Parses a node up to its children.
+ * A node with children is left open, with its '{' consumed and counted in
+ * the depth; the other nodes are ended.
+ * @return false On error.
  */
-std::shared_ptr<Element> Parser::parse_node() {
+bool Parser::parse_node_head() {
 	int ch;
-	std::string name = parse_node_name();
+	std::string_view name = parse_node_name();
 
 	// If keywords "true" or "false" isn't a node: it is boolean data.
-	if (name == "true") {
-		return dfml::Data::create_boolean(true);
-	} else if (name == "false") {
-		return dfml::Data::create_boolean(false);
+	if (name == "true" || name == "false") {
+		dfml::Value value;
+		value.set_boolean(name == "true");
+		if (!count_element()) return false;
+		handler->on_data(value);
+		return true;
 	}
 
-	// Create a node
-	auto node = dfml::Node::create(name);
-	std::list<std::shared_ptr<Element>> children;
-
-	if (i.end()) return node;
+	if (i.end()) {
+		if (!open_node(name)) return false;
+		handler->on_node_end();
+		return true;
+	}
 
 	i.back();
 
-	if (node->get_name() == "") {
-		throw ParserException("Empty node name encountered on line: " + i.get_line());
-	}
+	if (name.empty()) return fail(ParseError::EMPTY_NODE_NAME);
+
+	if (!open_node(name)) return false;
 
 	// Parse attributes and children
 	bool stop = false, attr_parsed = false;
+	i.skip_space();
 	while ((ch = i.next()) != -1) {
 		switch (ch) {
 		case ' ':
@@ -127,18 +438,16 @@ std::shared_ptr<Element> Parser::parse_node() {
 			break; // space (continue)
 
 		case '(':
-			if (attr_parsed) {
-				throw ParserException("Double attribute list found in the node on line: " +
-						i.get_line());
-			}
-			parse_node_attributes(node);
+			if (attr_parsed) return fail(ParseError::DOUBLE_ATTRIBUTE_LIST);
+			if (!parse_node_attributes()) return false;
 			attr_parsed = true;
+			i.skip_space();
 			break;
 
 		case '{':
-			parse_children(children);
-			stop = true;
-			break;
+			// Left open: the children are parsed by parse_node()
+			depth++;
+			return true;
 
 		case '}':
 			stop = true;
@@ -153,169 +462,203 @@ std::shared_ptr<Element> Parser::parse_node() {
 		if (stop) break;
 	}
 
-	for (auto &e : children) {
-		node->add_child(e);
+	handler->on_node_end();
+	return true;
+}
+
+/**
+ * @brief Checks the limits and reports the beginning of a node.
+ * @param name The name of the node.
+ * @return false If a limit is exceeded.
+ */
+bool Parser::open_node(std::string_view name) {
+	if (!check_length(name.size())) return false;
+	if (depth >= options.max_depth) return fail(ParseError::MAX_DEPTH, options.max_depth);
+	if (!count_element()) return false;
+	handler->on_node_begin(name);
+	return true;
+}
+
+/**
+ * @brief Ends the innermost open node.
+ */
+void Parser::close_node() {
+	depth--;
+	handler->on_node_end();
+}
+
+/**
+ * @brief Counts an element, checking the element limit.
+ * @return false If the limit is exceeded.
+ */
+bool Parser::count_element() {
+	if (++elements > options.max_elements) return fail(ParseError::MAX_ELEMENTS, options.max_elements);
+	return true;
+}
+
+/**
+ * @brief Checks the length of a name, key, string or comment.
+ * @param length The length.
+ * @return false If the limit is exceeded.
+ */
+bool Parser::check_length(size_t length) {
+	if (length > options.max_string_length) {
+		return fail(ParseError::MAX_STRING_LENGTH, options.max_string_length);
 	}
+	return true;
+}
 
-	return node;
+/**
+ * @brief Checks the size of the data, before anything is parsed.
+ * @return false If the limit is exceeded.
+ */
+bool Parser::check_size() {
+	if (i.size() > options.max_bytes) return fail(ParseError::MAX_BYTES, options.max_bytes);
+	return true;
+}
+
+/**
+ * @brief Records an error at the current position.
+ * Nothing is allocated: the message is only built by ParseError::get_message().
+ * @param code The error code.
+ * @param limit The exceeded limit, for the limit errors.
+ * @return false Always, to be returned by the parsing function.
+ */
+bool Parser::fail(ParseError::Code code, size_t limit) {
+	std::string_view data = i.get_data();
+	size_t offset = std::min<size_t>(i.position(), data.size());
+	size_t line_start = data.substr(0, offset).rfind('\n');
+	line_start = line_start == std::string_view::npos ? 0 : line_start + 1;
+
+	error.code = code;
+	error.offset = offset;
+	error.line = i.get_line_number();
+	error.column = static_cast<unsigned>(offset - line_start + 1);
+	error.limit = limit;
+	return false;
 }
 
 /**
  * @brief Parses the name of a node element in the DFML data.
- * @return The name of the parsed node.
+ * @return The name of the parsed node, a view of the data.
  */
-const std::string Parser::parse_node_name() {
-	int ch;
-	std::string name = "";
-	while ((ch = i.next()) != -1) {
-		if (this->is_alphanumeric(ch)) {
-			name += ch;
-		} else break;
-	}
+std::string_view Parser::parse_node_name() {
+	std::string_view name = i.skip_while([this](char ch) { return is_alphanumeric(ch); });
+	// Consume the character that ends the name
+	i.next();
 	return name;
 }
 
 /**
- * @brief Parse attibutes for the given node.
- * @param node The node reference.
- * 
+ * @brief Parse attibutes for the current node.
+ * @return false On error.
  */
-void Parser::parse_node_attributes(std::shared_ptr<Node> node) {
+bool Parser::parse_node_attributes() {
 	int ch;
-	bool stop = false;
 	
-	while ((ch = i.next()) != -1 && !stop) {
+	i.skip_space();
+	while ((ch = i.next()) != -1) {
 		switch (ch) {
-		case ' ':
-		case '\n':
-		case '\t':
-		case '\r':
-			// Continue
-			break;
-			
 		case ',':
-			throw ParserException("Unexpected attribute pair separator ',': " + i.get_line());
-			return ;
+			i.back();
+			return fail(ParseError::UNEXPECTED_SEPARATOR);
 
 		case ')':
-			stop = true;
-			break;
+			return true;
 		}
 
 		if (this->is_alpha(ch)) {
 			i.back();
-			parse_node_attribute(node);
+			if (!parse_node_attribute()) return false;
 		}
 
-		if (stop) break;
+		i.skip_space();
 	}
+
+	return true;
 }
 
 /**
- * @brief Parse a attribute pair (Key/Value) for the given node.
- * @param node The node reference
+ * @brief Parse a attribute pair (Key/Value) for the current node.
+ * @return false On error.
  */
-void Parser::parse_node_attribute(std::shared_ptr<Node> node) {
+bool Parser::parse_node_attribute() {
 	int ch;
-	bool stop = false;
-	std::string key;
+	std::string &key = name;
 	Value value;
 
-	enum status_t {
-		PARSING_NAME,
-		FIND_SEP,
-		FIND_VALUE
-	} status = PARSING_NAME;
-
-	// Parse key
-	while ((ch = i.next()) != -1 && !stop) {
-		switch (status) {
-		case FIND_VALUE:
-
-			switch (ch) {
-
-			case ' ':
-			case '\n':
-			case '\t':
-			case '\r':
-				// Continue
-				break;
-
-			case '"':
-			case '\'':
-				parse_string(value);
-				node->set_attribute(key, value);
-				break;
-
-			case ',':
-				// End of pair
-				return ;
-
-			case ')':
-				// End of attributes
-				i.back();
-				return ;
-			}
-
-			if (is_number(ch)) {
-				i.back();
-				parse_number(value);
-				node->set_attribute(key, value);
-				i.back();
-			}
-			if (this->is_alpha(ch)) {
-				i.back();
-				parse_boolean(value);
-				node->set_attribute(key, value);
-				i.back();
-			}
+	key.clear();
 
+	// Parse key: characters other than alphanumeric and separators are ignored.
+	while (true) {
+		key += i.skip_while([this](char ch) { return is_alphanumeric(ch); });
+		if (!check_length(key.size())) return false;
+
+		ch = i.next();
+		if (ch == -1) return true;
+		if (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' || ch == ':') {
+			i.back();
 			break;
-		case FIND_SEP:
-			switch (ch) {
-			case ' ':
-			case '\n':
-			case '\t':
-			case '\r':
-				// Continue
-				break;
-
-			case ':':
-				status = FIND_VALUE;
-				break;
-			case ',':
-			case ')':
-				// Empty attribute
-				node->set_attr_string(key, "");
-				return;
-			}
-			break;
+		}
+		if (ch == ',' || ch == ')') {
+			// Empty attribute
+			value.set_string("");
+			handler->on_attribute(key, value);
+			i.back();
+			return true;
+		}
+	}
+
+	// Find separator
+	while (true) {
+		i.skip_space();
+
+		ch = i.next();
+		if (ch == -1) return true;
+		if (ch == ':') break;
+		if (ch == ',' || ch == ')') {
+			// Empty attribute
+			value.set_string("");
+			handler->on_attribute(key, value);
+			if (ch == ')') i.back();
+			return true;
+		}
+	}
+
+	// Find value
+	while (true) {
+		i.skip_space();
 
-		case PARSING_NAME:
-			switch (ch) {
-
-			case ' ':
-			case '\n':
-			case '\t':
-			case '\r':
-			case ':':
-				status = FIND_SEP;
-				i.back();
-				break;
-
-			case ',':
-			case ')':
-				// Empty attribute
-				node->set_attr_string(key, "");
-				i.back();
-				return;
-			}
-
-
-			if (this->is_alphanumeric(ch)) {
-				key += ch;
-			}
+		ch = i.next();
+		switch (ch) {
+		case -1:
+			return true;
+
+		case '"':
+		case '\'':
+			if (!parse_string(value)) return false;
+			handler->on_attribute(key, value);
 			break;
+
+		case ',':
+			// End of pair
+			return true;
+
+		case ')':
+			// End of attributes
+			i.back();
+			return true;
+		}
+
+		if (is_number(ch)) {
+			i.back();
+			if (!parse_number(value)) return false;
+			handler->on_attribute(key, value);
+		} else if (this->is_alpha(ch)) {
+			i.back();
+			if (!parse_boolean(value)) return false;
+			handler->on_attribute(key, value);
+			i.back();
 		}
 	}
 }
@@ -323,148 +666,114 @@ void Parser::parse_node_attribute(std::shared_ptr<Node> node) {
 /**
  * @brief Parses a string element in the DFML data.
  * @param value Value reference to set string data.
+ * @return false On error.
  */
-void Parser::parse_string(dfml::Value &value) {
-	std::string result;
-	int ch;
-
+bool Parser::parse_string(dfml::Value &value) {
 	int end = i.current();
+	std::string_view string = i.skip_to(end);
 
-	while ((ch = i.next()) != -1) {
-		if (ch == end) break;
-		result += ch;
-	}
-	
-	value.set_string(result);
+	if (!check_length(string.size())) return false;
+	value.set_string(string);
+	return true;
 }
 
 /**
  * @brief Parses a number Data element.
- * Detect float point to se double data or se fixed to integer.
+ * Numbers with a decimal point or an exponent are doubles, the others integers.
+ * The character that ends the number is not consumed.
  * @param value Value reference to set number data.
+ * @return false On error.
  */
-void Parser::parse_number(dfml::Value &value) {
-	int ch;
-	std::string result;
-	double dbl_result = 0.0;
-	long int_result = 0;
+bool Parser::parse_number(dfml::Value &value) {
 	bool dbl = false;
-	size_t pos;
-	bool error = false;
+	std::string_view number = i.skip_while([&dbl](char ch) {
+		if (ch == '.' || ch == 'e' || ch == 'E') dbl = true;
+		else if (!std::isdigit(static_cast<unsigned char>(ch)) && ch != '-' && ch != '+') return false;
+		return true;
+	});
+	const char *end = number.data() + number.size();
 
-	while ((ch = i.next()) != -1) {
-		if (!is_number(ch)) break;
-		if (ch == '.') dbl = true;
-		result += ch;
-	}
+	// A number split by the end of partial data may continue in the next chunk.
+	if (i.end() && i.is_starved()) return true;
 
 	if (dbl) {
-		try {
-			dbl_result = std::stod(result, &pos);
-			if (pos != result.length()) {
-				error = true;
-			}
-		} catch( ... ) {
-			error = true;
-		}
-
-		if (error) throw ParserException("Double conversion error on line: " + i.get_line());
-
-		value.set_double(dbl_result);
+		double result;
+		auto [ptr, ec] = std::from_chars(number.data(), end, result);
+		if (ec != std::errc() || ptr != end) return fail(ParseError::INVALID_DOUBLE);
+		value.set_double(result);
 	} else {
-		try {
-			int_result = std::stol(result, &pos);
-			if (pos != result.length()) {
-				error = true;
-			}
-		} catch( ... ) {
-			error = true;
-		}
-
-		if (error) throw ParserException("Integer conversion error on line: " + i.get_line());
-
-		value.set_integer(int_result);
+		long result;
+		auto [ptr, ec] = std::from_chars(number.data(), end, result);
+		if (ec != std::errc() || ptr != end) return fail(ParseError::INVALID_INTEGER);
+		value.set_integer(result);
 	}
+	return true;
 }
 
 /**
  * @brief Parses a boolean Data element.
  * @param value Value reference to set boolean data.
+ * @return false On error.
  */
-void Parser::parse_boolean(Value &value) {
-	int ch;
-	std::string result;
-	while ((ch = i.next()) != -1) {
-		if (!this->is_alpha(ch)) break;
-		result += ch;
-	}
+bool Parser::parse_boolean(Value &value) {
+	std::string_view result = i.skip_while([this](char ch) { return is_alpha(ch); });
+	i.next();
 
-	if (result == "true" || result == "false") {
-		value.set_boolean(result == "true" ? true : false);
-	} else {
-		throw ParserException("Boolean conversion error on line: " + i.get_line());
-	}
+	if (result != "true" && result != "false") return fail(ParseError::INVALID_BOOLEAN);
+	value.set_boolean(result == "true");
+	return true;
 }
 
 /**
  * @brief Parses a Comment element.
  * Parses //, /* and # comment type.
- * 
- * @return std::shared_ptr<Element> The parsed Comment element.
+ * @return false On error.
  */
-std::shared_ptr<Element> Parser::parse_comment() {
+bool Parser::parse_comment() {
 	int ch = i.next();
 	bool single_line = false;
-	std::string string;
+	std::string &string = text;
+
+	string.clear();
 
 	if (ch == '#') single_line = true;
 	else if (ch == '/') {
 		ch = i.next();
 		if (ch == -1) {
-			throw ParserException("Unexpected comment termination on line: " + i.get_line());
+			return fail(ParseError::INVALID_COMMENT);
 		} else if (ch == '/') {
 			single_line = true;
 		}
 		else if (ch == '*') {single_line = false;}
 		else {
-			throw ParserException("Unexpected comment termination on line: " + i.get_line());
+			return fail(ParseError::INVALID_COMMENT);
 		}
 	}
 
-	bool stop = false;
-	while ((ch = i.next()) != -1 && !stop) {
-		switch(ch) {
-
-		case '\r':
-			if (!single_line) string += ch;
-			// Continue
-			break;
-
-		case '\n':
-			if (single_line) {
-				i.back();
-				stop = true;
-			}
-			else string += ch;
-			break;
-
-		case '*':
-			if (!single_line) {
-				ch = i.next();
-				if (ch == '/' || ch == -1) {
-					stop = true;
-				} else {
-					string += ch;
-				}
-			} else string += ch;
-			break;
-
-		default:
+	if (single_line) {
+		// Up to the end of line, without carriage returns
+		std::string_view line = i.skip_while([](char ch) { return ch != '\n'; });
+		if (!check_length(line.size())) return false;
+		string = line;
+		string.erase(std::remove(string.begin(), string.end(), '\r'), string.end());
+		i.end();
+	} else {
+		// Up to "*/", the character after any other '*' is kept
+		while (true) {
+			std::string_view piece = i.skip_while([](char ch) { return ch != '*'; });
+			if (!check_length(string.size() + piece.size())) return false;
+			string += piece;
+			if (i.next() == -1) break;
+			ch = i.next();
+			if (ch == '/' || ch == -1) break;
+			if (!check_length(string.size() + 1)) return false;
 			string += ch;
 		}
 	}
 
-	return dfml::Comment::create(string);
+	if (!count_element()) return false;
+	handler->on_comment(string);
+	return true;
 }
 
 /**
@@ -478,6 +787,17 @@ const bool Parser::is_number(int ch) const {
 	return false;
 }
 
+/**
+ * @brief Checks if the given character starts a number in a children list.
+ * A '-' starts a number only when a digit follows, otherwise it starts a node name.
+ * @param ch The character already read.
+ * @return True if the character starts a number, otherwise false.
+ */
+const bool Parser::is_number_start(int ch) {
+	if (std::isdigit(ch)) return true;
+	return ch == '-' && std::isdigit(i.peek());
+}
+
 /**
  * @brief Checks the character ch if alphabetic, '-', or '_'.
  * 
@@ -505,21 +825,41 @@ const bool Parser::is_alphanumeric(const char ch) {
 }
 
 /**
- * @brief Gets the next character in the DFML data.
- * @return The ASCII value of the next character, or -1 if end of data is reached.
+ * @brief Moves the iterator after the next occurrence of a quote.
+ * The quote is found jumping between the structural characters of the index.
+ * @param quote The quote character to look for.
+ * @return The data skipped, without the quote.
  */
-int CharIterator::next() {
-	if (i >= data.size()) return -1;
-	int ch = data[i]; i ++;
-	if (ch == '\n') line ++;
-	return ch;
+std::string_view CharIterator::skip_to(int quote) {
+	unsigned long start = i;
+	unsigned long pos = index.next_structural(i);
+
+	while (pos < data.size() && data[pos] != quote) pos = index.next_structural(pos + 1);
+
+	if (pos >= data.size()) {
+		// Unterminated: everything up to the end.
+		i = data.size();
+		if (partial) starved = true;
+		return data.substr(start);
+	}
+
+	i = pos + 1;
+	return data.substr(start, pos - start);
 }
 
 /**
- * @brief Moves the iterator back by one character.
+ * @brief Returns current data line as a number.
+ * Lines are counted on demand, from the last position asked.
+ * @return The current line.
  */
-void CharIterator::back() {
-	i --;
+unsigned CharIterator::get_line_number() const {
+	if (i >= line_pos) {
+		line += std::count(data.begin() + line_pos, data.begin() + i, '\n');
+	} else {
+		line -= std::count(data.begin() + i, data.begin() + line_pos, '\n');
+	}
+	line_pos = i;
+	return line;
 }
 
 }  // namespace dfml
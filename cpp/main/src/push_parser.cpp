@@ -0,0 +1,114 @@
+/**
+ * @file push_parser.cpp
+ * @brief Implementation of the PushParser class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/push_parser.h>
+#include <dfml/parser.h>
+#include <dfml/handler.h>
+
+#include "scanner.h"
+
+namespace dfml {
+
+/**
+ * @brief Constructor for the PushParser class.
+ *
+ * @param callback Receiver of the top level elements.
+ */
+PushParser::PushParser(Callback callback)
+	: callback(std::move(callback)), scanner(std::make_unique<Scanner>()) {}
+
+/**
+ * @brief Destructor for the PushParser class.
+ */
+PushParser::~PushParser() = default;
+
+/**
+ * @brief Creates and returns a shared pointer to a PushParser instance.
+ *
+ * @param callback Receiver of the top level elements.
+ * @return std::shared_ptr<PushParser> Shared pointer to the new PushParser instance.
+ */
+std::shared_ptr<PushParser> PushParser::create(Callback callback) {
+	return std::make_shared<PushParser>(std::move(callback));
+}
+
+/**
+ * @brief Feeds the next chunk of the document.
+ * The buffered elements are parsed only when the scanner finds new data at the
+ * top level, so an element spanning many chunks is parsed once.
+ *
+ * @param data The chunk data.
+ * @param size The chunk size.
+ */
+void PushParser::feed(const char *data, size_t size) {
+	if (closed) return;
+
+	buffer.append(data, size);
+	scanner->scan(data, size);
+
+	if (scanner->get_top_level_mark() > attempted) flush(false);
+}
+
+/**
+ * @brief Signals the end of the document, parsing the remaining data.
+ */
+void PushParser::finish() {
+	if (!closed) flush(true);
+	closed = true;
+	buffer.clear();
+}
+
+/**
+ * @brief Parses the buffered top level elements.
+ * Parsing stops at the first element that needs more data than buffered,
+ * that element is parsed again on the next attempt.
+ *
+ * @param final true if no more data will follow.
+ */
+void PushParser::flush(const bool final) {
+	Parser parser{std::string_view(buffer)};
+	TreeHandler tree;
+	size_t consumed = 0;
+	unsigned consumed_line = line;
+
+	attempted = scanner->get_top_level_mark();
+	parser.handler = &tree;
+	parser.i.set_partial(!final);
+	parser.i.set_line_number(line);
+
+	int ch;
+	while ((ch = parser.i.next()) != -1) {
+		bool more = parser.parse_child(ch);
+		// A truncated element is not an error until the end of the data.
+		if (parser.i.is_starved()) break;
+		if (parser.error) {
+			closed = true;
+			throw ParserException(parser.error);
+		}
+
+		for (auto &e : tree.get_elements()) callback(e);
+		tree.get_elements().clear();
+
+		consumed = parser.i.position();
+		consumed_line = parser.i.get_line_number();
+
+		if (!more) {
+			closed = true;
+			break;
+		}
+	}
+
+	if (final) consumed = buffer.size();
+
+	buffer.erase(0, consumed);
+	line = consumed_line;
+}
+
+} // namespace dfml
@@ -0,0 +1,393 @@
+/**
+ * @file query.cpp
+ * @brief Implementation of the Query class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-06
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/query.h>
+#include <dfml/document.h>
+
+#include <cctype>
+#include <charconv>
+#include <unordered_set>
+
+namespace dfml {
+
+namespace {
+
+/**
+ * @brief Checks if a character can be part of a node name or attribute key.
+ */
+bool is_name(char ch) {
+	return std::isalnum(static_cast<unsigned char>(ch)) || ch == '-' || ch == '_';
+}
+
+/**
+ * @brief Removes the spaces around a text.
+ */
+std::string_view trim(std::string_view text) {
+	while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+	while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.remove_suffix(1);
+	return text;
+}
+
+/**
+ * @brief Compares an attribute with a predicate value.
+ * Integers and doubles compare by value, other types must be the same.
+ */
+bool equal(const Value &attribute, const Value &value) {
+	int a = attribute.get_type(), b = value.get_type();
+	bool a_number = a == Value::INTEGER || a == Value::DOUBLE;
+	bool b_number = b == Value::INTEGER || b == Value::DOUBLE;
+
+	if (a_number && b_number) {
+		if (a == Value::INTEGER && b == Value::INTEGER) return attribute.get_integer() == value.get_integer();
+		double x = a == Value::INTEGER ? attribute.get_integer() : attribute.get_double();
+		double y = b == Value::INTEGER ? value.get_integer() : value.get_double();
+		return x == y;
+	}
+	if (a != b) return false;
+
+	switch (a) {
+	case Value::STRING: return attribute.get_string() == value.get_string();
+	case Value::BOOLEAN: return attribute.get_boolean() == value.get_boolean();
+	}
+	return false;
+}
+
+} // namespace
+
+/**
+ * @brief State of a running query.
+ */
+struct Query::Run {
+	/**
+	 * @brief Pending match of a step against the children of a node.
+	 */
+	struct Frame {
+		ChildRange::iterator next;           /**< Next child to match. */
+		ChildRange::iterator end;            /**< Child after the last one. */
+		size_t step;                         /**< Index of the step. */
+		size_t positions[MAX_PREDICATES];    /**< Position counters, one per predicate. */
+	};
+
+	/**
+	 * @brief Queues the match of a step against some children.
+	 *
+	 * @param children The children.
+	 * @param step Index of the step.
+	 */
+	void push(ChildRange children, size_t step) {
+		if (!children.empty()) frames.push_back(Frame{children.begin(), children.end(), step, {}});
+	}
+
+	const Visitor &visitor; /**< Receiver of the matches. */
+	std::vector<std::unordered_set<const Node *>> searched; /**< Searched nodes of the nested '//' steps, by step. */
+	std::vector<Frame> frames; /**< Pending matches, the last one first. */
+};
+
+/**
+ * @brief Constructor for the Query class: parses the expression.
+ *
+ * @param expression The DFPath expression.
+ * @throws QueryException If the expression is not valid.
+ */
+Query::Query(std::string_view expression) : expression(expression) {
+	std::string_view text = expression;
+	bool descendant = false;
+
+	if (text.substr(0, 2) == "//") {
+		descendant = true;
+		text.remove_prefix(2);
+	} else if (text.substr(0, 1) == "/") {
+		text.remove_prefix(1);
+	}
+
+	while (true) {
+		parse_step(text, descendant);
+		if (text.empty()) break;
+
+		// The step ends at a '/' or "//"
+		text.remove_prefix(1);
+		descendant = !text.empty() && text.front() == '/';
+		if (descendant) text.remove_prefix(1);
+	}
+}
+
+/**
+ * @brief Creates a compiled query.
+ *
+ * @param expression The DFPath expression.
+ * @return std::shared_ptr<Query> Shared pointer to the new Query instance.
+ */
+std::shared_ptr<Query> Query::create(std::string_view expression) {
+	return std::make_shared<Query>(expression);
+}
+
+/**
+ * @brief Parses a step of the expression.
+ *
+ * @param text The expression from the step on; consumed up to the step end.
+ * @param descendant The step follows a '//'.
+ */
+void Query::parse_step(std::string_view &text, bool descendant) {
+	Step step{"", descendant, {}};
+	for (auto &previous : steps) step.nested |= descendant && previous.descendant;
+
+	if (!text.empty() && text.front() == '*') {
+		text.remove_prefix(1);
+	} else {
+		size_t length = 0;
+		while (length < text.size() && is_name(text[length])) length++;
+		if (!length) throw QueryException("Empty step in DFPath: " + expression);
+		step.name = text.substr(0, length);
+		text.remove_prefix(length);
+	}
+
+	while (!text.empty() && text.front() == '[') {
+		// Up to the ']' outside quotes
+		size_t end = 1;
+		char quote = 0;
+		for (; end < text.size(); end++) {
+			if (quote) {
+				if (text[end] == quote) quote = 0;
+			} else if (text[end] == '\'' || text[end] == '"') {
+				quote = text[end];
+			} else if (text[end] == ']') {
+				break;
+			}
+		}
+		if (end == text.size()) throw QueryException("Unclosed predicate in DFPath: " + expression);
+		if (step.predicates.size() == MAX_PREDICATES) {
+			throw QueryException("Too many predicates in DFPath: " + expression);
+		}
+
+		step.predicates.push_back(parse_predicate(text.substr(1, end - 1)));
+		text.remove_prefix(end + 1);
+	}
+
+	if (!text.empty() && text.front() != '/') {
+		throw QueryException("Unexpected character '" + std::string(1, text.front()) +
+				"' in DFPath: " + expression);
+	}
+
+	steps.push_back(std::move(step));
+}
+
+/**
+ * @brief Parses a predicate of a step.
+ *
+ * @param text The predicate, without brackets.
+ * @return Predicate The parsed predicate.
+ */
+Query::Predicate Query::parse_predicate(std::string_view text) {
+	Predicate predicate{Predicate::EXISTS, "", Value(), 0};
+	text = trim(text);
+
+	// Position
+	if (!text.empty() && std::isdigit(static_cast<unsigned char>(text.front()))) {
+		auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), predicate.position);
+		if (ec != std::errc() || ptr != text.data() + text.size() || !predicate.position) {
+			throw QueryException("Invalid position in DFPath: " + expression);
+		}
+		predicate.type = Predicate::POSITION;
+		return predicate;
+	}
+
+	// Attribute key
+	size_t length = 0;
+	while (length < text.size() && is_name(text[length])) length++;
+	if (!length) throw QueryException("Invalid predicate in DFPath: " + expression);
+	predicate.key = text.substr(0, length);
+	text = trim(text.substr(length));
+	if (text.empty()) return predicate;
+
+	if (text.substr(0, 2) == "!=") {
+		predicate.type = Predicate::NOT_EQUAL;
+		text.remove_prefix(2);
+	} else if (text.front() == '=') {
+		predicate.type = Predicate::EQUAL;
+		text.remove_prefix(1);
+	} else {
+		throw QueryException("Invalid predicate in DFPath: " + expression);
+	}
+
+	// Compared value
+	text = trim(text);
+	if (text.empty()) throw QueryException("Missing value in DFPath: " + expression);
+
+	const char *end = text.data() + text.size();
+	if (text.size() >= 2 && (text.front() == '\'' || text.front() == '"') && text.back() == text.front()) {
+		predicate.value.set_string(text.substr(1, text.size() - 2));
+	} else if (text == "true" || text == "false") {
+		predicate.value.set_boolean(text == "true");
+	} else if (text.find_first_of(".eE") != std::string_view::npos) {
+		double number;
+		auto [ptr, ec] = std::from_chars(text.data(), end, number);
+		if (ec != std::errc() || ptr != end) throw QueryException("Invalid number in DFPath: " + expression);
+		predicate.value.set_double(number);
+	} else {
+		long number;
+		auto [ptr, ec] = std::from_chars(text.data(), end, number);
+		if (ec != std::errc() || ptr != end) throw QueryException("Invalid value in DFPath: " + expression);
+		predicate.value.set_integer(number);
+	}
+
+	return predicate;
+}
+
+/**
+ * @brief Reports the matches among some elements and their descendants.
+ *
+ * @param elements The elements matched by the first step.
+ * @param visitor The receiver of the matches.
+ * @return false If the visitor stopped the query.
+ */
+bool Query::each(ChildRange elements, const Visitor &visitor) const {
+	return start(elements, visitor);
+}
+
+/**
+ * @brief Reports the matches among top level elements.
+ *
+ * @param elements The elements matched by the first step.
+ * @param visitor The receiver of the matches.
+ * @return false If the visitor stopped the query.
+ */
+bool Query::each(const std::list<std::shared_ptr<Element>> &elements, const Visitor &visitor) const {
+	return start(elements, visitor);
+}
+
+/**
+ * @brief Reports the matches among the elements of a document.
+ *
+ * @param document The document whose elements are matched by the first step.
+ * @param visitor The receiver of the matches.
+ * @return false If the visitor stopped the query.
+ */
+bool Query::each(const Document &document, const Visitor &visitor) const {
+	auto &elements = document.get_elements();
+	return start(ChildRange(elements.data(), elements.data() + elements.size()), visitor);
+}
+
+/**
+ * @brief Runs the query from the first step.
+ *
+ * @param elements The elements matched by the first step.
+ * @param visitor The receiver of the matches.
+ * @return false If the visitor stopped the query.
+ */
+template <typename Range>
+bool Query::start(const Range &elements, const Visitor &visitor) const {
+	Run run{visitor, {}, {}};
+	return match(elements, 0, run);
+}
+
+/**
+ * @brief Matches a step against a list of siblings and their descendants.
+ * The matches below each sibling are followed with a stack of frames, so
+ * any depth is supported.
+ *
+ * @param siblings The siblings.
+ * @param step Index of the step.
+ * @param run State of the running query.
+ * @return false If the visitor stopped the query.
+ */
+template <typename Range>
+bool Query::match(const Range &siblings, size_t step, Run &run) const {
+	size_t positions[MAX_PREDICATES] = {};
+	for (auto &element : siblings) {
+		if (!visit(*element, step, positions, run) || !resume(run)) return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Matches a node against a step, queueing the matches it leads to.
+ * The following step below a match runs before the same step below the
+ * node, so it is queued last. A nested '//' step is skipped below a node
+ * where it was already run: the earlier search covered the same
+ * descendants.
+ *
+ * @param element The element, skipped if it is not a node.
+ * @param step Index of the step.
+ * @param positions Position counters of the step among the siblings.
+ * @param run State of the running query.
+ * @return false If the visitor stopped the query.
+ */
+bool Query::visit(Element &element, size_t step, size_t *positions, Run &run) const {
+	if (element.get_element_type() != Element::NODE) return true;
+	Node &node = static_cast<Node &>(element);
+	const Step &current = steps[step];
+
+	// The counters may live in a frame: they are not used after a push
+	bool passed = current.name.empty() || std::string_view(node.name) == current.name;
+	for (size_t p = 0; passed && p < current.predicates.size(); p++) {
+		const Predicate &predicate = current.predicates[p];
+		if (predicate.type == Predicate::POSITION) passed = ++positions[p] == predicate.position;
+		else passed = check(node, predicate);
+	}
+
+	// Nodes under a match would be found again by a following '//' step
+	bool skip_matched = current.descendant && step + 1 < steps.size() && steps[step + 1].descendant;
+	if (current.descendant && !(passed && skip_matched)) run.push(node.get_children(), step);
+
+	if (!passed) return true;
+	if (step + 1 == steps.size()) return run.visitor(node);
+
+	if (steps[step + 1].nested) {
+		if (run.searched.empty()) run.searched.resize(steps.size());
+		auto &searched = run.searched[step + 1];
+		for (const Node *ancestor = &node; ancestor; ancestor = ancestor->get_parent()) {
+			if (searched.count(ancestor)) return true;
+		}
+		searched.insert(&node);
+	}
+
+	run.push(node.get_children(), step + 1);
+	return true;
+}
+
+/**
+ * @brief Runs the queued matches, from the last one.
+ *
+ * @param run State of the running query.
+ * @return false If the visitor stopped the query.
+ */
+bool Query::resume(Run &run) const {
+	while (!run.frames.empty()) {
+		Run::Frame &frame = run.frames.back();
+		if (frame.next == frame.end) {
+			run.frames.pop_back();
+			continue;
+		}
+
+		Element &element = **frame.next++;
+		if (!visit(element, frame.step, frame.positions, run)) return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Checks an attribute predicate on a node.
+ *
+ * @param node The node.
+ * @param predicate The predicate.
+ * @return true If the node passes it.
+ */
+bool Query::check(const Node &node, const Predicate &predicate) {
+	const Value *value = node.find_attr(predicate.key);
+	if (!value) return false;
+
+	switch (predicate.type) {
+	case Predicate::EQUAL: return equal(*value, predicate.value);
+	case Predicate::NOT_EQUAL: return !equal(*value, predicate.value);
+	default: return true;
+	}
+}
+
+} // namespace dfml
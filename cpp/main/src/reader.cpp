@@ -0,0 +1,361 @@
+/**
+ * @file reader.cpp
+ * @brief Implementation of the Reader class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/reader.h>
+#include <dfml/mapped_file.h>
+
+namespace dfml {
+
+/**
+ * @brief Creates and returns a shared pointer to a Reader instance.
+ * The data is scanned in place: it must outlive the reader.
+ *
+ * @param data The DFML data to read.
+ * @return std::shared_ptr<Reader> Shared pointer to the new Reader instance.
+ */
+std::shared_ptr<Reader> Reader::create(std::string_view data) {
+	return std::make_shared<Reader>(data);
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a Reader instance.
+ * The data is scanned in place: it must outlive the reader.
+ *
+ * @param data The DFML data to read (null terminated).
+ * @return std::shared_ptr<Reader> Shared pointer to the new Reader instance.
+ */
+std::shared_ptr<Reader> Reader::create(const char *data) {
+	return std::make_shared<Reader>(std::string_view(data));
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a Reader instance.
+ * The reader takes ownership of the data.
+ *
+ * @param data The DFML data to read.
+ * @return std::shared_ptr<Reader> Shared pointer to the new Reader instance.
+ */
+std::shared_ptr<Reader> Reader::create(std::string data) {
+	return std::make_shared<Reader>(std::move(data));
+}
+
+/**
+ * @brief Creates a Reader over a read-only memory mapping of a file.
+ *
+ * @param path Path of the DFML file.
+ * @return std::shared_ptr<Reader> Shared pointer to the new Reader instance.
+ */
+std::shared_ptr<Reader> Reader::open(const std::string path) {
+	return std::make_shared<Reader>(MappedFile::open(path));
+}
+
+/**
+ * @brief Moves to the next token.
+ *
+ * @return true If a token was read, false at the end of the document.
+ */
+bool Reader::read() {
+	if (attr_index < attr_count) {
+		attr_index++;
+		token = ATTRIBUTE;
+		return true;
+	}
+
+	switch (mode) {
+	case TAIL: return read_tail();
+	case CHILDREN: return read_child();
+	default:
+		token = END;
+		return false;
+	}
+}
+
+/**
+ * @brief Gets the name of the current node or attribute key.
+ *
+ * @return std::string_view The name, valid until the next read().
+ */
+std::string_view Reader::name() const {
+	if (token == ATTRIBUTE) return attrs[attr_index - 1].first;
+	if (token == NODE_BEGIN) return current_name;
+	return std::string_view();
+}
+
+/**
+ * @brief Gets the value of the current attribute, data or comment.
+ *
+ * @return const Value& The value, valid until the next read().
+ */
+const Value &Reader::value() const {
+	if (token == ATTRIBUTE) return attrs[attr_index - 1].second;
+	return current;
+}
+
+/**
+ * @brief Gets the nesting level of the current token.
+ *
+ * @return unsigned The depth of the current token.
+ */
+unsigned Reader::depth() const {
+	if (token == NODE_BEGIN) return open_nodes - 1;
+	return open_nodes;
+}
+
+/**
+ * @brief Skips the rest of the current node.
+ */
+void Reader::skip_subtree() {
+	if (token != NODE_BEGIN && token != ATTRIBUTE) return;
+
+	attr_index = attr_count = 0;
+
+	int ch;
+	while ((ch = parser.i.next()) != -1) {
+		switch (ch) {
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r':
+			break; // space (continue)
+
+		case '(':
+			while ((ch = parser.i.next()) != -1 && ch != ')') {
+				if (ch == '"' || ch == '\'') skip_string(ch);
+			}
+			break;
+
+		case '{': {
+			unsigned braces = 1;
+			while (braces && (ch = parser.i.next()) != -1) {
+				switch (ch) {
+				case '"':
+				case '\'':
+					skip_string(ch);
+					break;
+				case '/':
+				case '#':
+					skip_comment(ch);
+					break;
+				case '{': braces++; break;
+				case '}': braces--; break;
+				}
+			}
+			end_node();
+			return ;
+		}
+
+		default:
+			parser.i.back();
+			end_node();
+			return ;
+		}
+	}
+
+	end_node();
+}
+
+/**
+ * @brief Collects an attribute of the TAIL node.
+ *
+ * @param key The key of the attribute.
+ * @param value The value of the attribute.
+ */
+void Reader::on_attribute(std::string_view key, const Value &value) {
+	if (attr_count == attrs.size()) attrs.emplace_back();
+	attrs[attr_count].first.assign(key);
+	attrs[attr_count].second = value;
+	attr_count++;
+}
+
+/**
+ * @brief Keeps the text of the current comment.
+ *
+ * @param text The content of the comment.
+ */
+void Reader::on_comment(std::string_view text) {
+	current.set_string(std::string(text));
+}
+
+/**
+ * @brief Reads the next token after a node name.
+ * Follows Parser::parse_node().
+ *
+ * @return true If a token was read.
+ */
+bool Reader::read_tail() {
+	int ch;
+	while ((ch = parser.i.next()) != -1) {
+		switch (ch) {
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r':
+			break; // space (continue)
+
+		case '(':
+			if (attr_parsed) {
+				parser.fail(ParseError::DOUBLE_ATTRIBUTE_LIST);
+				throw ParserException(parser.error);
+			}
+			attr_index = attr_count = 0;
+			if (!parser.parse_node_attributes()) throw ParserException(parser.error);
+			attr_parsed = true;
+
+			if (attr_count) {
+				attr_index = 1;
+				token = ATTRIBUTE;
+				return true;
+			}
+			break;
+
+		case '{':
+			mode = CHILDREN;
+			return read_child();
+
+		default:
+			parser.i.back();
+			return end_node();
+		}
+	}
+
+	return end_node();
+}
+
+/**
+ * @brief Reads the next token in a children list.
+ * Follows Parser::parse_node() and Parser::parse_child().
+ *
+ * @return true If a token was read.
+ */
+bool Reader::read_child() {
+	int ch;
+	while ((ch = parser.i.next()) != -1) {
+		switch (ch) {
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r':
+			break; // space (continue)
+
+		case '/':
+		case '#':
+			parser.i.back();
+			if (!parser.parse_comment()) throw ParserException(parser.error);
+			token = COMMENT;
+			return true;
+
+		case '"':
+		case '\'':
+			if (!parser.parse_string(current)) throw ParserException(parser.error);
+			token = DATA;
+			return true;
+
+		// End of the children, or of the document at the top level
+		case '}':
+			if (open_nodes) return end_node();
+			mode = DONE;
+			token = END;
+			return false;
+
+		default:
+			if (parser.is_number_start(ch)) {
+				parser.i.back();
+				if (!parser.parse_number(current)) throw ParserException(parser.error);
+				// Data numbers may be followed by a ','
+				if (!parser.i.end() && parser.i.next() != ',') parser.i.back();
+				token = DATA;
+				return true;
+			} else if (parser.is_alpha(ch)) {
+				parser.i.back();
+				current_name = parser.parse_node_name();
+
+				// If keywords "true" or "false" isn't a node: it is boolean data.
+				if (current_name == "true" || current_name == "false") {
+					current.set_boolean(current_name == "true");
+					token = DATA;
+					return true;
+				}
+
+				if (!parser.i.end()) {
+					parser.i.back();
+					if (current_name.empty()) {
+						parser.fail(ParseError::EMPTY_NODE_NAME);
+						throw ParserException(parser.error);
+					}
+				}
+
+				open_nodes++;
+				mode = TAIL;
+				attr_parsed = false;
+				attr_index = attr_count = 0;
+				token = NODE_BEGIN;
+				return true;
+			} else {
+				parser.i.back();
+				parser.fail(ParseError::INVALID_CHILD);
+				throw ParserException(parser.error);
+			}
+		}
+	}
+
+	// End of data closes every open node.
+	if (open_nodes) return end_node();
+	mode = DONE;
+	token = END;
+	return false;
+}
+
+/**
+ * @brief Ends the current node.
+ *
+ * @return true Always, the token is NODE_END.
+ */
+bool Reader::end_node() {
+	open_nodes--;
+	mode = CHILDREN;
+	token = NODE_END;
+	return true;
+}
+
+/**
+ * @brief Skips characters until the end of a string.
+ *
+ * @param quote The quote that closes the string.
+ */
+void Reader::skip_string(int quote) {
+	int ch;
+	while ((ch = parser.i.next()) != -1 && ch != quote);
+}
+
+/**
+ * @brief Skips a comment once its first character was read.
+ *
+ * @param ch The first character of the comment.
+ */
+void Reader::skip_comment(int ch) {
+	if (ch == '/') {
+		ch = parser.i.next();
+		if (ch == '*') {
+			while ((ch = parser.i.next()) != -1) {
+				if (ch == '*' && ((ch = parser.i.next()) == '/' || ch == -1)) return ;
+			}
+			return ;
+		}
+		if (ch != '/') {
+			// Not a comment
+			if (ch != -1) parser.i.back();
+			return ;
+		}
+	}
+
+	while ((ch = parser.i.next()) != -1 && ch != '\n');
+}
+
+} // namespace dfml
@@ -0,0 +1,213 @@
+/**
+ * @file scanner.cpp
+ * @brief Implementation of the Scanner class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "scanner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include <dfml/structural_index.h>
+
+namespace dfml {
+
+/**
+ * @brief Scans the next piece of data.
+ *
+ * @param data The data to scan.
+ * @param size The size of the data.
+ */
+void Scanner::scan(const char *data, size_t size) {
+	for (size_t n = 0; n < size; n++, offset++) {
+		char ch = data[n];
+
+		switch (state) {
+		case STRING:
+			if (ch == quote) state = NORMAL;
+			break;
+
+		case LINE_COMMENT:
+			if (ch == '\n') state = NORMAL;
+			break;
+
+		case BLOCK_COMMENT:
+			if (ch == '*') state = BLOCK_STAR;
+			break;
+
+		case BLOCK_STAR:
+			// The character after '*' belongs to the comment unless it closes it.
+			state = (ch == '/') ? NORMAL : BLOCK_COMMENT;
+			break;
+
+		case SLASH:
+			if (ch == '/') {
+				state = LINE_COMMENT;
+				break;
+			} else if (ch == '*') {
+				state = BLOCK_COMMENT;
+				break;
+			}
+			// Not a comment: scan it as a normal character.
+			state = NORMAL;
+			[[fallthrough]];
+
+		case NORMAL:
+			switch (ch) {
+			case '"':
+			case '\'':
+				quote = ch;
+				state = STRING;
+				break;
+
+			case '{': braces++; break;
+			case '}': if (braces) braces--; break;
+			case '(': parens++; break;
+			case ')': if (parens) parens--; break;
+
+			case '#':
+				// Comments are not recognized inside attribute lists.
+				if (!parens) state = LINE_COMMENT;
+				break;
+			case '/':
+				if (!parens) state = SLASH;
+				break;
+			}
+			break;
+		}
+
+		if (state == NORMAL && !braces && !parens) {
+			mark = offset + 1;
+		}
+	}
+}
+
+/**
+ * @brief Splits a whole document in chunks of top level elements.
+ * The structural characters are classified a window at a time with
+ * StructuralIndex::classify() and followed bit by bit, skipping strings and
+ * comments as the Parser does.
+ *
+ * @param data The document.
+ * @param chunk_size Minimum size of the chunks.
+ * @param chunk Called for each chunk, in order, as soon as it is found.
+ */
+void Scanner::split(std::string_view data, size_t chunk_size,
+		const std::function<void(std::string_view)> &chunk) {
+	constexpr size_t BLOCK_SIZE = StructuralIndex::BLOCK_SIZE;
+	constexpr size_t WINDOW_BLOCKS = 64;
+
+	uint64_t structurals[WINDOW_BLOCKS], spaces[WINDOW_BLOCKS];
+	size_t blocks = (data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	size_t first_block = 0, block_count = 0;
+
+	// Loads the window of blocks starting at the given one
+	auto load = [&](size_t block) {
+		first_block = block;
+		block_count = std::min(WINDOW_BLOCKS, blocks - block);
+
+		size_t full = data.size() / BLOCK_SIZE;
+		size_t direct = std::min(block_count, full > block ? full - block : 0);
+		StructuralIndex::classify(data.data() + block * BLOCK_SIZE, direct, structurals, spaces);
+		if (direct < block_count) {
+			char tail[BLOCK_SIZE] = {};
+			size_t offset = (block + direct) * BLOCK_SIZE;
+			std::memcpy(tail, data.data() + offset, data.size() - offset);
+			StructuralIndex::classify(tail, 1, structurals + direct, spaces + direct);
+		}
+	};
+
+	size_t start = 0;
+	auto boundary = [&](size_t offset) {
+		if (offset - start < chunk_size || offset >= data.size()) return;
+		chunk(data.substr(start, offset - start));
+		start = offset;
+	};
+
+	// Skips to the character after the next ch, returns the data size if not found
+	auto skip_past = [&](char ch, size_t from) {
+		const void *found = from < data.size() ? std::memchr(data.data() + from, ch, data.size() - from) : nullptr;
+		return found ? static_cast<size_t>(static_cast<const char *>(found) - data.data()) + 1 : data.size();
+	};
+
+	unsigned braces = 0, parens = 0;
+	char quote = 0; // Quote closing the current string, 0 outside strings
+	size_t pos = 0;
+
+	while (pos < data.size()) {
+		size_t block = pos / BLOCK_SIZE;
+		if (block < first_block || block >= first_block + block_count) load(block);
+		uint64_t bits = structurals[block - first_block] & (~uint64_t(0) << (pos % BLOCK_SIZE));
+		pos = (block + 1) * BLOCK_SIZE;
+		bool skipped = false; // A comment moved the position
+
+		while (bits && !skipped) {
+			size_t at = block * BLOCK_SIZE + StructuralIndex::lowest_bit(bits);
+			bits &= bits - 1;
+			if (at >= data.size()) break;
+			char ch = data[at];
+
+			if (quote) {
+				if (ch == quote) quote = 0;
+				continue;
+			}
+
+			switch (ch) {
+			case '"':
+			case '\'':
+				quote = ch;
+				break;
+
+			case '{': braces++; break;
+
+			case '}':
+				if (!braces) break;
+				if (!--braces && !parens) boundary(at + 1);
+				break;
+
+			case '(': parens++; break;
+
+			case ')':
+				if (!parens) break;
+				if (!--parens && !braces) {
+					// The node ends unless its children follow
+					size_t next = at + 1;
+					while (next < data.size() && std::isspace(static_cast<unsigned char>(data[next]))) next++;
+					if (next < data.size() && data[next] != '{' && data[next] != '(') boundary(next);
+				}
+				break;
+
+			case '#':
+				// Comments are not recognized inside attribute lists.
+				if (!parens) {
+					pos = skip_past('\n', at + 1);
+					skipped = true;
+				}
+				break;
+
+			case '/':
+				if (parens || at + 1 >= data.size()) break;
+				if (data[at + 1] == '/') {
+					pos = skip_past('\n', at + 2);
+					skipped = true;
+				} else if (data[at + 1] == '*') {
+					// Up to "*/", the character after any other '*' belongs to the comment
+					pos = at + 2;
+					while ((pos = skip_past('*', pos)) < data.size() && data[pos++] != '/');
+					skipped = true;
+				}
+				break;
+			}
+		}
+	}
+
+	chunk(data.substr(start));
+}
+
+} // namespace dfml
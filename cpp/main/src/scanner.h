@@ -0,0 +1,82 @@
+/**
+ * @file scanner.h
+ * @brief Declaration of the Scanner class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+namespace dfml {
+
+/**
+ * @brief Quick structural scanner used to locate the top level of a document.
+ *
+ * It only follows braces, parentheses, strings and comments, keeping its state
+ * between calls so the data can be scanned in arbitrary pieces. It is a hint
+ * for the Parser, which always has the last word: it never validates anything.
+ */
+class Scanner {
+public:
+	/**
+	 * @brief Scans the next piece of data.
+	 *
+	 * @param data The data to scan.
+	 * @param size The size of the data.
+	 */
+	void scan(const char *data, size_t size);
+
+	/**
+	 * @brief Gets the count of scanned characters.
+	 *
+	 * @return size_t Offset of the next character to scan.
+	 */
+	size_t get_offset() const { return offset; }
+
+	/**
+	 * @brief Gets the offset just after the last character found at the top level.
+	 * A top level character is outside of any node children, attribute list,
+	 * string or comment.
+	 *
+	 * @return size_t Offset after the last top level character (0 if none).
+	 */
+	size_t get_top_level_mark() const { return mark; }
+
+	/**
+	 * @brief Splits a whole document in chunks of top level elements.
+	 * The chunks end after a '}' closing the children of a top level node, or
+	 * before the next element following the attribute list of one. Each chunk
+	 * is at least chunk_size bytes, except the last one.
+	 *
+	 * @param data The document.
+	 * @param chunk_size Minimum size of the chunks.
+	 * @param chunk Called for each chunk, in order, as soon as it is found.
+	 */
+	static void split(std::string_view data, size_t chunk_size,
+			const std::function<void(std::string_view)> &chunk);
+
+private:
+	enum state_t {
+		NORMAL,
+		SLASH,
+		LINE_COMMENT,
+		BLOCK_COMMENT,
+		BLOCK_STAR,
+		STRING
+	} state = NORMAL; /**< Current lexical state. */
+
+	size_t offset{};   /**< Count of scanned characters. */
+	size_t mark{};     /**< Offset after the last top level character. */
+	unsigned braces{}; /**< Open braces. */
+	unsigned parens{}; /**< Open parentheses. */
+	char quote{};      /**< Quote that closes the current string. */
+};
+
+} // namespace dfml
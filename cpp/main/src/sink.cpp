@@ -0,0 +1,88 @@
+/**
+ * @file sink.cpp
+ * @brief Implementation of the Sink classes in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/sink.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace dfml {
+
+/**
+ * @brief Destructor for the FdSink class. Writes the pending bytes, ignoring errors.
+ */
+FdSink::~FdSink() {
+	try {
+		flush();
+	} catch (...) {
+	}
+}
+
+/**
+ * @brief Writes bytes to the buffer, or directly when they don't fit.
+ *
+ * @param data The bytes to write.
+ * @param size The count of bytes.
+ * @throws std::runtime_error If the descriptor cannot be written.
+ */
+void FdSink::write(const char *data, size_t size) {
+	if (used + size > BUFFER_SIZE) {
+		flush();
+		if (size > BUFFER_SIZE) {
+			write_fd(data, size);
+			return;
+		}
+	}
+
+	std::memcpy(buffer + used, data, size);
+	used += size;
+}
+
+/**
+ * @brief Writes the pending bytes.
+ *
+ * @throws std::runtime_error If the descriptor cannot be written.
+ */
+void FdSink::flush() {
+	size_t size = used;
+	used = 0;
+	write_fd(buffer, size);
+}
+
+/**
+ * @brief Writes bytes to the descriptor, retrying partial writes.
+ *
+ * @param data The bytes to write.
+ * @param size The count of bytes.
+ */
+void FdSink::write_fd(const char *data, size_t size) {
+	while (size) {
+#ifdef _WIN32
+		int written = ::_write(fd, data, static_cast<unsigned>(size));
+#else
+		ssize_t written = ::write(fd, data, size);
+#endif
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			throw std::runtime_error(std::string("Unable to write file descriptor: ") + std::strerror(errno));
+		}
+		data += written;
+		size -= written;
+	}
+}
+
+} // namespace dfml
@@ -0,0 +1,244 @@
+/**
+ * @file structural_index.cpp
+ * @brief Implementation of the StructuralIndex class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-02-24
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/structural_index.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DFML_HAS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace dfml {
+
+namespace {
+
+/**
+ * @brief Character classes of the portable classification.
+ */
+enum : uint8_t {
+	STRUCTURAL = 1,
+	SPACE = 2
+};
+
+/**
+ * @brief Builds the class table of the portable classification.
+ */
+struct ClassTable {
+	uint8_t classes[256]{};
+
+	ClassTable() {
+		for (unsigned char ch : std::string_view("{}(),:\"'/#")) classes[ch] = STRUCTURAL;
+		for (unsigned char ch : std::string_view(" \t\n\r")) classes[ch] = SPACE;
+	}
+};
+
+/**
+ * @brief Portable classification, a byte at a time.
+ */
+void classify_scalar(const char *data, size_t blocks, uint64_t *structural, uint64_t *space) {
+	static const ClassTable table;
+
+	for (size_t b = 0; b < blocks; b++) {
+		uint64_t s = 0, w = 0;
+		for (size_t n = 0; n < StructuralIndex::BLOCK_SIZE; n++) {
+			uint8_t cls = table.classes[static_cast<unsigned char>(data[n])];
+			s |= uint64_t(cls & STRUCTURAL) << n;
+			w |= uint64_t((cls & SPACE) >> 1) << n;
+		}
+		structural[b] = s;
+		space[b] = w;
+		data += StructuralIndex::BLOCK_SIZE;
+	}
+}
+
+#ifdef DFML_HAS_X86_SIMD
+
+/**
+ * @brief SSE2 classification, 16 bytes at a time.
+ */
+__attribute__((target("sse2")))
+void classify_sse2(const char *data, size_t blocks, uint64_t *structural, uint64_t *space) {
+	const char structural_chars[] = "{}(),:\"'/#";
+	const char space_chars[] = " \t\n\r";
+
+	for (size_t b = 0; b < blocks; b++) {
+		uint64_t s = 0, w = 0;
+		for (size_t n = 0; n < StructuralIndex::BLOCK_SIZE; n += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + n));
+			__m128i sm = _mm_setzero_si128(), wm = _mm_setzero_si128();
+			for (size_t c = 0; c < sizeof(structural_chars) - 1; c++)
+				sm = _mm_or_si128(sm, _mm_cmpeq_epi8(v, _mm_set1_epi8(structural_chars[c])));
+			for (size_t c = 0; c < sizeof(space_chars) - 1; c++)
+				wm = _mm_or_si128(wm, _mm_cmpeq_epi8(v, _mm_set1_epi8(space_chars[c])));
+			s |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(sm))) << n;
+			w |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(wm))) << n;
+		}
+		structural[b] = s;
+		space[b] = w;
+		data += StructuralIndex::BLOCK_SIZE;
+	}
+}
+
+/**
+ * @brief AVX2 classification, 32 bytes at a time.
+ */
+__attribute__((target("avx2")))
+void classify_avx2(const char *data, size_t blocks, uint64_t *structural, uint64_t *space) {
+	const char structural_chars[] = "{}(),:\"'/#";
+	const char space_chars[] = " \t\n\r";
+
+	for (size_t b = 0; b < blocks; b++) {
+		uint64_t s = 0, w = 0;
+		for (size_t n = 0; n < StructuralIndex::BLOCK_SIZE; n += 32) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + n));
+			__m256i sm = _mm256_setzero_si256(), wm = _mm256_setzero_si256();
+			for (size_t c = 0; c < sizeof(structural_chars) - 1; c++)
+				sm = _mm256_or_si256(sm, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(structural_chars[c])));
+			for (size_t c = 0; c < sizeof(space_chars) - 1; c++)
+				wm = _mm256_or_si256(wm, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(space_chars[c])));
+			s |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(sm))) << n;
+			w |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(wm))) << n;
+		}
+		structural[b] = s;
+		space[b] = w;
+		data += StructuralIndex::BLOCK_SIZE;
+	}
+}
+
+#endif
+
+using classify_fn = void (*)(const char *, size_t, uint64_t *, uint64_t *);
+
+/**
+ * @brief Chooses the best classification for the processor.
+ *
+ * @param name Output name of the chosen classification.
+ * @return classify_fn The classification function.
+ */
+classify_fn select_classify(const char **name) {
+#ifdef DFML_HAS_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "avx2";
+		return classify_avx2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		*name = "sse2";
+		return classify_sse2;
+	}
+#endif
+	*name = "scalar";
+	return classify_scalar;
+}
+
+/**
+ * @brief Classification chosen for the processor.
+ */
+struct Dispatch {
+	const char *name;
+	classify_fn classify;
+
+	Dispatch() { classify = select_classify(&name); }
+};
+
+const Dispatch &dispatch() {
+	static const Dispatch instance;
+	return instance;
+}
+
+} // namespace
+
+/**
+ * @brief Finds the next structural character.
+ *
+ * @param pos Position to start from.
+ * @return size_t Position of the first structural character at or after pos,
+ * or the data size if there is none.
+ */
+size_t StructuralIndex::next_structural(size_t pos) {
+	while (pos < data.size()) {
+		size_t block = pos / BLOCK_SIZE;
+		uint64_t bits = word(block, false) & (~uint64_t(0) << (pos % BLOCK_SIZE));
+		if (bits) return std::min(block * BLOCK_SIZE + lowest_bit(bits), data.size());
+		pos = (block + 1) * BLOCK_SIZE;
+	}
+	return data.size();
+}
+
+/**
+ * @brief Finds the next character that isn't a space.
+ *
+ * @param pos Position to start from.
+ * @return size_t Position of the first non space character at or after pos,
+ * or the data size if there is none.
+ */
+size_t StructuralIndex::next_non_space(size_t pos) {
+	while (pos < data.size()) {
+		size_t block = pos / BLOCK_SIZE;
+		uint64_t bits = ~word(block, true) & (~uint64_t(0) << (pos % BLOCK_SIZE));
+		if (bits) return std::min(block * BLOCK_SIZE + lowest_bit(bits), data.size());
+		pos = (block + 1) * BLOCK_SIZE;
+	}
+	return data.size();
+}
+
+/**
+ * @brief Gets the name of the classification code used on this processor.
+ *
+ * @return const char* "avx2", "sse2" or "scalar".
+ */
+const char *StructuralIndex::implementation() {
+	return dispatch().name;
+}
+
+/**
+ * @brief Classifies blocks of data.
+ *
+ * @param data Data to classify, a multiple of BLOCK_SIZE bytes.
+ * @param blocks Count of blocks.
+ * @param structural Output bitmap of structural characters, a word per block.
+ * @param space Output bitmap of spaces, a word per block.
+ */
+void StructuralIndex::classify(const char *data, size_t blocks, uint64_t *structural, uint64_t *space) {
+	dispatch().classify(data, blocks, structural, space);
+}
+
+/**
+ * @brief Loads the window starting at the given block.
+ * The last block is padded with zeros, which are in no class.
+ *
+ * @param block First block of the window.
+ */
+void StructuralIndex::load(size_t block) {
+	size_t total = (data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	size_t full = data.size() / BLOCK_SIZE;
+
+	first_block = block;
+	block_count = std::min(WINDOW_BLOCKS, total - block);
+
+	size_t direct = std::min(block_count, full > block ? full - block : 0);
+	classify(data.data() + block * BLOCK_SIZE, direct, structurals, spaces);
+
+	if (direct < block_count) {
+		char tail[BLOCK_SIZE] = {};
+		size_t offset = (block + direct) * BLOCK_SIZE;
+		std::memcpy(tail, data.data() + offset, data.size() - offset);
+		classify(tail, 1, structurals + direct, spaces + direct);
+	}
+}
+
+} // namespace dfml
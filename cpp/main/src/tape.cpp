@@ -0,0 +1,471 @@
+/**
+ * @file tape.cpp
+ * @brief Implementation of the Tape, NodeRef and ValueRef classes in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-09
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/tape.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include <dfml/element.h>
+#include <dfml/mapped_file.h>
+#include <dfml/sink.h>
+#include <dfml/value.h>
+
+namespace dfml {
+
+namespace {
+
+/**
+ * @brief Reports an invalid tape.
+ */
+[[noreturn]] void corrupt(const char *reason) {
+	throw std::runtime_error(std::string("Corrupt DFML tape file: ") + reason);
+}
+
+} // namespace
+
+/**
+ * @brief Gets the type of the value.
+ *
+ * @return int The type of the value (Value::STRING, INTEGER, DOUBLE or BOOLEAN).
+ */
+int ValueRef::get_type() const {
+	if (!tape) return Value::STRING;
+
+	switch (tape->tag(index)) {
+	case Tape::INTEGER: return Value::INTEGER;
+	case Tape::DOUBLE: return Value::DOUBLE;
+	case Tape::BOOLEAN: return Value::BOOLEAN;
+	default: return Value::STRING;
+	}
+}
+
+/**
+ * @brief Gets the data of a string value.
+ *
+ * @return std::string_view The string data, valid while the tape lives.
+ * @throws std::bad_variant_access If the value is not a string.
+ */
+std::string_view ValueRef::get_string() const {
+	if (!tape) return std::string_view();
+	if (tape->tag(index) != Tape::STRING) throw std::bad_variant_access();
+	return tape->string_at(tape->payload(index));
+}
+
+/**
+ * @brief Gets the data of an integer value.
+ *
+ * @return long The integer data.
+ * @throws std::bad_variant_access If the value is not an integer.
+ */
+long ValueRef::get_integer() const {
+	if (!tape || tape->tag(index) != Tape::INTEGER) throw std::bad_variant_access();
+	return static_cast<long>(tape->entry(index + 1));
+}
+
+/**
+ * @brief Gets the data of a double value.
+ *
+ * @return double The double data.
+ * @throws std::bad_variant_access If the value is not a double.
+ */
+double ValueRef::get_double() const {
+	if (!tape || tape->tag(index) != Tape::DOUBLE) throw std::bad_variant_access();
+	double data;
+	uint64_t bits = tape->entry(index + 1);
+	std::memcpy(&data, &bits, sizeof(data));
+	return data;
+}
+
+/**
+ * @brief Gets the data of a boolean value.
+ *
+ * @return bool The boolean data.
+ * @throws std::bad_variant_access If the value is not a boolean.
+ */
+bool ValueRef::get_boolean() const {
+	if (!tape || tape->tag(index) != Tape::BOOLEAN) throw std::bad_variant_access();
+	return tape->payload(index) != 0;
+}
+
+/**
+ * @brief Copies the value to a Value object.
+ *
+ * @return Value The copied value.
+ */
+Value ValueRef::to_value() const {
+	Value value;
+
+	switch (get_type()) {
+	case Value::INTEGER: value.set_integer(get_integer()); break;
+	case Value::DOUBLE: value.set_double(get_double()); break;
+	case Value::BOOLEAN: value.set_boolean(get_boolean()); break;
+	default: value.set_string(get_string()); break;
+	}
+
+	return value;
+}
+
+/**
+ * @brief Gets the count of tape entries used by the value.
+ *
+ * @return size_t 1 or 2 entries.
+ */
+size_t ValueRef::entry_count() const {
+	uint64_t tag = tape->tag(index);
+	return tag == Tape::INTEGER || tag == Tape::DOUBLE ? 2 : 1;
+}
+
+/**
+ * @brief Gets the current attribute.
+ *
+ * @return value_type The key and value of the attribute.
+ */
+NodeRef::AttributeIterator::value_type NodeRef::AttributeIterator::operator*() const {
+	return value_type(tape->string_at(tape->payload(index)), ValueRef(tape, index + 1));
+}
+
+/**
+ * @brief Moves to the next attribute.
+ *
+ * @return AttributeIterator& This iterator.
+ */
+NodeRef::AttributeIterator &NodeRef::AttributeIterator::operator++() {
+	index += 1 + ValueRef(tape, index + 1).entry_count();
+	return *this;
+}
+
+/**
+ * @brief Gets the type of the element.
+ *
+ * @return int The element type (Element::NODE, DATA or COMMENT).
+ */
+int NodeRef::get_element_type() const {
+	switch (tape->tag(index)) {
+	case Tape::NODE: return Element::NODE;
+	case Tape::COMMENT: return Element::COMMENT;
+	default: return Element::DATA;
+	}
+}
+
+/**
+ * @brief Gets the name of a node.
+ *
+ * @return std::string_view The name, valid while the tape lives.
+ */
+std::string_view NodeRef::get_name() const {
+	if (tape->tag(index) != Tape::NODE) return std::string_view();
+	return tape->string_at(tape->payload(index));
+}
+
+/**
+ * @brief Gets the attributes of a node in document order.
+ *
+ * @return AttributeRange The attributes.
+ */
+NodeRef::AttributeRange NodeRef::get_attributes() const {
+	if (tape->tag(index) != Tape::NODE) return AttributeRange(tape, index, index);
+	return AttributeRange(tape, index + 2, children_index());
+}
+
+/**
+ * @brief Gets the value of an attribute given its name.
+ * If the key is repeated the last value is used, as in Node.
+ *
+ * @param name The name of the attribute.
+ * @return ValueRef The value, or an empty ValueRef if there is no such attribute.
+ */
+ValueRef NodeRef::get_attr(std::string_view name) const {
+	ValueRef result;
+
+	for (auto attribute : get_attributes()) {
+		if (attribute.first == name) result = attribute.second;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Gets the children of a node.
+ *
+ * @return Range The children, empty for data and comments.
+ */
+NodeRef::Range NodeRef::get_children() const {
+	if (tape->tag(index) != Tape::NODE) return Range(tape, index, index);
+	return Range(tape, children_index(), tape->entry(index + 1));
+}
+
+/**
+ * @brief Gets the content of a comment.
+ *
+ * @return std::string_view The content, valid while the tape lives.
+ */
+std::string_view NodeRef::get_string() const {
+	if (tape->tag(index) != Tape::COMMENT) return std::string_view();
+	return tape->string_at(tape->payload(index));
+}
+
+/**
+ * @brief Gets the index of the next sibling.
+ *
+ * @return size_t The index of the entry following the element.
+ */
+size_t NodeRef::next_index() const {
+	switch (tape->tag(index)) {
+	case Tape::NODE: return tape->entry(index + 1);
+	case Tape::COMMENT: return index + 1;
+	default: return index + ValueRef(tape, index).entry_count();
+	}
+}
+
+/**
+ * @brief Gets the index of the first child, after the attributes.
+ *
+ * @return size_t The index of the first child entry.
+ */
+size_t NodeRef::children_index() const {
+	size_t end = tape->entry(index + 1);
+	size_t i = index + 2;
+
+	while (i < end && tape->tag(i) == Tape::ATTRIBUTE) {
+		i += 1 + ValueRef(tape, i + 1).entry_count();
+	}
+
+	return i;
+}
+
+/**
+ * @brief Gets a string of the string buffer.
+ *
+ * @param offset Offset of the length prefix of the string.
+ * @return std::string_view The string.
+ */
+std::string_view Tape::string_at(uint64_t offset) const {
+	uint32_t length;
+	std::memcpy(&length, string_data + offset, sizeof(length));
+	return std::string_view(string_data + offset + sizeof(length), length);
+}
+
+/**
+ * @brief Checks that the entries form a valid tree and that the strings are
+ * inside the string buffer. The entries are walked once, keeping the end of
+ * the open nodes on a stack.
+ *
+ * @throws std::runtime_error If the tape is not valid.
+ */
+void Tape::check() const {
+	auto check_string = [this](uint64_t offset) {
+		uint32_t length;
+		if (offset > string_size || string_size - offset < sizeof(length)) corrupt("string out of the file");
+		std::memcpy(&length, string_data + offset, sizeof(length));
+		if (length > string_size - offset - sizeof(length)) corrupt("string out of the file");
+	};
+
+	// Checks the value at an index before an end, returning the index after it
+	auto check_value = [this, &check_string](size_t index, size_t end) -> size_t {
+		switch (tag(index)) {
+		case STRING: check_string(payload(index)); return index + 1;
+		case BOOLEAN: return index + 1;
+		case INTEGER:
+		case DOUBLE:
+			if (end - index < 2) corrupt("value data out of its node");
+			return index + 2;
+		default: corrupt("unknown entry");
+		}
+	};
+
+	std::vector<size_t> ends{entry_count};
+	size_t index = 0;
+
+	while (true) {
+		size_t end = ends.back();
+		if (index == end) {
+			ends.pop_back();
+			if (ends.empty()) return;
+			continue;
+		}
+
+		switch (tag(index)) {
+		case NODE: {
+			check_string(payload(index));
+			if (end - index < 2) corrupt("node out of its parent");
+			uint64_t last = entry(index + 1);
+			if (last < index + 2 || last > end) corrupt("node end out of its parent");
+
+			for (index += 2; index < last && tag(index) == ATTRIBUTE;) {
+				check_string(payload(index));
+				if (last - index < 2) corrupt("attribute without value");
+				index = check_value(index + 1, last);
+			}
+			ends.push_back(last);
+			break;
+		}
+
+		case COMMENT:
+			check_string(payload(index));
+			index++;
+			break;
+
+		default:
+			index = check_value(index, end);
+		}
+	}
+}
+
+/**
+ * @brief Opens a tape saved by save(), mapping the file.
+ *
+ * @param path Path of the file.
+ * @param verify Check every entry and string too, not only the header and size.
+ * @return std::shared_ptr<Tape> The tape, reading the mapped file.
+ * @throws std::runtime_error If the file cannot be mapped or is not a valid saved tape.
+ */
+std::shared_ptr<Tape> Tape::open(const std::string path, bool verify) {
+	return open(MappedFile::open(path), verify);
+}
+
+/**
+ * @brief Opens a tape saved by save() in a mapped file.
+ * Without verify only the header and size are read, so the pages are
+ * loaded as the elements are visited.
+ *
+ * @param file The mapped file, kept alive by the tape.
+ * @param verify Check every entry and string too, not only the header and size.
+ * @return std::shared_ptr<Tape> The tape, reading the mapped file.
+ * @throws std::runtime_error If the file is not a valid saved tape.
+ */
+std::shared_ptr<Tape> Tape::open(std::shared_ptr<MappedFile> file, bool verify) {
+	Header header;
+	if (file->size() < sizeof(header)) throw std::runtime_error("Not a DFML tape file");
+	std::memcpy(&header, file->data(), sizeof(header));
+
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) throw std::runtime_error("Not a DFML tape file");
+	if (header.order != ORDER) throw std::runtime_error("DFML tape file of another byte order or version");
+	if (header.entries > (file->size() - sizeof(header)) / sizeof(uint64_t) ||
+			header.strings != file->size() - sizeof(header) - header.entries * sizeof(uint64_t)) {
+		throw std::runtime_error("Truncated DFML tape file");
+	}
+	if (reinterpret_cast<uintptr_t>(file->data()) % alignof(uint64_t)) {
+		throw std::runtime_error("Misaligned DFML tape data");
+	}
+
+	auto tape = std::make_shared<Tape>();
+	tape->entry_data = reinterpret_cast<const uint64_t *>(file->data() + sizeof(header));
+	tape->entry_count = header.entries;
+	tape->string_data = file->data() + sizeof(header) + header.entries * sizeof(uint64_t);
+	tape->string_size = header.strings;
+	tape->file = std::move(file);
+	if (verify) tape->check();
+	return tape;
+}
+
+/**
+ * @brief Writes the tape in the format read by open().
+ * The entries are written in the native byte order.
+ *
+ * @param sink The output.
+ */
+void Tape::save(Sink &sink) const {
+	Header header{{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]}, ORDER, entry_count, string_size};
+
+	sink.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	sink.write(reinterpret_cast<const char *>(entry_data), entry_count * sizeof(uint64_t));
+	sink.write(string_data, string_size);
+	sink.flush();
+}
+
+/**
+ * @brief Gets the memory used by the entries and the strings.
+ * For opened tapes this is the size of the mapped file.
+ *
+ * @return size_t Size in bytes.
+ */
+size_t Tape::memory_size() const {
+	if (file) return file->size();
+	return entries.capacity() * sizeof(uint64_t) + strings.capacity();
+}
+
+void TapeHandler::on_node_begin(std::string_view name) {
+	nodes.push_back(tape->entries.size());
+	add(Tape::NODE, add_string(name));
+	add(0, 0); // Index after the last child, set by on_node_end()
+}
+
+void TapeHandler::on_attribute(std::string_view key, const Value &value) {
+	add(Tape::ATTRIBUTE, add_string(key));
+	add_value(value);
+}
+
+void TapeHandler::on_data(const Value &value) {
+	add_value(value);
+}
+
+void TapeHandler::on_comment(std::string_view text) {
+	add(Tape::COMMENT, add_string(text));
+}
+
+void TapeHandler::on_node_end() {
+	tape->entries[nodes.back() + 1] = tape->entries.size();
+	nodes.pop_back();
+}
+
+/**
+ * @brief Adds the entries of a value.
+ *
+ * @param value The value.
+ */
+void TapeHandler::add_value(const Value &value) {
+	switch (value.get_type()) {
+	case Value::INTEGER:
+		add(Tape::INTEGER, 0);
+		tape->entries.push_back(static_cast<uint64_t>(value.get_integer()));
+		break;
+
+	case Value::DOUBLE: {
+		uint64_t data;
+		double dbl = value.get_double();
+		std::memcpy(&data, &dbl, sizeof(data));
+		add(Tape::DOUBLE, 0);
+		tape->entries.push_back(data);
+		break;
+	}
+
+	case Value::BOOLEAN:
+		add(Tape::BOOLEAN, value.get_boolean() ? 1 : 0);
+		break;
+
+	default:
+		add(Tape::STRING, add_string(value.get_string()));
+	}
+}
+
+/**
+ * @brief Adds a string to the string buffer.
+ *
+ * @param string The string.
+ * @return uint64_t The offset of the string.
+ * @throws std::length_error If the string is longer than Tape::MAX_STRING_LENGTH.
+ */
+uint64_t TapeHandler::add_string(std::string_view string) {
+	if (string.size() > Tape::MAX_STRING_LENGTH) {
+		throw std::length_error("String too long for a DFML tape");
+	}
+
+	uint64_t offset = tape->strings.size();
+	uint32_t length = static_cast<uint32_t>(string.size());
+
+	tape->strings.append(reinterpret_cast<const char *>(&length), sizeof(length));
+	tape->strings.append(string);
+	return offset;
+}
+
+} // namespace dfml
@@ -0,0 +1,83 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Implementation of the ThreadPool class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-04-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/thread_pool.h>
+
+#include <algorithm>
+
+namespace dfml {
+
+/**
+ * @brief Constructor for the ThreadPool class. Starts the workers.
+ *
+ * @param threads Count of workers, 0 for one per hardware thread.
+ */
+ThreadPool::ThreadPool(unsigned threads) {
+	if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+
+	workers.reserve(threads);
+	for (unsigned n = 0; n < threads; n++) workers.emplace_back([this]() { work(); });
+}
+
+/**
+ * @brief Destructor for the ThreadPool class.
+ * Runs the pending tasks and joins the workers.
+ */
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	available.notify_all();
+
+	for (auto &worker : workers) worker.join();
+}
+
+/**
+ * @brief Creates and returns a shared pointer to a ThreadPool instance.
+ *
+ * @param threads Count of workers, 0 for one per hardware thread.
+ * @return std::shared_ptr<ThreadPool> Shared pointer to the new ThreadPool instance.
+ */
+std::shared_ptr<ThreadPool> ThreadPool::create(unsigned threads) {
+	return std::make_shared<ThreadPool>(threads);
+}
+
+/**
+ * @brief Queues a task and wakes a worker.
+ *
+ * @param task The task.
+ */
+void ThreadPool::push(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(std::move(task));
+	}
+	available.notify_one();
+}
+
+/**
+ * @brief Runs the queued tasks until the pool is destroyed.
+ */
+void ThreadPool::work() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (tasks.empty()) return;
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+} // namespace dfml
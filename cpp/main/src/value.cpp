@@ -10,52 +10,81 @@
 
 #include <dfml/value.h>
 
-#include <sstream>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 
 namespace dfml {
 
 /**
- * @brief Sets the value as a string.
+ * @brief Copies a value, allocating its string from the given resource.
  * 
- * @param value The string data to set.
+ * @param value The value to copy.
+ * @param resource The memory resource of the string.
  */
-void Value::set_string(std::string value) {
-	this->type = Value::STRING;
-	this->value = value;
+Value::Value(const Value &value, std::pmr::memory_resource *resource) {
+	if (value.get_type() == Value::STRING) data.emplace<std::pmr::string>(value.get_string(), resource);
+	else data = value.data;
 }
 
 /**
- * @brief Sets the value as an integer.
+ * @brief Sets the value as a string.
+ * A string value keeps its memory resource.
  * 
- * @param value The integer data to set.
+ * @param data The string data to set.
  */
-void Value::set_integer(long value) {
-	this->type = Value::INTEGER;
-	std::stringstream ss;
-	ss << value;
-	this->value = ss.str();
+void Value::set_string(std::string_view data) {
+	if (auto string = std::get_if<std::pmr::string>(&this->data)) string->assign(data);
+	else this->data.emplace<std::pmr::string>(data);
 }
 
 /**
- * @brief Sets the value as a double.
+ * @brief Gets the string representation of the value.
  * 
- * @param value The double data to set.
+ * @return const std::string The string representation of the value.
  */
-void Value::set_double(double value) {
-	this->type = Value::DOUBLE;
-	std::stringstream ss;
-	ss << value;
-	this->value = ss.str();
+const std::string Value::get_value() const {
+	if (get_type() == Value::STRING) return std::string(get_string());
+
+	char buffer[TEXT_SIZE];
+	return std::string(buffer, to_chars(buffer));
 }
 
 /**
- * @brief Sets the value as a boolean.
+ * @brief Writes the text of an integer, double or boolean value.
+ * Doubles use the shortest text that reads back to the same double,
+ * with ".0" appended to integral values so they still read as doubles.
  * 
- * @param value The boolean data to set.
+ * @param first Start of the output, at least TEXT_SIZE bytes.
+ * @return char* End of the written text.
  */
-void Value::set_boolean(bool value) {
-	this->type = Value::BOOLEAN;
-	this->value = value ? "true" : "false";
+char *Value::to_chars(char *first) const {
+	char *last = first + TEXT_SIZE;
+	char *end;
+
+	switch (get_type()) {
+	case Value::INTEGER:
+		return std::to_chars(first, last, get_integer()).ptr;
+
+	case Value::DOUBLE: {
+		double value = get_double();
+		end = std::to_chars(first, last, value).ptr;
+		if (!std::memchr(first, '.', end - first) && !std::memchr(first, 'e', end - first) &&
+				std::isfinite(value)) {
+			*end++ = '.';
+			*end++ = '0';
+		}
+		return end;
+	}
+
+	case Value::BOOLEAN:
+		end = first;
+		for (const char *text = get_boolean() ? "true" : "false"; *text; text++) *end++ = *text;
+		return end;
+
+	default:
+		return first;
+	}
 }
 
 } // namespace dfml
@@ -0,0 +1,166 @@
+/**
+ * @file writer.cpp
+ * @brief Implementation of the Writer class in the context of the Dragonfly Markup Language (DFML).
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @date 2024-03-30
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <dfml/writer.h>
+
+#include <dfml/sink.h>
+#include <dfml/value.h>
+
+namespace dfml {
+
+/**
+ * @brief Creates and returns a shared pointer to a Writer instance.
+ *
+ * @param sink The output, which must outlive the writer.
+ * @return std::shared_ptr<Writer> Shared pointer to the new Writer instance.
+ */
+std::shared_ptr<Writer> Writer::create(Sink &sink) {
+	return std::make_shared<Writer>(sink);
+}
+
+/**
+ * @brief Starts a node. Its attributes and children follow, then end_node().
+ *
+ * @param name The name of the node.
+ * @throws WriterException If the name is empty or the writer is finished.
+ */
+void Writer::begin_node(std::string_view name) {
+	check_open();
+	if (name.empty()) throw WriterException("Empty node name");
+
+	begin_element();
+	builder.write_indent(sink, nodes.size());
+	sink.write(name);
+	nodes.push_back(Frame{false, false});
+}
+
+/**
+ * @brief Writes an attribute of the current node.
+ *
+ * @param key The key of the attribute.
+ * @param value The value of the attribute.
+ * @throws WriterException If there is no node, or it already has children.
+ */
+void Writer::attribute(std::string_view key, const Value &value) {
+	if (nodes.empty()) throw WriterException("Attribute outside of a node: " + std::string(key));
+	if (nodes.back().children) throw WriterException("Attribute after the node children: " + std::string(key));
+	if (key.empty()) throw WriterException("Empty attribute key");
+
+	Frame &node = nodes.back();
+	sink.write(node.attributes ? ", " : "(");
+	node.attributes = true;
+	sink.write(key);
+	sink.write(": ");
+	builder.write_value(value, sink);
+}
+
+/**
+ * @brief Writes a data element.
+ *
+ * @param value The value of the data.
+ * @throws WriterException If the writer is finished.
+ */
+void Writer::data(const Value &value) {
+	check_open();
+	begin_element();
+	builder.write_indent(sink, nodes.size());
+	builder.write_value(value, sink);
+	end_element();
+}
+
+/**
+ * @brief Writes a comment.
+ *
+ * @param text The content of the comment.
+ * @throws WriterException If the writer is finished.
+ */
+void Writer::comment(std::string_view text) {
+	check_open();
+	begin_element();
+	builder.write_indent(sink, nodes.size());
+	sink.write("/*");
+	sink.write(text);
+	sink.write("*/");
+	end_element();
+}
+
+/**
+ * @brief Ends the current node.
+ *
+ * @throws WriterException If there is no node to end.
+ */
+void Writer::end_node() {
+	if (nodes.empty()) throw WriterException("end_node() without an open node");
+
+	Frame node = nodes.back();
+	nodes.pop_back();
+
+	if (node.attributes && !node.children) sink.write(")");
+	if (node.children) {
+		builder.write_indent(sink, nodes.size());
+		sink.write("}");
+	}
+	end_element();
+}
+
+/**
+ * @brief Flushes the sink.
+ */
+void Writer::flush() {
+	sink.flush();
+}
+
+/**
+ * @brief Ends the document and flushes the sink.
+ *
+ * @throws WriterException If some node was not ended.
+ */
+void Writer::finish() {
+	if (!nodes.empty()) {
+		throw WriterException("finish() with " + std::to_string(nodes.size()) + " open nodes");
+	}
+	finished = true;
+	sink.flush();
+}
+
+/**
+ * @brief Starts an element: closes the attribute list and opens the
+ * children of the current node, or separates top level elements.
+ */
+void Writer::begin_element() {
+	if (nodes.empty()) {
+		if (top_level_written) sink.write(builder.format ? "\n" : " ");
+		top_level_written = true;
+		return;
+	}
+
+	Frame &node = nodes.back();
+	if (!node.children) {
+		if (node.attributes) sink.write(")");
+		sink.write(builder.format ? " {\n" : " { ");
+		node.children = true;
+	}
+}
+
+/**
+ * @brief Ends an element, writing the separator of the children.
+ */
+void Writer::end_element() {
+	if (!nodes.empty()) sink.write(builder.format ? "\n" : " ");
+}
+
+/**
+ * @brief Throws if the writer was finished.
+ */
+void Writer::check_open() const {
+	if (finished) throw WriterException("Writer already finished");
+}
+
+} // namespace dfml
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <fstream>
+
+#include <dfml/binary.h>
+#include <dfml/parser.h>
+#include <dfml/builder.h>
+#include <dfml/sink.h>
+#include <dfml/dfml.h>
+
+TEST_SUITE("Binary") {
+	TEST_CASE("Round trip") {
+		for (auto name : {"parsing.dfml", "parsed.dfml", "doubles.dfml"}) {
+			std::ifstream file(std::string("../test/dfml/") + name);
+			std::string text = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			text += "\n/*tail*/ -12 1e300 -0.0 true false empty {} last(a: 'x', b: 2.5, c: false)";
+
+			auto builder = dfml::Builder::create();
+			auto elements = dfml::Parser::create(text)->parse();
+			std::string expected;
+			for (auto &e : elements) expected += builder->build_element(e) + "\n";
+
+			// Encoding the tree and encoding while parsing give the same data
+			dfml::BufferSink tree_sink;
+			dfml::BinaryEncoder tree_encoder(tree_sink);
+			for (auto &e : elements) tree_encoder.write(*e);
+			tree_encoder.finish();
+
+			dfml::BufferSink sink;
+			auto encoder = dfml::BinaryEncoder::create(sink);
+			dfml::Parser::create(text)->parse(*encoder);
+			encoder->finish();
+
+			std::string binary = sink.take();
+			CHECK_EQ(tree_sink.get_buffer(), binary);
+
+			std::string result;
+			for (auto &e : dfml::BinaryDecoder::create(std::string_view(binary))->decode()) {
+				result += builder->build_element(e) + "\n";
+			}
+			CHECK_EQ(result, expected);
+
+			result.clear();
+			auto document = dfml::BinaryDecoder::create(binary)->decode_document();
+			for (auto &e : document->get_elements()) {
+				result += builder->build_element(e) + "\n";
+			}
+			CHECK_EQ(result, expected);
+		}
+	}
+
+	TEST_CASE("String table") {
+		dfml::BufferSink sink;
+		dfml::BinaryEncoder encoder(sink);
+		auto node = dfml::Node::create("item");
+		node->set_attr_integer("id", 1);
+		for (int n = 0; n < 3; n++) encoder.write(*node);
+		encoder.finish();
+
+		// Magic, then the first node spells "item" and "id", the others refer to them.
+		std::string first = std::string("\x01\x00\x04item\x02\x00\x02id\x11", 13) + std::string("\x01\0\0\0\0\0\0\0\x03", 9);
+		std::string next = std::string("\x01\x01\x02\x02\x11", 5) + std::string("\x01\0\0\0\0\0\0\0\x03", 9);
+		CHECK_EQ(sink.get_buffer(), std::string(dfml::binary::MAGIC) + first + next + next);
+
+		auto elements = dfml::BinaryDecoder::create(sink.get_buffer())->decode();
+		CHECK_EQ(elements.size(), 3);
+		auto last = std::static_pointer_cast<dfml::Node>(elements.back());
+		CHECK_EQ(last->get_name(), "item");
+		CHECK_EQ(last->get_attr("id").get_integer(), 1);
+	}
+
+	TEST_CASE("Invalid data") {
+		std::string magic(dfml::binary::MAGIC);
+
+		CHECK_THROWS_AS(dfml::BinaryDecoder::create(std::string("node"))->decode(), dfml::ParserException);
+		CHECK_NOTHROW(dfml::BinaryDecoder::create(magic)->decode());
+		CHECK_THROWS_AS(dfml::BinaryDecoder::create(magic + "\x01\x00\x01n")->decode(), dfml::ParserException);
+		CHECK_THROWS_AS(dfml::BinaryDecoder::create(magic + "\x03")->decode(), dfml::ParserException);
+		CHECK_THROWS_AS(dfml::BinaryDecoder::create(magic + "\x01\x05")->decode(), dfml::ParserException);
+		CHECK_THROWS_AS(dfml::BinaryDecoder::create(magic + "\x10\x09" "abc")->decode(), dfml::ParserException);
+		CHECK_THROWS_AS(dfml::BinaryDecoder::create(magic + "\x11\x01")->decode(), dfml::ParserException);
+		CHECK_THROWS_AS(dfml::BinaryDecoder::create(magic + "\x7f")->decode(), dfml::ParserException);
+		CHECK_THROWS_AS(dfml::BinaryDecoder::create(magic + "\x14\x02\x01x\x14")->decode(), dfml::ParserException);
+	}
+}
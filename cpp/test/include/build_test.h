@@ -4,9 +4,15 @@
 
 #include <dfml/builder.h>
 #include <dfml/dfml.h>
+#include <dfml/parser.h>
+#include <dfml/sink.h>
 
+#include <cstdio>
+#include <fstream>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 TEST_SUITE("Builder") {
 
@@ -203,6 +209,32 @@ TEST_CASE("Use spaces") {
 	builder->use_spaces_for_indent(true);
 	builder->set_space_count(3);
 	CHECK_EQ(builder->build_node(animals), ss.str());
+
+	// Indentation wider than a run, from threads sharing the builder
+	auto root = dfml::Node::create("level");
+	auto last = root;
+	std::string expected = "level {\n";
+	for (int n = 1; n < 30; n++) {
+		auto node = dfml::Node::create("level");
+		last->add_child(node);
+		last = node;
+		expected += std::string(n * 3, ' ') + "level" + (n < 29 ? " {\n" : "\n");
+	}
+	for (int n = 28; n >= 0; n--) expected += std::string(n * 3, ' ') + "}" + (n ? "\n" : "");
+
+	std::vector<std::thread> threads;
+	std::vector<int> same(4);
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&builder, &root, &expected, &same, t]() {
+			for (int n = 0; n < 200; n++) {
+				dfml::BufferSink sink;
+				builder->write(*root, sink);
+				if (sink.take() == expected) same[t]++;
+			}
+		});
+	}
+	for (auto &thread : threads) thread.join();
+	for (int count : same) CHECK_EQ(count, 200);
 }
 
 TEST_CASE("String quotes") {
@@ -212,4 +244,272 @@ TEST_CASE("String quotes") {
 	CHECK_EQ(builder->build_node(node), "test_node {\n\t\'\"test\"\'\n}");
 }
 
+TEST_CASE("Attribute map") {
+	auto node = dfml::Node::create("node");
+	for (int n = 0; n < 100; n++) node->set_attr_integer("key" + std::to_string(n), n);
+	node->set_attr_string("key50", "changed");
+
+	CHECK_EQ(node->get_attr_keys().size(), 100);
+	int n = 0;
+	for (auto key : node->get_attr_keys()) {
+		CHECK_EQ(key, "key" + std::to_string(n++));
+	}
+
+	CHECK(node->has_attr(std::string_view("key99")));
+	CHECK_FALSE(node->has_attr("key100"));
+	CHECK_EQ(node->get_attr("key7").get_integer(), 7);
+	CHECK_EQ(node->get_attr("key50").get_string(), "changed");
+	CHECK_EQ(node->get_attributes().find("key100"), nullptr);
+
+	auto small = dfml::Node::create("small");
+	small->set_attr_boolean("a", true);
+	small->set_attr_double("b", 2.5);
+	small->set_attr_boolean("a", false);
+	CHECK_EQ(dfml::Builder::create()->build_node(small), "small(a: false, b: 2.5)");
+
+	CHECK_EQ(small->get_attr("c").get_string(), "");
+	CHECK(small->has_attr("c"));
+}
+
+TEST_CASE("Attribute read") {
+	auto parsed = dfml::Parser::create("node(id: 7, ratio: 0.5, on: true, name: 'main')")->parse();
+	std::shared_ptr<const dfml::Node> node = std::static_pointer_cast<dfml::Node>(parsed.front());
+
+	REQUIRE(node->find_attr("id") != nullptr);
+	CHECK_EQ(node->find_attr("id")->get_integer(), 7);
+	CHECK_EQ(node->find_attr("missing"), nullptr);
+
+	dfml::Value fallback;
+	fallback.set_integer(-1);
+	CHECK_EQ(node->get_attr_or("id", fallback).get_integer(), 7);
+	CHECK_EQ(&node->get_attr_or("missing", fallback), &fallback);
+
+	CHECK_EQ(node->attr<long>("id"), 7);
+	CHECK_EQ(node->attr<double>("ratio"), 0.5);
+	CHECK_EQ(node->attr<bool>("on"), true);
+	CHECK_EQ(node->attr<std::string_view>("name"), "main");
+	CHECK_EQ(node->attr<std::string>("name"), "main");
+	CHECK_FALSE(node->attr<long>("missing"));
+	CHECK_FALSE(node->attr<std::string>("id"));
+	CHECK_FALSE(node->attr<double>("id"));
+	CHECK_EQ(node->attr<long>("ratio").value_or(3), 3);
+
+	// The lookups never add attributes, and can run concurrently
+	std::vector<std::thread> threads;
+	std::vector<int> found(4);
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&node, &found, t]() {
+			for (int n = 0; n < 10000; n++) {
+				if (node->has_attr("id") && !node->find_attr("key" + std::to_string(n))) found[t]++;
+			}
+		});
+	}
+	for (auto &thread : threads) thread.join();
+	for (int count : found) CHECK_EQ(count, 10000);
+	CHECK_EQ(node->get_attr_keys().size(), 4);
+	CHECK_EQ(dfml::Builder::create()->build_node(std::const_pointer_cast<dfml::Node>(node)),
+			"node(id: 7, ratio: 0.5, on: true, name: \"main\")");
+}
+
+TEST_CASE("Child access") {
+	auto node = dfml::Node::create("node");
+	node->reserve(3);
+	node->add_child(dfml::Node::create("first"));
+	node->add_child(dfml::Data::create_integer(2));
+	node->add_child(dfml::Comment::create("third"));
+
+	CHECK_EQ(node->child_count(), 3);
+	CHECK_EQ(node->child(0)->get_element_type(), dfml::Element::NODE);
+	CHECK_EQ(node->child(1)->get_element_type(), dfml::Element::DATA);
+	CHECK_EQ(node->child(2)->get_element_type(), dfml::Element::COMMENT);
+
+	auto children = node->get_children();
+	CHECK_EQ(children.size(), 3);
+	CHECK_EQ(children[1], node->child(1));
+	CHECK_EQ(children.front(), node->child(0));
+	CHECK_EQ(children.back(), node->child(2));
+
+	// The view shares the elements: no reference is added.
+	CHECK_EQ(node->child(0).use_count(), 1);
+}
+
+TEST_CASE("Parent links") {
+	auto elements = dfml::Parser::create("root { section(id: 1) { item { 'value' } } /*note*/ }")->parse();
+	auto root = std::static_pointer_cast<dfml::Node>(elements.front());
+	auto section = std::static_pointer_cast<dfml::Node>(root->child(0));
+	auto item = std::static_pointer_cast<dfml::Node>(section->child(0));
+	auto value = item->child(0);
+
+	CHECK_EQ(root->get_parent(), nullptr);
+	CHECK_EQ(section->get_parent(), root.get());
+	CHECK_EQ(value->get_parent(), item.get());
+	CHECK_EQ(root->child(1)->get_parent(), root.get());
+
+	CHECK_EQ(root->depth(), 0);
+	CHECK_EQ(value->depth(), 3);
+	CHECK_EQ(root->path(), "/root");
+	CHECK_EQ(item->path(), "/root/section/item");
+	CHECK_EQ(value->path(), "/root/section/item");
+
+	std::vector<std::string> names;
+	for (dfml::Node *node : value->ancestors()) names.push_back(node->get_name());
+	CHECK_EQ(names, (std::vector<std::string>{"item", "section", "root"}));
+	CHECK(root->ancestors().empty());
+
+	// Moved to another node
+	auto other = dfml::Node::create("other");
+	auto removed = section->remove_child(0);
+	CHECK_EQ(removed, item);
+	CHECK_EQ(section->child_count(), 0);
+	CHECK_EQ(item->get_parent(), nullptr);
+	CHECK_EQ(item->path(), "/item");
+	other->add_child(removed);
+	CHECK_EQ(value->path(), "/other/item");
+
+	// Moved while still in a node: removed from it first
+	auto first = dfml::Node::create("first");
+	auto second = dfml::Node::create("second");
+	for (int n = 0; n < 40; n++) first->add_child(dfml::Node::create("item" + std::to_string(n)));
+	auto moved = std::static_pointer_cast<dfml::Node>(first->child(3));
+	CHECK_EQ(first->find_child("item3"), moved.get());
+	second->add_child(moved);
+	CHECK_EQ(first->child_count(), 39);
+	CHECK_EQ(first->child(3)->get_parent(), first.get());
+	CHECK_EQ(moved->get_parent(), second.get());
+	CHECK_EQ(moved->path(), "/second/item3");
+	moved->set_name("renamed");
+	CHECK_EQ(first->find_child("item3"), nullptr);
+	CHECK_EQ(first->find_child("item4"), first->child(3).get());
+	CHECK_EQ(second->find_child("renamed"), moved.get());
+	second->add_child(moved);
+	CHECK_EQ(second->child_count(), 1);
+
+	// Children outliving their parent
+	other.reset();
+	CHECK_EQ(item->get_parent(), nullptr);
+	CHECK_EQ(value->get_parent(), item.get());
+	CHECK_EQ(dfml::Data::create_string("x")->path(), "/");
+}
+
+TEST_CASE("Child lookup") {
+	auto check = [](size_t width) {
+		auto node = dfml::Node::create("users");
+		for (size_t n = 0; n < width; n++) {
+			node->add_child(dfml::Node::create("user" + std::to_string(n)));
+			node->add_child(dfml::Data::create_integer(n));
+		}
+		node->add_child(dfml::Node::create("group"));
+		node->add_child(dfml::Node::create("group"));
+
+		CHECK_EQ(node->find_child("user0"), node->child(0).get());
+		CHECK_EQ(node->find_child("user" + std::to_string(width - 1)), node->child(2 * width - 2).get());
+		CHECK_EQ(node->find_child("missing"), nullptr);
+		std::vector<dfml::Node *> groups{
+				static_cast<dfml::Node *>(node->child(2 * width).get()),
+				static_cast<dfml::Node *>(node->child(2 * width + 1).get())};
+		CHECK_EQ(node->find_children("group"), groups);
+		CHECK(node->find_children("missing").empty());
+
+		// Added after the first lookup
+		auto added = dfml::Node::create("group");
+		node->add_child(added);
+		groups.push_back(added.get());
+		CHECK_EQ(node->find_children("group"), groups);
+
+		// Removed: the positions of the following children change
+		node->remove_child(0);
+		CHECK_EQ(node->find_child("user0"), nullptr);
+		CHECK_EQ(node->find_child("user1"), node->child(1).get());
+		CHECK_EQ(node->find_children("group"), groups);
+
+		// Renamed
+		added->set_name("admins");
+		CHECK_EQ(node->find_children("group").size(), 2);
+		CHECK_EQ(node->find_child("admins"), added.get());
+		CHECK_EQ(added->find_child("x"), nullptr);
+	};
+
+	CHECK_EQ(dfml::Node::get_child_index_threshold(), dfml::Node::CHILD_INDEX_THRESHOLD);
+	check(4);
+	check(1000);
+
+	// Any width can be indexed
+	dfml::Node::set_child_index_threshold(1);
+	check(4);
+	dfml::Node::set_child_index_threshold(dfml::Node::CHILD_INDEX_THRESHOLD);
+
+	// Concurrent readers build the index once
+	auto node = dfml::Node::create("users");
+	for (int n = 0; n < 1000; n++) node->add_child(dfml::Node::create("user" + std::to_string(n)));
+	std::vector<int> found(4);
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 4; t++) {
+		readers.emplace_back([&node, &found, t] {
+			for (int n = 0; n < 1000; n++) {
+				if (node->find_child("user" + std::to_string(n)) == node->child(n).get()) found[t]++;
+			}
+		});
+	}
+	for (auto &reader : readers) reader.join();
+	CHECK_EQ(found, (std::vector<int>{1000, 1000, 1000, 1000}));
+}
+
+TEST_CASE("Sinks") {
+	std::ifstream file("../test/dfml/parsing.dfml");
+	std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	auto elements = dfml::Parser::create(data)->parse();
+
+	auto builder = dfml::Builder::create();
+	builder->use_spaces_for_indent(true);
+	builder->set_space_count(2);
+
+	std::string expected;
+	for (auto &element : elements) expected += builder->build_element(element) + "\n";
+
+	dfml::BufferSink buffer;
+	std::stringstream ss;
+	dfml::StreamSink stream(ss);
+	for (auto &element : elements) {
+		builder->write(*element, buffer);
+		buffer.write("\n");
+		builder->write(*element, stream);
+		stream.write("\n");
+	}
+	CHECK_EQ(buffer.get_buffer(), expected);
+	CHECK_EQ(ss.str(), expected);
+
+	std::FILE *tmp = std::tmpfile();
+	REQUIRE(tmp != nullptr);
+	{
+		dfml::FdSink fd(fileno(tmp));
+		for (auto &element : elements) {
+			builder->write(*element, fd);
+			fd.write("\n");
+		}
+	}
+	std::string written(expected.size() + 1, '\0');
+	std::rewind(tmp);
+	written.resize(std::fread(&written[0], 1, written.size(), tmp));
+	std::fclose(tmp);
+	CHECK_EQ(written, expected);
+
+	dfml::FdSink invalid(-1);
+	invalid.write("data");
+	CHECK_THROWS_AS(invalid.flush(), std::runtime_error);
+}
+
+TEST_CASE("Deep nesting") {
+	auto root = dfml::Node::create("level");
+	auto node = root;
+	for (int n = 0; n < 3; n++) {
+		auto child = dfml::Node::create("level");
+		node->add_child(child);
+		node = child;
+	}
+	node->add_child(dfml::Data::create_string("it's \"quoted\""));
+
+	CHECK_EQ(dfml::Builder::create()->build_node(root),
+		"level {\n\tlevel {\n\t\tlevel {\n\t\t\tlevel {\n\t\t\t\t\"it's quoted\"\n\t\t\t}\n\t\t}\n\t}\n}");
+}
+
 }
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+#include <dfml/cache.h>
+#include <dfml/parser.h>
+#include <dfml/builder.h>
+#include <dfml/dfml.h>
+
+/**
+ * @brief Builds the elements like the text files, one per line.
+ */
+template <typename Elements>
+std::string build_cached(const Elements &elements) {
+	auto builder = dfml::Builder::create();
+	std::string result;
+	for (auto &e : elements) result += builder->build_element(e) + "\n";
+	return result;
+}
+
+TEST_SUITE("Cache") {
+	TEST_CASE("Hits and misses") {
+		std::string directory = "cache_test";
+		std::string source = directory + "/source.dfml";
+		std::filesystem::remove_all(directory);
+
+		auto cache = dfml::Cache::create(directory + "/entries");
+		std::filesystem::copy_file("../test/dfml/parsing.dfml", source);
+		std::string expected = build_cached(dfml::Parser::open(source)->parse());
+
+		CHECK_EQ(build_cached(cache->load(source)), expected);
+		CHECK_EQ(cache->get_stats().misses, 1);
+		CHECK_EQ(cache->get_stats().hits, 0);
+
+		CHECK_EQ(build_cached(cache->load(source)), expected);
+		CHECK_EQ(build_cached(cache->load_document(source)->get_elements()), expected);
+		CHECK_FALSE(cache->load_tape(source)->get_elements().empty());
+		CHECK_EQ(cache->get_stats().misses, 1);
+		CHECK_EQ(cache->get_stats().hits, 3);
+		CHECK(cache->get_stats().hit_time > 0);
+
+		// A changed file is parsed again
+		std::ofstream(source, std::ios::app) << "\nadded(id: 1)";
+		auto elements = cache->load(source);
+		CHECK_EQ(std::static_pointer_cast<dfml::Node>(elements.back())->get_name(), "added");
+		CHECK_EQ(cache->get_stats().misses, 2);
+		cache->load(source);
+		CHECK_EQ(cache->get_stats().hits, 4);
+
+		// A corrupt entry is a miss, reporting no event from it, and is written again
+		auto corrupt = [&directory]() {
+			for (auto &entry : std::filesystem::directory_iterator(directory + "/entries")) {
+				std::ofstream(entry.path(), std::ios::binary | std::ios::app) << "\x01";
+			}
+		};
+		corrupt();
+		struct Counter : public dfml::Handler {
+			void on_node_begin(std::string_view) override { nodes++; }
+			size_t nodes = 0;
+		} counter, expected_counter;
+		cache->load(source, counter);
+		dfml::Parser::open(source)->parse(expected_counter);
+		CHECK_EQ(counter.nodes, expected_counter.nodes);
+		CHECK_EQ(cache->get_stats().misses, 3);
+		CHECK_EQ(build_cached(cache->load(source)), build_cached(dfml::Parser::open(source)->parse()));
+		CHECK_EQ(cache->get_stats().hits, 5);
+
+		// A hit reports the decoded events
+		Counter hit_counter;
+		cache->load(source, hit_counter);
+		CHECK_EQ(hit_counter.nodes, expected_counter.nodes);
+		CHECK_EQ(cache->get_stats().hits, 6);
+
+		// The partial results of the corrupt entries are dropped
+		std::string parsed = build_cached(dfml::Parser::open(source)->parse());
+		corrupt();
+		CHECK_EQ(build_cached(cache->load(source)), parsed);
+		corrupt();
+		CHECK_EQ(build_cached(cache->load_document(source)->get_elements()), parsed);
+		corrupt();
+		CHECK_FALSE(cache->load_tape(source)->get_elements().empty());
+		CHECK_EQ(cache->get_stats().misses, 6);
+		CHECK_EQ(cache->get_stats().hits, 6);
+
+		// Invalid sources are not cached
+		std::ofstream(source) << "node { 1.2.3 }";
+		CHECK_THROWS_AS(cache->load(source), dfml::ParserException);
+		CHECK_THROWS_AS(cache->load(source), dfml::ParserException);
+
+		std::filesystem::remove_all(directory);
+	}
+
+	TEST_CASE("Content hash") {
+		CHECK_EQ(dfml::Cache::hash(""), 0xcbf29ce484222325);
+		CHECK_EQ(dfml::Cache::hash("a"), 0xaf63dc4c8601ec8c);
+		CHECK_NE(dfml::Cache::hash("node(a: 1)"), dfml::Cache::hash("node(a: 2)"));
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <fstream>
+
+#include <dfml/parser.h>
+#include <dfml/builder.h>
+#include <dfml/dfml.h>
+
+/**
+ * @brief Memory resource counting the bytes requested to the default resource.
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+	size_t allocated{};
+
+private:
+	void *do_allocate(size_t bytes, size_t alignment) override {
+		allocated += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+		return this == &other;
+	}
+};
+
+TEST_SUITE("Document") {
+	TEST_CASE("Same tree as parse()") {
+		std::ifstream file("../test/dfml/parsing.dfml");
+		std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		auto builder = dfml::Builder::create();
+		std::string expected, result;
+		for (auto &element : dfml::Parser::create(data)->parse()) expected += builder->build_element(element);
+
+		auto document = dfml::Parser::create(data)->parse_document();
+		for (auto &element : document->get_elements()) result += builder->build_element(element);
+
+		CHECK_FALSE(expected.empty());
+		CHECK_EQ(result, expected);
+	}
+
+	TEST_CASE("Elements in the arena") {
+		auto document = dfml::Document::create();
+		CountingResource counting;
+		auto previous = std::pmr::set_default_resource(&counting);
+
+		auto node = document->create_node("a node name longer than the small string buffer");
+		dfml::Value value;
+		value.set_integer(5);
+		node->set_attribute("an attribute key longer than the small string buffer", value);
+		node->add_child(document->create_comment("a comment longer than the small string buffer"));
+		node->add_child(document->create_data(value));
+		document->add_element(node);
+
+		std::pmr::set_default_resource(previous);
+		CHECK_EQ(counting.allocated, 0);
+
+		CHECK_EQ(document->get_elements().size(), 1);
+		CHECK_EQ(node->get_name(), "a node name longer than the small string buffer");
+		CHECK_EQ(node->get_attr("an attribute key longer than the small string buffer").get_integer(), 5);
+		CHECK_EQ(node->get_children().size(), 2);
+	}
+
+	TEST_CASE("Elements outliving the document") {
+		auto document = dfml::Parser::create("first(key: 'a value longer than the small string buffer') { second { 'text' } } third")->parse_document();
+		auto first = std::static_pointer_cast<dfml::Node>(document->get_elements()[0]);
+		auto second = std::static_pointer_cast<dfml::Node>(first->child(0));
+		auto text = second->child(0);
+		document.reset();
+
+		CHECK_EQ(first->get_name(), "first");
+		CHECK_EQ(first->attr<std::string>("key"), "a value longer than the small string buffer");
+		CHECK_EQ(second->get_parent(), first.get());
+		CHECK_EQ(text->path(), "/first/second");
+		CHECK_EQ(dfml::Builder::create()->build_node(second), "second {\n\t\"text\"\n}");
+
+		// The arena is released with the last element
+		first.reset();
+		CHECK_EQ(second->get_parent(), nullptr);
+		second.reset();
+		CHECK_EQ(static_cast<const dfml::Data &>(*text).get_value().get_string(), "text");
+		CHECK_EQ(text->get_parent(), nullptr);
+	}
+}
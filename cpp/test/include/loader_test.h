@@ -0,0 +1,80 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+#include <dfml/loader.h>
+#include <dfml/parser.h>
+#include <dfml/builder.h>
+#include <dfml/thread_pool.h>
+#include <dfml/cache.h>
+#include <dfml/dfml.h>
+
+TEST_SUITE("Loader") {
+	TEST_CASE("Batch of files") {
+		std::ofstream("loader_test.dfml") << "node { 1.2.3 }";
+
+		std::vector<std::string> paths;
+		for (int n = 0; n < 20; n++) {
+			paths.push_back("../test/dfml/parsing.dfml");
+			paths.push_back("../test/dfml/doubles.dfml");
+		}
+		paths.insert(paths.begin() + 5, "../test/dfml/missing.dfml");
+		paths.insert(paths.begin() + 9, "loader_test.dfml");
+
+		auto builder = dfml::Builder::create();
+		auto build = [&](const std::list<std::shared_ptr<dfml::Element>> &elements) {
+			std::string result;
+			for (auto &e : elements) result += builder->build_element(e) + "\n";
+			return result;
+		};
+
+		auto pool = dfml::ThreadPool::create(3);
+		dfml::LoadOptions in_pool;
+		in_pool.pool = pool.get();
+		dfml::LoadOptions serial;
+		serial.threads = 1;
+
+		for (auto &options : {dfml::LoadOptions(), in_pool, serial}) {
+			auto results = dfml::load_files(paths, options);
+			REQUIRE(results.files.size() == paths.size());
+			CHECK_EQ(results.failures, 2);
+			CHECK(results.bytes_per_second() > 0);
+
+			size_t bytes = 0;
+			for (size_t n = 0; n < paths.size(); n++) {
+				auto &file = results.files[n];
+				CHECK_EQ(file.path, paths[n]);
+
+				if (n == 5) {
+					CHECK_FALSE(file.ok());
+					CHECK_THROWS_AS(std::rethrow_exception(file.error), std::runtime_error);
+				} else if (n == 9) {
+					CHECK_FALSE(file.ok());
+					CHECK_THROWS_AS(std::rethrow_exception(file.error), dfml::ParserException);
+					CHECK_FALSE(file.message.empty());
+				} else {
+					REQUIRE(file.ok());
+					CHECK_EQ(build(file.elements), build(dfml::Parser::open(file.path)->parse()));
+					bytes += file.size;
+				}
+			}
+			CHECK_EQ(results.bytes, bytes);
+		}
+
+		// Through a cache
+		std::filesystem::remove_all("loader_cache");
+		auto cache = dfml::Cache::create("loader_cache");
+		dfml::LoadOptions cached;
+		cached.cache = cache.get();
+		auto results = dfml::load_files(paths, cached);
+		CHECK_EQ(results.failures, 2);
+		CHECK_EQ(build(results.files[0].elements), build(dfml::Parser::open(paths[0])->parse()));
+		CHECK_EQ(cache->get_stats().hits + cache->get_stats().misses, paths.size() - 2);
+
+		std::filesystem::remove_all("loader_cache");
+		std::filesystem::remove("loader_test.dfml");
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <vector>
+
+#include <dfml/parser.h>
+#include <dfml/name_index.h>
+#include <dfml/dfml.h>
+
+/**
+ * @brief Joins the "id" attribute of some nodes.
+ */
+inline std::string index_ids(const dfml::NameIndex::Nodes &nodes) {
+	std::string result;
+	for (dfml::Node *node : nodes) {
+		if (!result.empty()) result += " ";
+		result += std::to_string(node->attr<long>("id").value_or(0));
+	}
+	return result;
+}
+
+TEST_SUITE("Name index") {
+	const char *routes = R"(
+		app(id: 1) {
+			route(id: 2, method: 'GET')
+			group(id: 3) { route(id: 4) { route(id: 5, method: 'POST') } }
+			route(id: 6)
+		}
+		route(id: 7, method: 'GET')
+	)";
+
+	TEST_CASE("Built while parsing") {
+		auto parser = dfml::Parser::create(routes);
+		dfml::ParseOptions options;
+		options.name_index = true;
+		parser->set_options(options);
+		auto document = parser->parse_document();
+
+		dfml::NameIndex *index = document->get_index();
+		REQUIRE(index != nullptr);
+		CHECK_EQ(index->size(), 7);
+		CHECK_EQ(index_ids(index->find_nodes("route")), "2 4 5 6 7");
+		CHECK_EQ(index_ids(index->find_nodes("group")), "3");
+		CHECK_EQ(index_ids(index->find_keys("method")), "2 5 7");
+		CHECK(index->find_nodes("missing").empty());
+
+		// Same as an index built on demand
+		auto later = dfml::Parser::create(routes)->parse_document();
+		CHECK_EQ(later->get_index(), nullptr);
+		CHECK_EQ(index_ids(later->create_index().find_nodes("route")), "2 4 5 6 7");
+		CHECK_EQ(index_ids(later->create_index().find_keys("id")), "1 2 3 4 5 6 7");
+	}
+
+	TEST_CASE("Incremental updates") {
+		auto elements = dfml::Parser::create(routes)->parse();
+		dfml::NameIndex index;
+		index.add(elements);
+
+		auto app = std::static_pointer_cast<dfml::Node>(elements.front());
+		auto group = std::static_pointer_cast<dfml::Node>(app->child(1));
+		CHECK_EQ(app->get_index(), &index);
+
+		// Added in the middle of the document
+		auto added = dfml::Node::create("route");
+		added->set_attr_integer("id", 8);
+		group->add_child(added);
+		CHECK_EQ(index_ids(index.find_nodes("route")), "2 4 5 8 6 7");
+
+		// A subtree, and attributes set later
+		auto subtree = dfml::Node::create("group");
+		subtree->add_child(dfml::Node::create("route"));
+		app->add_child(subtree);
+		std::static_pointer_cast<dfml::Node>(subtree->child(0))->set_attr_integer("id", 9);
+		subtree->set_attr_integer("id", 10);
+		CHECK_EQ(index_ids(index.find_nodes("route")), "2 4 5 8 6 9 7");
+		CHECK_EQ(index_ids(index.find_nodes("group")), "3 10");
+		CHECK_EQ(index_ids(index.find_keys("id")), "1 2 3 4 5 8 6 10 9 7");
+
+		// Renamed and removed
+		added->set_name("path");
+		CHECK_EQ(index_ids(index.find_nodes("path")), "8");
+		auto removed = app->remove_child(1);
+		CHECK_EQ(index_ids(index.find_nodes("route")), "2 6 9 7");
+		CHECK_EQ(index_ids(index.find_nodes("path")), "");
+		CHECK_EQ(std::static_pointer_cast<dfml::Node>(removed)->get_index(), nullptr);
+		CHECK_EQ(index.size(), 6);
+
+		// Moved to another parent, and from another index
+		auto route = app->child(0);
+		subtree->add_child(route);
+		CHECK_EQ(index_ids(index.find_nodes("route")), "6 9 2 7");
+		CHECK_EQ(index.size(), 6);
+		dfml::NameIndex other;
+		auto top = dfml::Node::create("route");
+		top->set_attr_integer("id", 11);
+		other.add(*top);
+		app->add_child(top);
+		CHECK_EQ(other.size(), 0);
+		CHECK(other.find_nodes("route").empty());
+		CHECK_EQ(top->get_index(), &index);
+		CHECK_EQ(index_ids(index.find_nodes("route")), "6 9 2 11 7");
+
+		index.clear();
+		CHECK_EQ(app->get_index(), nullptr);
+		CHECK(index.find_nodes("route").empty());
+	}
+
+	TEST_CASE("Nodes destroyed before the index") {
+		dfml::NameIndex index;
+		auto elements = dfml::Parser::create(routes)->parse();
+		index.add(elements);
+		CHECK_EQ(index.size(), 7);
+
+		// A top level node, then a subtree kept out of its parent
+		elements.pop_back();
+		CHECK_EQ(index_ids(index.find_nodes("route")), "2 4 5 6");
+		CHECK_EQ(index_ids(index.find_keys("method")), "2 5");
+		auto app = std::static_pointer_cast<dfml::Node>(elements.front());
+		auto group = app->child(1);
+		app.reset();
+		elements.clear();
+		CHECK_EQ(index_ids(index.find_nodes("route")), "4 5");
+		CHECK_EQ(index.size(), 3);
+		group.reset();
+		CHECK_EQ(index.size(), 0);
+		CHECK(index.find_nodes("route").empty());
+		CHECK(index.find_keys("id").empty());
+
+		// A whole tree left indexed when it is dropped
+		elements = dfml::Parser::create(routes)->parse();
+		index.add(elements);
+		elements.clear();
+		CHECK_EQ(index.size(), 0);
+	}
+}
@@ -3,9 +3,14 @@
 #include <doctest.h>
 #include <string>
 #include <fstream>
+#include <sstream>
 
+#include <dfml/binary.h>
 #include <dfml/parser.h>
+#include <dfml/handler.h>
 #include <dfml/builder.h>
+#include <dfml/sink.h>
+#include <dfml/thread_pool.h>
 #include <dfml/dfml.h>
 
 TEST_SUITE("Parser") {
@@ -124,6 +129,80 @@ TEST_SUITE("Parser") {
 		CHECK_EQ(data->get_value().get_value(), "1234.46");
 	}
 
+	TEST_CASE("Number grammar") {
+		auto parser = dfml::Parser::create(
+			"n(a: 1e20, b: -2.5E-3, c: -7, d: 4) { 6.02e+23, -12 tail{3} 0.1}");
+		auto list = parser->parse();
+
+		REQUIRE(list.size() == 1);
+		auto node = std::static_pointer_cast<dfml::Node>(list.front());
+		CHECK_EQ(node->get_attr("a").get_type(), dfml::Value::DOUBLE);
+		CHECK_EQ(node->get_attr("a").get_value(), "1e+20");
+		CHECK_EQ(node->get_attr("b").get_value(), "-0.0025");
+		CHECK_EQ(node->get_attr("c").get_type(), dfml::Value::INTEGER);
+		CHECK_EQ(node->get_attr("c").get_value(), "-7");
+		CHECK_EQ(node->get_attr("d").get_value(), "4");
+
+		auto children = node->get_children();
+		REQUIRE(children.size() == 4);
+		auto it = children.begin();
+		CHECK_EQ(std::static_pointer_cast<dfml::Data>(*it++)->get_value().get_value(), "6.02e+23");
+		CHECK_EQ(std::static_pointer_cast<dfml::Data>(*it++)->get_value().get_value(), "-12");
+		auto tail = std::static_pointer_cast<dfml::Node>(*it++);
+		CHECK_EQ(tail->get_name(), "tail");
+		CHECK_EQ(tail->get_children().size(), 1);
+		CHECK_EQ(std::static_pointer_cast<dfml::Data>(*it)->get_value().get_value(), "0.1");
+
+		CHECK_THROWS_AS(dfml::Parser::create("1.2.3")->parse(), dfml::ParserException);
+		CHECK_THROWS_AS(dfml::Parser::create("99999999999999999999")->parse(), dfml::ParserException);
+		CHECK_NOTHROW(dfml::Parser::create("n(a: 5")->parse());
+	}
+
+	TEST_CASE("Typed values") {
+		auto list = dfml::Parser::create("n(i: -42, d: 2.5, b: true, s: 'text')")->parse();
+		REQUIRE(list.size() == 1);
+		auto node = std::static_pointer_cast<dfml::Node>(list.front());
+
+		CHECK_EQ(node->get_attr("i").get_integer(), -42);
+		CHECK_EQ(node->get_attr("d").get_double(), 2.5);
+		CHECK_EQ(node->get_attr("b").get_boolean(), true);
+		CHECK_EQ(node->get_attr("s").get_string(), "text");
+		CHECK_EQ(node->get_attr("i").get<long>(), -42);
+		CHECK_EQ(node->get_attr("s").get<std::string>(), "text");
+		CHECK_THROWS_AS(node->get_attr("i").get_double(), std::bad_variant_access);
+		CHECK_THROWS_AS(node->get_attr("s").get<bool>(), std::bad_variant_access);
+
+		dfml::Value value;
+		CHECK_EQ(value.get_type(), dfml::Value::STRING);
+		value.set_double(3.0);
+		CHECK_EQ(value.get_value(), "3.0");
+		value.set_boolean(false);
+		CHECK_EQ(value.get_type(), dfml::Value::BOOLEAN);
+		CHECK_EQ(value.get_value(), "false");
+	}
+
+	TEST_CASE("Number round trip") {
+		const double doubles[] = {0.1, 1.0 / 3.0, -2.0, 1e20, 6.02214076e23, 1e-300, 123456.789};
+		auto node = dfml::Node::create("numbers");
+		for (double d : doubles) node->add_child(dfml::Data::create_double(d));
+		node->add_child(dfml::Data::create_integer(-9007199254740993));
+
+		auto list = dfml::Parser::create(dfml::Builder::create()->build_node(node))->parse();
+		REQUIRE(list.size() == 1);
+		auto children = std::static_pointer_cast<dfml::Node>(list.front())->get_children();
+		REQUIRE(children.size() == 8);
+
+		auto it = children.begin();
+		for (double d : doubles) {
+			auto value = std::static_pointer_cast<dfml::Data>(*it++)->get_value();
+			CHECK_EQ(value.get_type(), dfml::Value::DOUBLE);
+			CHECK_EQ(std::stod(value.get_value()), d);
+		}
+		auto value = std::static_pointer_cast<dfml::Data>(*it)->get_value();
+		CHECK_EQ(value.get_type(), dfml::Value::INTEGER);
+		CHECK_EQ(value.get_value(), "-9007199254740993");
+	}
+
 	TEST_CASE("Single boolean value") {
 		auto parser = dfml::Parser::create("false");
 		auto list = parser->parse();
@@ -243,7 +322,7 @@ TEST_SUITE("Parser") {
 		CHECK_EQ(node2->get_attr("float1").get_value(), "456.21");
 
 		CHECK_EQ(node2->get_attr("float2").get_type(), dfml::Value::DOUBLE);
-		CHECK_EQ(node2->get_attr("float2").get_value(), "2");
+		CHECK_EQ(node2->get_attr("float2").get_value(), "2.0");
 
 		auto nested = std::static_pointer_cast<dfml::Node>(node2->get_children().front());
 		CHECK_EQ(nested->get_attr("size").get_type(), dfml::Value::DOUBLE);
@@ -284,4 +363,332 @@ TEST_SUITE("Parser") {
 		CHECK_EQ(child1->get_attr("action").get_value(), "hello");
 		CHECK_EQ(child2->get_attr("action").get_value(), "bye");
 	}
+
+	TEST_CASE("String view") {
+		std::string data = "first(a: 1) second { 'child' }";
+		std::string_view view(data);
+
+		// Only the second half is parsed, in place.
+		auto parser = dfml::Parser::create(view.substr(12));
+		auto list = parser->parse();
+
+		CHECK_EQ(list.size(), 1);
+		auto node = std::static_pointer_cast<dfml::Node>(list.front());
+		CHECK_EQ(node->get_name(), "second");
+		CHECK_EQ(node->get_children().size(), 1);
+	}
+
+	TEST_CASE("Mapped file") {
+		std::ifstream parsed_file("../test/dfml/parsed.dfml");
+		std::string parsed = std::string((std::istreambuf_iterator<char>(parsed_file)), std::istreambuf_iterator<char>());
+
+		auto parser = dfml::Parser::open("../test/dfml/parsing.dfml");
+		auto list = parser->parse();
+		auto builder = dfml::Builder::create();
+		std::string result = builder->build_node(std::static_pointer_cast<dfml::Node>(list.front()));
+		result += '\n';
+		CHECK_EQ(result, parsed);
+
+		CHECK_THROWS(dfml::Parser::open("../test/dfml/missing.dfml"));
+	}
+
+	TEST_CASE("Handler events") {
+		struct EventLog : public dfml::Handler {
+			void on_node_begin(std::string_view name) override { log << "<" << name; }
+			void on_attribute(std::string_view key, const dfml::Value &value) override {
+				log << " " << key << "=" << dfml::Value(value).get_value();
+			}
+			void on_data(const dfml::Value &value) override { log << "[" << dfml::Value(value).get_value() << "]"; }
+			void on_comment(std::string_view text) override { log << "#" << text; }
+			void on_node_end() override { log << ">"; }
+			std::stringstream log;
+		} events;
+
+		auto parser = dfml::Parser::create(
+			"root(a: 1, b: 'x', c) { /*note*/child 'text' 2.5 true }");
+		parser->parse(events);
+
+		CHECK_EQ(events.log.str(), "<root a=1 b=x c=#note<child>[text][2.5][true]>");
+	}
+
+	TEST_CASE("Comments: followed by element") {
+		auto parser = dfml::Parser::create("/*first*/node #second\n'string'");
+		auto list = parser->parse();
+
+		CHECK_EQ(list.size(), 4);
+		auto iter = list.begin();
+		CHECK_EQ(std::static_pointer_cast<dfml::Comment>(*iter)->get_string(), "first");
+		iter ++;
+		CHECK_EQ(std::static_pointer_cast<dfml::Node>(*iter)->get_name(), "node");
+		iter ++;
+		CHECK_EQ(std::static_pointer_cast<dfml::Comment>(*iter)->get_string(), "second");
+		iter ++;
+		CHECK((*iter)->get_element_type() == dfml::Element::DATA);
+	}
+
+	TEST_CASE("Structural index") {
+		const std::string_view alphabet = "ab {}\t(),:\"'/#\n\r x";
+		std::string data;
+		for (int n = 0; n < 10000; n++) data += alphabet[(n * 7) % alphabet.size()];
+
+		dfml::StructuralIndex index;
+		index.set_data(data);
+
+		std::string structural = "{}(),:\"'/#";
+		std::string space = " \t\n\r";
+		for (size_t pos = 0; pos <= data.size(); pos += 13) {
+			size_t expected = data.find_first_of(structural, pos);
+			CHECK_EQ(index.next_structural(pos), expected == std::string::npos ? data.size() : expected);
+			expected = data.find_first_not_of(space, pos);
+			CHECK_EQ(index.next_non_space(pos), expected == std::string::npos ? data.size() : expected);
+		}
+	}
+
+	TEST_CASE("Long strings and comments") {
+		std::string text(10000, 'x');
+		auto parser = dfml::Parser::create("/*" + text + "*/\n\t\t'" + text + "' #" + text);
+		auto list = parser->parse();
+
+		CHECK_EQ(list.size(), 3);
+		CHECK_EQ(std::static_pointer_cast<dfml::Comment>(list.front())->get_string(), text);
+		CHECK_EQ(std::static_pointer_cast<dfml::Data>(*std::next(list.begin()))->get_value().get_value(), text);
+		CHECK_EQ(std::static_pointer_cast<dfml::Comment>(list.back())->get_string(), text);
+	}
+
+	TEST_CASE("Parallel parse") {
+		std::ifstream parsing_file("../test/dfml/parsing.dfml");
+		std::string parsing = std::string((std::istreambuf_iterator<char>(parsing_file)), std::istreambuf_iterator<char>());
+
+		// Records with and without children, comments and strings hiding braces
+		std::string data;
+		for (int n = 0; data.size() < (4 << 20); n++) {
+			data += parsing + "\nrow(id: " + std::to_string(n) + ", text: '} {') /* ) } */ row2 (a: 1)\n";
+			data += "'{' -1.5 true # {\n" + std::string(n % 7, ' ') + "last";
+		}
+
+		auto builder = dfml::Builder::create();
+		auto build = [&](const std::list<std::shared_ptr<dfml::Element>> &elements) {
+			std::string result;
+			for (auto &e : elements) result += builder->build_element(e) + "\n";
+			return result;
+		};
+
+		auto pool = dfml::ThreadPool::create(4);
+		std::string expected = build(dfml::Parser::create(data)->parse());
+		CHECK_EQ(build(dfml::Parser::create(data)->parse_parallel(*pool)), expected);
+		CHECK_EQ(build(dfml::Parser::create(data)->parse_parallel(2)), expected);
+
+		// A '}' at the top level ends the document
+		std::string stopped = data.substr(0, data.size() / 2) + " } " + data.substr(data.size() / 2);
+		stopped.replace(stopped.find("last", data.size() / 2), 4, "last }");
+		CHECK_EQ(build(dfml::Parser::create(stopped)->parse_parallel(*pool)),
+				build(dfml::Parser::create(stopped)->parse()));
+
+		// The same error as a serial parse
+		std::string invalid = data;
+		invalid.replace(invalid.find("-1.5", invalid.size() * 3 / 4), 4, "1.2.3");
+		std::string serial, parallel;
+		try { dfml::Parser::create(invalid)->parse(); } catch (dfml::ParserException &e) { serial = e.what(); }
+		try { dfml::Parser::create(invalid)->parse_parallel(*pool); } catch (dfml::ParserException &e) { parallel = e.what(); }
+		CHECK_FALSE(serial.empty());
+		CHECK_EQ(parallel, serial);
+	}
+
+	TEST_CASE("Thread pool") {
+		auto pool = dfml::ThreadPool::create(3);
+		CHECK_EQ(pool->size(), 3);
+
+		std::vector<std::future<int>> results;
+		for (int n = 0; n < 100; n++) results.push_back(pool->submit([n]() { return n * n; }));
+		for (int n = 0; n < 100; n++) CHECK_EQ(results[n].get(), n * n);
+
+		auto failed = pool->submit([]() -> int { throw dfml::ParserException("failed"); });
+		CHECK_THROWS_AS(failed.get(), dfml::ParserException);
+	}
+
+	TEST_CASE("Deep nesting") {
+		struct DepthCounter : public dfml::Handler {
+			void on_node_begin(std::string_view) override { depth++; max = std::max(max, depth); nodes++; }
+			void on_data(const dfml::Value &) override { data++; }
+			void on_node_end() override { depth--; }
+			size_t depth = 0, max = 0, nodes = 0, data = 0;
+		} counter;
+
+		// Deeper than the recursive parser could follow
+		const size_t levels = 200000;
+		std::string data;
+		for (size_t n = 0; n < levels; n++) data += "a{";
+		data += "1";
+		for (size_t n = 0; n < levels; n++) data += "}";
+		data += " b";
+
+		dfml::Parser::create(data)->parse(counter);
+		CHECK_EQ(counter.max, levels);
+		CHECK_EQ(counter.depth, 0);
+		CHECK_EQ(counter.nodes, levels + 1);
+		CHECK_EQ(counter.data, 1);
+
+		// Unclosed nodes end with the data
+		DepthCounter unclosed;
+		dfml::Parser::create("a { b(x: 1) { c { 'text'")->parse(unclosed);
+		CHECK_EQ(unclosed.max, 3);
+		CHECK_EQ(unclosed.depth, 0);
+
+		// A tree as deep is built, written and freed without recursion
+		{
+			auto elements = dfml::Parser::create(data)->parse();
+			REQUIRE_EQ(elements.size(), 2);
+			auto root = std::static_pointer_cast<dfml::Node>(elements.front());
+
+			std::string expected;
+			for (size_t n = 0; n < levels; n++) expected += "a { ";
+			expected += "1";
+			for (size_t n = 0; n < levels; n++) expected += " }";
+			auto builder = dfml::Builder::create();
+			builder->set_format(false);
+			CHECK(builder->build_node(root) == expected);
+
+			dfml::BufferSink sink;
+			dfml::BinaryEncoder encoder(sink);
+			encoder.write(*root);
+			encoder.finish();
+			DepthCounter decoded;
+			dfml::BinaryDecoder(sink.get_buffer()).decode(decoded);
+			CHECK_EQ(decoded.max, levels);
+			CHECK_EQ(decoded.data, 1);
+		}
+		auto document = dfml::Parser::create(data)->parse_document();
+		CHECK_EQ(document->get_elements().size(), 2);
+		document.reset();
+	}
+
+	TEST_CASE("Limits") {
+		auto parse = [](std::string data, dfml::ParseOptions options) {
+			auto parser = dfml::Parser::create(data);
+			parser->set_options(options);
+			dfml::Handler handler;
+			parser->parse(handler);
+		};
+		auto error = [&parse](std::string data, dfml::ParseOptions options) {
+			try { parse(data, options); } catch (dfml::ParserException &e) { return std::string(e.what()); }
+			return std::string();
+		};
+		const std::string data = "root(key: 'value') { a { b { 'text' 12 } } // note\n c }";
+
+		dfml::ParseOptions options;
+		CHECK_EQ(options.max_depth, SIZE_MAX);
+		CHECK_NOTHROW(parse(data, options));
+
+		options.max_depth = 3;
+		CHECK_NOTHROW(parse(data, options));
+		options.max_depth = 2;
+		CHECK_EQ(error(data, options), "Maximum depth of 2 exceeded on line: 1");
+
+		options = {};
+		options.max_elements = 7;
+		CHECK_NOTHROW(parse(data, options));
+		options.max_elements = 6;
+		CHECK_EQ(error(data, options), "Maximum element count of 6 exceeded on line: 2");
+
+		options = {};
+		options.max_string_length = 5;
+		CHECK_NOTHROW(parse(data, options));
+		options.max_string_length = 4;
+		CHECK_EQ(error(data, options), "Maximum string length of 4 exceeded on line: 1");
+		CHECK_THROWS_AS(parse("'12345'", options), dfml::ParserException);
+		CHECK_THROWS_AS(parse("/* 1234 */", options), dfml::ParserException);
+		CHECK_THROWS_AS(parse("node(abcde: 1)", options), dfml::ParserException);
+		CHECK_NOTHROW(parse("node(abcd: '1234') /*1234*/", options));
+
+		// Tapes apply the lower of the option and Tape::MAX_STRING_LENGTH
+		auto tape_parser = dfml::Parser::create(data);
+		tape_parser->set_options(options);
+		CHECK_THROWS_AS(tape_parser->parse_tape(), dfml::ParserException);
+		CHECK_EQ(tape_parser->get_options().max_string_length, 4);
+		tape_parser = dfml::Parser::create(data);
+		CHECK_NOTHROW(tape_parser->parse_tape());
+		CHECK_EQ(tape_parser->get_options().max_string_length, SIZE_MAX);
+
+		options = {};
+		options.max_bytes = data.size();
+		CHECK_NOTHROW(parse(data, options));
+		options.max_bytes = data.size() - 1;
+		CHECK_THROWS_AS(parse(data, options), dfml::ParserException);
+
+		auto parser = dfml::Parser::create(data);
+		parser->set_options(options);
+		CHECK_EQ(parser->get_options().max_bytes, data.size() - 1);
+		CHECK_THROWS_AS(parser->parse_document(), dfml::ParserException);
+		CHECK_THROWS_AS(parser->parse_parallel(2), dfml::ParserException);
+
+		// The parallel parse checks the same limits
+		std::string large;
+		while (large.size() < 4 * dfml::Parser::PARALLEL_CHUNK_SIZE) large += "node(id: 1) { 'text' } ";
+		size_t count = large.size() / 23 * 2;
+		options = {};
+		options.max_elements = count;
+		auto limited = dfml::Parser::create(large);
+		limited->set_options(options);
+		CHECK_EQ(limited->parse_parallel(2).size(), count / 2);
+		options.max_elements = count - 1;
+		limited = dfml::Parser::create(large);
+		limited->set_options(options);
+		CHECK_THROWS_AS(limited->parse_parallel(2), dfml::ParserException);
+	}
+
+
+	TEST_CASE("Non-throwing parse") {
+		auto result = dfml::Parser::create("root(id: 1) { 'text' 2 }")->parse(std::nothrow);
+		REQUIRE(result.has_value());
+		CHECK_EQ(result->size(), 1);
+		CHECK_EQ(result.get_error().code, dfml::ParseError::NONE);
+
+		struct Case { const char *data; dfml::ParseError::Code code; size_t offset; unsigned line, column; };
+		for (auto test : {
+			Case{"a { b }\n  c { ! }", dfml::ParseError::INVALID_CHILD, 14, 2, 7},
+			Case{"a(x: 1)(y: 2)", dfml::ParseError::DOUBLE_ATTRIBUTE_LIST, 8, 1, 9},
+			Case{"a(, x: 1)", dfml::ParseError::UNEXPECTED_SEPARATOR, 2, 1, 3},
+			Case{"a {\n\n 1.2.3 }", dfml::ParseError::INVALID_DOUBLE, 11, 3, 7},
+			Case{"a(x: 99999999999999999999)", dfml::ParseError::INVALID_INTEGER, 25, 1, 26},
+			Case{"a(x: maybe)", dfml::ParseError::INVALID_BOOLEAN, 11, 1, 12},
+			Case{"a { /x }", dfml::ParseError::INVALID_COMMENT, 6, 1, 7}}) {
+			auto failed = dfml::Parser::create(test.data)->parse(std::nothrow);
+			CHECK_FALSE(failed);
+			CHECK_EQ(failed.get_error().code, test.code);
+			CHECK_EQ(failed.get_error().offset, test.offset);
+			CHECK_EQ(failed.get_error().line, test.line);
+			CHECK_EQ(failed.get_error().column, test.column);
+
+			// The throwing API reports the same error
+			dfml::ParseError::Code code = dfml::ParseError::NONE;
+			std::string message;
+			try {
+				dfml::Parser::create(test.data)->parse();
+			} catch (dfml::ParserException &e) {
+				code = e.get_error().code;
+				message = e.what();
+			}
+			CHECK_EQ(code, test.code);
+			CHECK_EQ(message, failed.get_error().get_message());
+		}
+
+		// Every result type, and the limits
+		auto create = [](size_t max_depth) {
+			auto parser = dfml::Parser::create("a { b { c } }");
+			dfml::ParseOptions options;
+			options.max_depth = max_depth;
+			parser->set_options(options);
+			return parser;
+		};
+		dfml::Handler handler;
+		CHECK_EQ(create(2)->parse_document(std::nothrow).get_error().code, dfml::ParseError::MAX_DEPTH);
+		CHECK_EQ(create(2)->parse_tape(std::nothrow).get_error().limit, 2);
+		CHECK_EQ(create(2)->parse(handler, std::nothrow).get_error().code, dfml::ParseError::MAX_DEPTH);
+		CHECK_THROWS_AS(create(2)->parse_tape(std::nothrow).get_value(), dfml::ParserException);
+
+		CHECK(create(3)->parse(handler, std::nothrow));
+		CHECK_EQ(create(3)->parse_tape(std::nothrow).get_value()->get_elements().size(), 1);
+		CHECK_EQ((*create(3)->parse_document(std::nothrow))->get_elements().size(), 1);
+	}
+
 }
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <fstream>
+#include <vector>
+
+#include <dfml/push_parser.h>
+#include <dfml/parser.h>
+#include <dfml/builder.h>
+#include <dfml/dfml.h>
+
+TEST_SUITE("PushParser") {
+	TEST_CASE("Chunked file") {
+		std::ifstream parsing_file("../test/dfml/parsing.dfml");
+		std::string parsing = std::string((std::istreambuf_iterator<char>(parsing_file)), std::istreambuf_iterator<char>());
+		std::string data = parsing + "\n/*tail*/ 'str' 12.5 last(a: 'x')" + parsing;
+
+		auto builder = dfml::Builder::create();
+		std::string expected;
+		for (auto &e : dfml::Parser::create(data)->parse()) expected += builder->build_element(e) + "\n";
+
+		for (size_t chunk : {1, 2, 3, 7, 64, 4096}) {
+			std::string result;
+			auto parser = dfml::PushParser::create([&](std::shared_ptr<dfml::Element> e) {
+				result += builder->build_element(e) + "\n";
+			});
+
+			for (size_t pos = 0; pos < data.size(); pos += chunk) {
+				parser->feed(data.data() + pos, std::min(chunk, data.size() - pos));
+			}
+			parser->finish();
+
+			CHECK_EQ(result, expected);
+		}
+	}
+
+	TEST_CASE("Numbers split at every offset") {
+		std::string data = "a(z: -2, y: +15, x: 1e5, w: -2.5E-3) { -12 1e+5 3.25e2 }\n"
+				"-7 x a { 1e5 -0.5 } 2.5e-1 end(v: -1)";
+
+		auto builder = dfml::Builder::create();
+		std::string expected;
+		for (auto &e : dfml::Parser::create(data)->parse()) expected += builder->build_element(e) + "\n";
+
+		for (size_t split = 1; split < data.size(); split++) {
+			std::string result;
+			auto parser = dfml::PushParser::create([&](std::shared_ptr<dfml::Element> e) {
+				result += builder->build_element(e) + "\n";
+			});
+
+			parser->feed(data.data(), split);
+			parser->feed(data.data() + split, data.size() - split);
+			parser->finish();
+
+			CHECK_EQ(result, expected);
+		}
+	}
+
+	TEST_CASE("Elements emitted when closed") {
+		std::vector<std::string> names;
+		auto parser = dfml::PushParser::create([&](std::shared_ptr<dfml::Element> e) {
+			names.push_back(std::static_pointer_cast<dfml::Node>(e)->get_name());
+		});
+
+		std::string data = "first { child(a: ";
+		parser->feed(data.data(), data.size());
+		CHECK(names.empty());
+
+		data = "'}') } second";
+		parser->feed(data.data(), data.size());
+		CHECK_EQ(names.size(), 1);
+		CHECK_EQ(names.front(), "first");
+
+		// "second" could still get attributes or children.
+		data = "(b: 2)";
+		parser->feed(data.data(), data.size());
+		parser->finish();
+		CHECK_EQ(names.size(), 2);
+		CHECK_EQ(names.back(), "second");
+	}
+
+	TEST_CASE("Error line") {
+		auto parser = dfml::PushParser::create([](std::shared_ptr<dfml::Element>) {});
+		std::string data = "first\n/*multi\nline*/\nsecond {\n";
+		parser->feed(data.data(), data.size());
+
+		data = "\t$\n}";
+		std::string message;
+		try {
+			parser->feed(data.data(), data.size());
+			parser->finish();
+		} catch (dfml::ParserException &e) {
+			message = e.what();
+		}
+		CHECK_EQ(message, "Invalid character for node child on line: 5");
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <vector>
+
+#include <dfml/parser.h>
+#include <dfml/query.h>
+#include <dfml/dfml.h>
+
+/**
+ * @brief Joins the paths of the query matches, with the "id" attribute when present.
+ */
+inline std::string query_paths(const std::string &expression, const std::list<std::shared_ptr<dfml::Element>> &elements) {
+	std::string result;
+	for (dfml::Node *node : dfml::Query(expression).select(elements)) {
+		if (!result.empty()) result += " ";
+		result += node->path();
+		if (auto id = node->attr<long>("id")) result += "#" + std::to_string(*id);
+	}
+	return result;
+}
+
+TEST_SUITE("Query") {
+	const char *config = R"(
+		server(name: 'main') {
+			listener(id: 1, port: 8080, secure: true) { tls(cert: 'a.pem') }
+			listener(id: 2, port: 8081, secure: false)
+			listener(id: 3, port: 8080.0) { tls(cert: 'b.pem') }
+			routes {
+				route(id: 4, method: 'GET') { route(id: 5, method: "POST") }
+				group { route(id: 6, method: 'GET') }
+			}
+		}
+		server(name: 'backup') { listener(id: 7, port: 9090) }
+	)";
+
+	TEST_CASE("Steps") {
+		auto elements = dfml::Parser::create(config)->parse();
+
+		CHECK_EQ(query_paths("server/listener", elements),
+				"/server/listener#1 /server/listener#2 /server/listener#3 /server/listener#7");
+		CHECK_EQ(query_paths("/server/listener[port=8080]/tls", elements),
+				"/server/listener/tls /server/listener/tls");
+		CHECK_EQ(query_paths("server[name='backup']/*", elements), "/server/listener#7");
+		CHECK_EQ(query_paths("server/listener[2]", elements), "/server/listener#2");
+		CHECK_EQ(query_paths("server/listener[port=8080][2]", elements), "/server/listener#3");
+		CHECK_EQ(query_paths("server/listener[secure]", elements), "/server/listener#1 /server/listener#2");
+		CHECK_EQ(query_paths("server/listener[secure=false]", elements), "/server/listener#2");
+		CHECK_EQ(query_paths("server/listener[port != 8080]", elements), "/server/listener#2 /server/listener#7");
+		CHECK_EQ(query_paths("server/missing", elements), "");
+	}
+
+	TEST_CASE("Descendants") {
+		auto elements = dfml::Parser::create(config)->parse();
+
+		CHECK_EQ(query_paths("//route", elements),
+				"/server/routes/route#4 /server/routes/route/route#5 /server/routes/group/route#6");
+		CHECK_EQ(query_paths("//route[method='GET']", elements),
+				"/server/routes/route#4 /server/routes/group/route#6");
+		CHECK_EQ(query_paths("server//route[1]", elements),
+				"/server/routes/route#4 /server/routes/route/route#5 /server/routes/group/route#6");
+		CHECK_EQ(query_paths("//routes//route", elements),
+				"/server/routes/route#4 /server/routes/route/route#5 /server/routes/group/route#6");
+		CHECK_EQ(query_paths("//*//route/route", elements), "/server/routes/route/route#5");
+		CHECK_EQ(dfml::Query("//listener").count(elements), 4);
+
+		// Nested '//' steps report each node once
+		auto nested = dfml::Parser::create("a { b { a { b { c(id: 1) } } } }")->parse();
+		CHECK_EQ(query_paths("//a/b//c", nested), "/a/b/a/b/c#1");
+		CHECK_EQ(query_paths("//a//b//c", nested), "/a/b/a/b/c#1");
+		CHECK_EQ(query_paths("//*//*//c", nested), "/a/b/a/b/c#1");
+		auto siblings = dfml::Parser::create("a { a { b { c(id: 1) } } b { a { b { c(id: 2) } } } }")->parse();
+		CHECK_EQ(query_paths("//a/b//c", siblings), "/a/b/a/b/c#2 /a/a/b/c#1");
+		CHECK_EQ(dfml::Query("//a/b//c").count(siblings), 2);
+		CHECK_EQ(dfml::Query("//b//a/b/c").count(siblings), 1);
+
+		// Any depth, as parsed
+		const size_t levels = 200000;
+		std::string deep;
+		for (size_t n = 0; n < levels; n++) deep += "a{";
+		deep += "b";
+		for (size_t n = 0; n < levels; n++) deep += "}";
+		auto chain = dfml::Parser::create(deep)->parse();
+		CHECK_EQ(dfml::Query("//a").count(chain), levels);
+		CHECK_EQ(dfml::Query("//a//a").count(chain), levels - 1);
+		CHECK_EQ(dfml::Query("a//b").count(chain), 1);
+		CHECK_EQ(dfml::Query("a/a/a").count(chain), 1);
+	}
+
+	TEST_CASE("Scopes") {
+		auto document = dfml::Parser::create(config)->parse_document();
+		dfml::Query query("listener[port=9090]");
+		auto server = dfml::Query("server[name='backup']").first(*document);
+		REQUIRE(server != nullptr);
+		CHECK_EQ(query.first(*server)->attr<long>("id"), 7);
+		CHECK_EQ(query.first(server->get_children())->attr<long>("id"), 7);
+		CHECK_EQ(query.first(*document), nullptr);
+
+		// Stopped by the visitor
+		size_t visited = 0;
+		CHECK_FALSE(dfml::Query("//listener").each(*document, [&visited](dfml::Node &) { return ++visited < 2; }));
+		CHECK_EQ(visited, 2);
+	}
+
+	TEST_CASE("Invalid expressions") {
+		for (auto expression : {"", "/", "a/", "a//", "a///b", "a[", "a[port=]", "a[0]", "a[=1]",
+				"a[port=1x]", "a b", "a[1][2][3][4][5][6][7][8][9]"}) {
+			CHECK_THROWS_AS(dfml::Query::create(expression), dfml::QueryException);
+		}
+		CHECK_EQ(dfml::Query::create("a[name='x]y']")->get_expression(), "a[name='x]y']");
+	}
+}
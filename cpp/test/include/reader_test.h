@@ -0,0 +1,75 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <fstream>
+#include <sstream>
+
+#include <dfml/reader.h>
+#include <dfml/builder.h>
+#include <dfml/dfml.h>
+
+TEST_SUITE("Reader") {
+	TEST_CASE("Tokens") {
+		auto reader = dfml::Reader::create("root(a: 1, b: 'x') { /*note*/ child 'text' } 2.5");
+		std::stringstream log;
+
+		while (reader->read()) {
+			log << reader->depth();
+			switch (reader->token_type()) {
+			case dfml::Reader::NODE_BEGIN: log << "<" << reader->name() << " "; break;
+			case dfml::Reader::ATTRIBUTE:
+				log << reader->name() << "=" << dfml::Value(reader->value()).get_value() << " ";
+				break;
+			case dfml::Reader::DATA: log << "[" << dfml::Value(reader->value()).get_value() << "] "; break;
+			case dfml::Reader::COMMENT: log << "#" << dfml::Value(reader->value()).get_value() << " "; break;
+			case dfml::Reader::NODE_END: log << "> "; break;
+			}
+		}
+
+		CHECK_EQ(log.str(), "0<root 1a=1 1b=x 1#note 1<child 1> 1[text] 0> 0[2.5] ");
+		CHECK_EQ(reader->token_type(), dfml::Reader::END);
+		CHECK_FALSE(reader->read());
+	}
+
+	TEST_CASE("Same tree as Parser") {
+		std::ifstream parsing_file("../test/dfml/parsing.dfml");
+		std::string parsing = std::string((std::istreambuf_iterator<char>(parsing_file)), std::istreambuf_iterator<char>());
+
+		dfml::TreeHandler tree;
+		auto reader = dfml::Reader::create(parsing);
+		while (reader->read()) {
+			switch (reader->token_type()) {
+			case dfml::Reader::NODE_BEGIN: tree.on_node_begin(reader->name()); break;
+			case dfml::Reader::ATTRIBUTE: tree.on_attribute(reader->name(), reader->value()); break;
+			case dfml::Reader::DATA: tree.on_data(reader->value()); break;
+			case dfml::Reader::COMMENT: tree.on_comment(dfml::Value(reader->value()).get_value()); break;
+			case dfml::Reader::NODE_END: tree.on_node_end(); break;
+			}
+		}
+
+		auto builder = dfml::Builder::create();
+		auto expected = dfml::Parser::create(parsing)->parse();
+		CHECK_EQ(tree.get_elements().size(), expected.size());
+		CHECK_EQ(builder->build_element(tree.get_elements().front()), builder->build_element(expected.front()));
+	}
+
+	TEST_CASE("Skip subtree") {
+		auto reader = dfml::Reader::create(
+			"skipped(a: ')', b: '{') { x { y('}') } /* } */ # }\n 'z' } kept { child }");
+		std::stringstream log;
+
+		while (reader->read()) {
+			if (reader->token_type() == dfml::Reader::NODE_BEGIN) {
+				log << reader->name() << " ";
+				if (reader->name() == "skipped") {
+					reader->skip_subtree();
+					CHECK_EQ(reader->token_type(), dfml::Reader::NODE_END);
+					CHECK_EQ(reader->depth(), 0);
+				}
+			}
+		}
+
+		CHECK_EQ(log.str(), "skipped kept child ");
+	}
+}
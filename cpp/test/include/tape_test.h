@@ -0,0 +1,215 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+
+#include <dfml/parser.h>
+#include <dfml/builder.h>
+#include <dfml/sink.h>
+#include <dfml/dfml.h>
+
+/**
+ * @brief Writes a tape element the way the Builder writes an Element, without format.
+ */
+inline void write_tape_element(std::stringstream &ss, dfml::NodeRef element) {
+	switch (element.get_element_type()) {
+	case dfml::Element::NODE:
+		ss << element.get_name();
+		if (!element.get_attributes().empty()) {
+			ss << "(";
+			bool first = true;
+			for (auto attribute : element.get_attributes()) {
+				if (!first) ss << ", ";
+				ss << attribute.first << ": " << attribute.second.to_value().get_value();
+				first = false;
+			}
+			ss << ")";
+		}
+		ss << "{";
+		for (auto child : element.get_children()) {
+			write_tape_element(ss, child);
+			ss << " ";
+		}
+		ss << "}";
+		break;
+
+	case dfml::Element::DATA:
+		ss << element.get_value().to_value().get_value();
+		break;
+
+	case dfml::Element::COMMENT:
+		ss << "/*" << element.get_string() << "*/";
+		break;
+	}
+}
+
+/**
+ * @brief Writes an Element like write_tape_element().
+ */
+inline void write_tree_element(std::stringstream &ss, std::shared_ptr<dfml::Element> element) {
+	switch (element->get_element_type()) {
+	case dfml::Element::NODE: {
+		auto node = std::static_pointer_cast<dfml::Node>(element);
+		ss << node->get_name();
+		if (!node->get_attr_keys().empty()) {
+			ss << "(";
+			bool first = true;
+			for (auto key : node->get_attr_keys()) {
+				if (!first) ss << ", ";
+				ss << key << ": " << node->get_attr(key).get_value();
+				first = false;
+			}
+			ss << ")";
+		}
+		ss << "{";
+		for (auto child : node->get_children()) {
+			write_tree_element(ss, child);
+			ss << " ";
+		}
+		ss << "}";
+		break;
+	}
+
+	case dfml::Element::DATA:
+		ss << std::static_pointer_cast<dfml::Data>(element)->get_value().get_value();
+		break;
+
+	case dfml::Element::COMMENT:
+		ss << "/*" << std::static_pointer_cast<dfml::Comment>(element)->get_string() << "*/";
+		break;
+	}
+}
+
+TEST_SUITE("Tape") {
+	TEST_CASE("Same tree as parse()") {
+		for (auto name : {"parsing.dfml", "parsed.dfml", "doubles.dfml"}) {
+			std::ifstream file(std::string("../test/dfml/") + name);
+			std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+			std::stringstream expected, result;
+			for (auto &element : dfml::Parser::create(data)->parse()) write_tree_element(expected, element);
+
+			auto tape = dfml::Parser::create(data)->parse_tape();
+			for (auto element : tape->get_elements()) write_tape_element(result, element);
+
+			CHECK_FALSE(expected.str().empty());
+			CHECK_EQ(result.str(), expected.str());
+		}
+	}
+
+	TEST_CASE("Navigation") {
+		auto tape = dfml::Parser::create(
+			"config(id: 7, ratio: 0.5, on: true, name: 'main') { a { 1 2 } /*c*/ b 'text' } last")->parse_tape();
+
+		auto elements = tape->get_elements();
+		REQUIRE(elements.size() == 2);
+
+		auto config = *elements.begin();
+		CHECK_EQ(config.get_element_type(), dfml::Element::NODE);
+		CHECK_EQ(config.get_name(), "config");
+		CHECK_EQ(config.get_attr("id").get_integer(), 7);
+		CHECK_EQ(config.get_attr("ratio").get_double(), 0.5);
+		CHECK_EQ(config.get_attr("on").get_boolean(), true);
+		CHECK_EQ(config.get_attr("name").get_string(), "main");
+		CHECK_EQ(config.get_attr("id").get_type(), dfml::Value::INTEGER);
+		CHECK_FALSE(config.has_attr("missing"));
+		CHECK_EQ(config.get_attr("missing").get_string(), "");
+		CHECK_THROWS_AS(config.get_attr("id").get_string(), std::bad_variant_access);
+
+		auto children = config.get_children();
+		REQUIRE(children.size() == 4);
+		auto it = children.begin();
+		auto a = *it++;
+		CHECK_EQ(a.get_name(), "a");
+		CHECK_EQ(a.get_children().size(), 2);
+		CHECK_EQ((*it++).get_string(), "c");
+		CHECK_EQ((*it++).get_name(), "b");
+		CHECK_EQ((*it++).get_value().get_string(), "text");
+		CHECK(it == children.end());
+
+		CHECK_EQ((*std::next(elements.begin())).get_name(), "last");
+	}
+
+	TEST_CASE("Saved and opened") {
+		std::ifstream file("../test/dfml/parsing.dfml");
+		std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		data += " last(id: -7, ratio: 0.5, on: false) { 'text' 12 /*c*/ }";
+
+		std::stringstream expected, result;
+		auto tape = dfml::Parser::create(data)->parse_tape();
+		for (auto element : tape->get_elements()) write_tape_element(expected, element);
+
+		const char *path = "tape_test.dfmt";
+		{
+			std::FILE *out = std::fopen(path, "wb");
+			REQUIRE(out != nullptr);
+			dfml::FdSink sink(fileno(out));
+			tape->save(sink);
+			std::fclose(out);
+		}
+
+		auto opened = dfml::Tape::open(path);
+		for (auto element : opened->get_elements()) write_tape_element(result, element);
+		CHECK_EQ(result.str(), expected.str());
+
+		auto last = *std::next(opened->get_elements().begin(), opened->get_elements().size() - 1);
+		CHECK_EQ(last.get_name(), "last");
+		CHECK_EQ(last.get_attr("id").get_integer(), -7);
+		CHECK_EQ(last.get_attr("on").get_boolean(), false);
+		std::remove(path);
+
+		// Not a tape, and a truncated one
+		dfml::BufferSink sink;
+		tape->save(sink);
+		for (std::string contents : {std::string("config { }"), sink.get_buffer().substr(0, sink.get_buffer().size() - 1)}) {
+			std::FILE *out = std::fopen(path, "wb");
+			REQUIRE(out != nullptr);
+			std::fwrite(contents.data(), 1, contents.size(), out);
+			std::fclose(out);
+			CHECK_THROWS_AS(dfml::Tape::open(path), std::runtime_error);
+		}
+
+		// Corrupt entries and strings, found when verified on open
+		dfml::BufferSink small;
+		dfml::Parser::create("a(k: 1) { b 'text' }")->parse_tape()->save(small);
+		auto write = [path](const std::string &contents) {
+			std::FILE *out = std::fopen(path, "wb");
+			REQUIRE(out != nullptr);
+			std::fwrite(contents.data(), 1, contents.size(), out);
+			std::fclose(out);
+		};
+		auto patched = [&small](size_t index, uint64_t entry) {
+			std::string contents = small.get_buffer();
+			std::memcpy(&contents[24 + index * sizeof(entry)], &entry, sizeof(entry));
+			return contents;
+		};
+		write(small.get_buffer());
+		CHECK_EQ((*dfml::Tape::open(path)->get_elements().begin()).get_attr("k").get_integer(), 1);
+		CHECK_EQ((*dfml::Tape::open(path, true)->get_elements().begin()).get_name(), "a");
+
+		for (std::string contents : {
+				patched(1, 100),                    // Node end after the last entry
+				patched(6, 9),                      // Child end after its parent end
+				patched(0, uint64_t('n') << 56 | 1000), // Name out of the strings
+				patched(7, uint64_t('z') << 56),    // Unknown entry
+				patched(2, uint64_t('i') << 56)}) { // Attribute turned into a value
+			write(contents);
+			CHECK_NOTHROW(dfml::Tape::open(path));
+			CHECK_THROWS_AS(dfml::Tape::open(path, true), std::runtime_error);
+		}
+
+		// Strings cut, with a matching header
+		std::string cut = small.get_buffer().substr(0, small.get_buffer().size() - 3);
+		uint64_t strings;
+		std::memcpy(&strings, &cut[16], sizeof(strings));
+		strings -= 3;
+		std::memcpy(&cut[16], &strings, sizeof(strings));
+		write(cut);
+		CHECK_THROWS_AS(dfml::Tape::open(path, true), std::runtime_error);
+		std::remove(path);
+	}
+}
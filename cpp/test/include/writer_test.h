@@ -0,0 +1,114 @@
+#pragma once
+
+#include <doctest.h>
+#include <string>
+#include <fstream>
+#include <type_traits>
+
+#include <dfml/writer.h>
+#include <dfml/handler.h>
+#include <dfml/parser.h>
+#include <dfml/builder.h>
+#include <dfml/sink.h>
+#include <dfml/dfml.h>
+
+// Replays the parsing events through a Writer.
+class WriterHandler : public dfml::Handler {
+public:
+	WriterHandler(dfml::Writer &writer) : writer(writer) {}
+
+	void on_node_begin(std::string_view name) override { writer.begin_node(name); }
+	void on_attribute(std::string_view key, const dfml::Value &value) override { writer.attribute(key, value); }
+	void on_data(const dfml::Value &value) override { writer.data(value); }
+	void on_comment(std::string_view text) override { writer.comment(text); }
+	void on_node_end() override { writer.end_node(); }
+
+private:
+	dfml::Writer &writer;
+};
+
+template <typename T>
+dfml::Value writer_value(T data) {
+	dfml::Value value;
+	if constexpr (std::is_same_v<T, long>) value.set_integer(data);
+	else if constexpr (std::is_same_v<T, double>) value.set_double(data);
+	else if constexpr (std::is_same_v<T, bool>) value.set_boolean(data);
+	else value.set_string(data);
+	return value;
+}
+
+TEST_SUITE("Writer") {
+	TEST_CASE("Same output as Builder") {
+		std::ifstream parsing_file("../test/dfml/parsing.dfml");
+		std::string parsing = std::string((std::istreambuf_iterator<char>(parsing_file)), std::istreambuf_iterator<char>());
+		std::string data = parsing + "\n/*tail*/ 'str' 12.5 last(a: 'x') empty {} " + parsing;
+		auto elements = dfml::Parser::create(data)->parse();
+
+		for (bool format : {true, false}) {
+			for (bool spaces : {false, true}) {
+				auto builder = dfml::Builder::create();
+				builder->set_format(format);
+				builder->use_spaces_for_indent(spaces);
+				builder->set_space_count(2);
+
+				std::string expected;
+				for (auto &e : elements) {
+					if (!expected.empty()) expected += format ? "\n" : " ";
+					expected += builder->build_element(e);
+				}
+
+				dfml::BufferSink sink;
+				dfml::Writer writer(sink);
+				writer.set_format(format);
+				writer.use_spaces_for_indent(spaces);
+				writer.set_space_count(2);
+
+				WriterHandler handler(writer);
+				dfml::Parser::create(data)->parse(handler);
+				writer.finish();
+
+				CHECK_EQ(sink.get_buffer(), expected);
+			}
+		}
+	}
+
+	TEST_CASE("Writing events") {
+		dfml::BufferSink sink;
+		auto writer = dfml::Writer::create(sink);
+
+		writer->begin_node("root");
+		writer->attribute("id", writer_value(1l));
+		writer->attribute("name", writer_value("it's"));
+		writer->begin_node("child");
+		CHECK_EQ(writer->depth(), 2);
+		writer->end_node();
+		writer->data(writer_value(true));
+		writer->comment("note");
+		writer->end_node();
+		writer->data(writer_value(2.5));
+		writer->finish();
+
+		CHECK_EQ(sink.get_buffer(),
+			"root(id: 1, name: \"it's\") {\n\tchild\n\ttrue\n\t/*note*/\n}\n2.5");
+	}
+
+	TEST_CASE("Nesting errors") {
+		dfml::BufferSink sink;
+		dfml::Writer writer(sink);
+
+		CHECK_THROWS_AS(writer.end_node(), dfml::WriterException);
+		CHECK_THROWS_AS(writer.attribute("a", writer_value(1l)), dfml::WriterException);
+		CHECK_THROWS_AS(writer.begin_node(""), dfml::WriterException);
+
+		writer.begin_node("node");
+		CHECK_THROWS_AS(writer.attribute("", writer_value(1l)), dfml::WriterException);
+		writer.data(writer_value(1l));
+		CHECK_THROWS_AS(writer.attribute("late", writer_value(1l)), dfml::WriterException);
+		CHECK_THROWS_AS(writer.finish(), dfml::WriterException);
+
+		writer.end_node();
+		writer.finish();
+		CHECK_THROWS_AS(writer.data(writer_value(1l)), dfml::WriterException);
+		CHECK_EQ(sink.get_buffer(), "node {\n\t1\n}");
+	}
+}
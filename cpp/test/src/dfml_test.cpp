@@ -4,3 +4,13 @@
 
 #include <build_test.h>
 #include <parse_test.h>
+#include <push_test.h>
+#include <reader_test.h>
+#include <document_test.h>
+#include <tape_test.h>
+#include <writer_test.h>
+#include <binary_test.h>
+#include <cache_test.h>
+#include <loader_test.h>
+#include <query_test.h>
+#include <name_index_test.h>